@@ -0,0 +1,260 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <fmt/core.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/raw_ostream.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "class/class.h"
+#include "class/mangle.h"
+#include "class/pool/path.h"
+#include "class/pool/pool.h"
+#include "codegen/intrinsics.h"
+#include "codegen/runtime-abi.h"
+#include "compilation-unit/compilation-unit.h"
+#include "context/context.h"
+#include "context/exception.h"
+#include "context/statistics.h"
+#include "synthetic-corpus.h"
+
+namespace {
+llvm::cl::OptionCategory corpus_category("Synthetic corpus");
+llvm::cl::opt<uint32_t> class_count("classes", llvm::cl::desc("Number of generated classes"), llvm::cl::init(200),
+                                    llvm::cl::cat(corpus_category));
+llvm::cl::opt<uint32_t> hierarchy_depth("depth", llvm::cl::desc("Length of the generated super class chains"),
+                                        llvm::cl::init(4), llvm::cl::cat(corpus_category));
+llvm::cl::opt<uint32_t> methods_per_class("methods", llvm::cl::desc("Methods per generated class"),
+                                          llvm::cl::init(10), llvm::cl::cat(corpus_category));
+llvm::cl::opt<uint32_t> method_size("method-size", llvm::cl::desc("Statements per generated method"),
+                                    llvm::cl::init(20), llvm::cl::cat(corpus_category));
+llvm::cl::opt<std::string> mix_name("mix",
+                                    llvm::cl::desc("Statement mix: arithmetic, branchy, calls, fields or mixed"),
+                                    llvm::cl::init("mixed"), llvm::cl::cat(corpus_category));
+llvm::cl::opt<uint32_t> seed("seed", llvm::cl::desc("Random seed for the generated code"), llvm::cl::init(1),
+                             llvm::cl::cat(corpus_category));
+llvm::cl::opt<std::string> corpus_directory("corpus-dir", llvm::cl::desc("Where to write the generated classes"),
+                                            llvm::cl::init("bench-corpus"), llvm::cl::cat(corpus_category));
+
+llvm::cl::list<std::string> jars("jar", llvm::cl::desc("Also benchmark compiling every class in <jar>"),
+                                 llvm::cl::value_desc("jar"));
+llvm::cl::list<std::string> class_path("cp", llvm::cl::desc("Jars the benchmarked jars depend on (e.g. rt.jar)"),
+                                       llvm::cl::value_desc("jar"));
+llvm::cl::opt<bool> no_synthetic("no-synthetic", llvm::cl::desc("Only benchmark the jars given with -jar"));
+llvm::cl::list<std::string> optimization_levels("O", llvm::cl::desc("Optimization levels (comma separated)"),
+                                                llvm::cl::CommaSeparated, llvm::cl::Prefix);
+llvm::cl::list<std::string> unit_modes("modes", llvm::cl::desc("Unit modes: single, multi (comma separated)"),
+                                       llvm::cl::CommaSeparated);
+llvm::cl::opt<uint32_t> prefetch_threads("prefetch-threads",
+                                        llvm::cl::desc("Threads that load classes ahead of the compiler"),
+                                        llvm::cl::init(0));
+llvm::cl::opt<uint32_t> repetitions("repetitions", llvm::cl::desc("Runs per configuration"), llvm::cl::init(3));
+llvm::cl::opt<std::string> output_path("o", llvm::cl::desc("Write the JSON results to <path>"),
+                                       llvm::cl::value_desc("path"), llvm::cl::init("-"));
+
+struct Corpus {
+  std::string name;
+  std::vector<std::string> class_names;
+  std::vector<std::string> class_path;// Jars or directories.
+};
+
+struct Configuration {
+  const Corpus *corpus;
+  std::string optimization_level;
+  bool single_unit;
+};
+
+std::unique_ptr<magnetic::ClassPath> CreateClassPath(const std::vector<std::string> &paths) {
+  std::vector<std::unique_ptr<magnetic::ClassPath>> class_paths{};
+  for (const std::string &path : paths) {
+    if (std::filesystem::is_directory(path)) {
+      class_paths.push_back(magnetic::ClassPath::CreateDirectoryClassPath(path));
+    } else {
+      class_paths.push_back(magnetic::ClassPath::CreateJarClassPath(path));
+    }
+  }
+  return magnetic::ClassPath::CreateCompositeClassPath(std::move(class_paths));
+}
+
+/**
+ * Compiles the corpus the same way the compiler driver does.
+ * @return the results, as a JSON object
+ */
+std::string RunConfiguration(const Configuration &configuration, uint32_t repetition) {
+  auto start = std::chrono::steady_clock::now();
+
+  magnetic::Context ctx{};
+  ctx.set_target_machine(magnetic::CreateTargetMachine(""));
+  ctx.set_pool(std::make_unique<magnetic::ClassPool>(CreateClassPath(configuration.corpus->class_path)));
+  ctx.set_name_mangler(magnetic::NameMangler::CreateJNIMangler());
+  ctx.set_runtime_abi(magnetic::RuntimeABI::CreateDefaultABI());
+  ctx.set_intrinsics(magnetic::IntrinsicRegistry::CreateDefaultRegistry());
+  ctx.set_use_single_unit(configuration.single_unit);
+  ctx.set_preinitialize_statics(true);
+  ctx.set_emit_safepoint_polls(true);
+  ctx.set_statistics(std::make_unique<magnetic::CompileStatistics>());
+  if (prefetch_threads > 0) ctx.pool()->StartPrefetching(configuration.corpus->class_names, prefetch_threads);
+
+  // Classes that fail to compile (e.g. because a dependency isn't on the class path) are counted, but don't stop the
+  // run, so that real jars can be benchmarked without all of their dependencies.
+  uint64_t failed_classes = 0;
+  std::vector<magnetic::CompilationUnit *> units{};
+  std::set<magnetic::CompilationUnit *> seen_units{};
+  for (const std::string &class_name : configuration.corpus->class_names) {
+    try {
+      magnetic::ClassInfo *clazz = ctx.pool()->Get(class_name);
+      if (clazz == nullptr) {
+        ++failed_classes;
+        continue;
+      }
+      if (seen_units.insert(clazz->compilation_unit()).second) units.push_back(clazz->compilation_unit());
+    } catch (const magnetic::BadBytecode &) { ++failed_classes; }
+  }
+  llvm::OptimizationLevel level =
+      magnetic::ParseOptimizationLevel(configuration.optimization_level).value_or(llvm::OptimizationLevel::O2);
+  for (magnetic::CompilationUnit *unit : units) { unit->Optimize(level); }
+
+  double wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+
+  const magnetic::CompileStatistics &statistics = *ctx.statistics();
+  uint64_t classes = statistics.phase_totals(magnetic::CompilePhase::kClassEmission).count;
+  uint64_t methods = statistics.phase_totals(magnetic::CompilePhase::kMethodCodegen).count;
+  std::string phases{};
+  for (magnetic::CompilePhase phase :
+       {magnetic::CompilePhase::kClassPathLookup, magnetic::CompilePhase::kClassParsing,
+        magnetic::CompilePhase::kClassEmission, magnetic::CompilePhase::kMethodCodegen,
+        magnetic::CompilePhase::kOptimization}) {
+    double milliseconds = std::chrono::duration<double, std::milli>(statistics.phase_totals(phase).time).count();
+    if (!phases.empty()) phases += ", ";
+    phases += fmt::format("\"{}\": {:.3f}", magnetic::GetCompilePhaseName(phase), milliseconds);
+  }
+
+  return fmt::format("{{\"corpus\": \"{}\", \"opt_level\": \"O{}\", \"mode\": \"{}\", \"repetition\": {}, "
+                     "\"classes\": {}, \"failed_classes\": {}, \"methods\": {}, \"units\": {}, "
+                     "\"wall_ms\": {:.3f}, \"classes_per_second\": {:.1f}, \"methods_per_second\": {:.1f}, "
+                     "\"ir_instructions\": {}, \"prefetch_threads\": {}, \"peak_rss_kb\": {}, \"phases_ms\": {{{}}}}}",
+                     configuration.corpus->name, configuration.optimization_level,
+                     configuration.single_unit ? "single" : "multi", repetition, classes, failed_classes, methods,
+                     units.size(), wall_seconds * 1000, classes / wall_seconds, methods / wall_seconds,
+                     statistics.phase_totals(magnetic::CompilePhase::kOptimization).instruction_count,
+                     static_cast<uint32_t>(prefetch_threads), usage.ru_maxrss, phases);
+}
+
+/**
+ * Runs the configuration in a child process, so that every run starts from a cold compiler and peak RSS is measured
+ * per run.
+ */
+std::string RunConfigurationInChild(const Configuration &configuration, uint32_t repetition) {
+  int pipe_fds[2];
+  if (pipe(pipe_fds) != 0) throw std::runtime_error("could not create a pipe");
+
+  pid_t pid = fork();
+  if (pid < 0) throw std::runtime_error("could not fork");
+  if (pid == 0) {
+    close(pipe_fds[0]);
+    std::string result;
+    try {
+      result = RunConfiguration(configuration, repetition);
+    } catch (const std::exception &e) {
+      result = fmt::format("{{\"corpus\": \"{}\", \"error\": \"{}\"}}", configuration.corpus->name, e.what());
+    }
+    for (size_t written = 0; written < result.size();) {
+      ssize_t count = write(pipe_fds[1], result.data() + written, result.size() - written);
+      if (count <= 0) break;
+      written += count;
+    }
+    close(pipe_fds[1]);
+    _exit(0);
+  }
+
+  close(pipe_fds[1]);
+  std::string result{};
+  char buffer[4096];
+  ssize_t count;
+  while ((count = read(pipe_fds[0], buffer, sizeof(buffer))) > 0) { result.append(buffer, count); }
+  close(pipe_fds[0]);
+
+  int status;
+  waitpid(pid, &status, 0);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || result.empty()) {
+    return fmt::format("{{\"corpus\": \"{}\", \"error\": \"compiler crashed (status {})\"}}",
+                       configuration.corpus->name, status);
+  }
+  return result;
+}
+
+std::vector<Corpus> CreateCorpora() {
+  std::vector<Corpus> corpora{};
+  if (!no_synthetic) {
+    magnetic::bench::SyntheticCorpusOptions options{};
+    options.class_count = class_count;
+    options.hierarchy_depth = hierarchy_depth;
+    options.methods_per_class = methods_per_class;
+    options.method_size = method_size;
+    options.seed = seed;
+    if (!magnetic::bench::OpcodeMix::FromName(mix_name, options.mix)) {
+      throw std::runtime_error(fmt::format("unknown statement mix {}", mix_name));
+    }
+    std::filesystem::remove_all(corpus_directory.getValue());
+    std::vector<std::string> class_names = magnetic::bench::WriteSyntheticCorpus(options, corpus_directory);
+    corpora.push_back({fmt::format("synthetic-{}-{}x{}x{}", mix_name, class_count, methods_per_class, method_size),
+                       std::move(class_names),
+                       {corpus_directory}});
+  }
+  for (const std::string &jar : jars) {
+    Corpus corpus{jar, magnetic::ClassPath::CreateJarClassPath(jar)->ListClassNames(), {jar}};
+    corpus.class_path.insert(corpus.class_path.end(), class_path.begin(), class_path.end());
+    corpora.push_back(std::move(corpus));
+  }
+  return corpora;
+}
+}// namespace
+
+int main(int argc, char **argv) {
+  llvm::cl::ParseCommandLineOptions(argc, argv, "magnetic-vm compiler throughput benchmark\n");
+  llvm::InitializeNativeTarget();
+
+  std::vector<std::string> levels(optimization_levels.begin(), optimization_levels.end());
+  if (levels.empty()) levels = {"0", "2"};
+  std::vector<std::string> modes(unit_modes.begin(), unit_modes.end());
+  if (modes.empty()) modes = {"single", "multi"};
+
+  std::vector<Corpus> corpora = CreateCorpora();
+  std::vector<std::string> results{};
+  for (const Corpus &corpus : corpora) {
+    for (const std::string &level : levels) {
+      for (const std::string &mode : modes) {
+        Configuration configuration{&corpus, level, mode == "single"};
+        for (uint32_t repetition = 0; repetition < repetitions; ++repetition) {
+          results.push_back(RunConfigurationInChild(configuration, repetition));
+          llvm::errs() << results.back() << "\n";
+        }
+      }
+    }
+  }
+
+  std::error_code error;
+  llvm::raw_fd_ostream os(output_path, error);
+  if (error) {
+    llvm::errs() << "could not open " << output_path << ": " << error.message() << "\n";
+    return 1;
+  }
+  os << "{\"runs\": [\n";
+  for (size_t i = 0; i < results.size(); ++i) { os << "  " << results[i] << (i + 1 < results.size() ? ",\n" : "\n"); }
+  os << "]}\n";
+  return 0;
+}
@@ -0,0 +1,158 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "class-writer.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include <cjbp/cjbp.h>
+
+namespace magnetic::bench {
+
+namespace {
+constexpr uint8_t kUtf8Tag = 1;
+constexpr uint8_t kClassTag = 7;
+constexpr uint8_t kFieldRefTag = 9;
+constexpr uint8_t kMethodRefTag = 10;
+constexpr uint8_t kNameAndTypeTag = 12;
+
+void WriteU2(std::vector<uint8_t> &out, uint16_t value) {
+  out.push_back(static_cast<uint8_t>(value >> 8));
+  out.push_back(static_cast<uint8_t>(value));
+}
+void WriteU4(std::vector<uint8_t> &out, uint32_t value) {
+  WriteU2(out, static_cast<uint16_t>(value >> 16));
+  WriteU2(out, static_cast<uint16_t>(value));
+}
+
+std::string ToInternalName(std::string name) {
+  std::replace(name.begin(), name.end(), '.', '/');
+  return name;
+}
+}// namespace
+
+void CodeBuilder::EmitU1(uint8_t opcode, uint8_t operand) {
+  this->code_.push_back(opcode);
+  this->code_.push_back(operand);
+}
+void CodeBuilder::EmitU2(uint8_t opcode, uint16_t operand) {
+  this->code_.push_back(opcode);
+  WriteU2(this->code_, operand);
+}
+void CodeBuilder::EmitIInc(uint8_t local, int8_t value) {
+  this->code_.push_back(cjbp::Opcode::kIInc);
+  this->code_.push_back(local);
+  this->code_.push_back(static_cast<uint8_t>(value));
+}
+size_t CodeBuilder::EmitBranch(uint8_t opcode) {
+  size_t branch = this->position();
+  this->EmitU2(opcode, 0);
+  return branch;
+}
+void CodeBuilder::EmitBranchTo(uint8_t opcode, size_t target) {
+  size_t branch = this->EmitBranch(opcode);
+  this->PatchBranch(branch, target);
+}
+void CodeBuilder::PatchBranch(size_t branch, size_t target) {
+  auto offset = static_cast<int16_t>(static_cast<int64_t>(target) - static_cast<int64_t>(branch));
+  this->code_[branch + 1] = static_cast<uint8_t>(static_cast<uint16_t>(offset) >> 8);
+  this->code_[branch + 2] = static_cast<uint8_t>(offset);
+}
+
+ClassWriter::ClassWriter(const std::string &name, const std::string &super_name)
+    : constant_pool_(), constant_count_(1), constants_(), super_class_(0), fields_(), methods_() {
+  this->this_class_ = this->AddClass(name);
+  if (!super_name.empty()) this->super_class_ = this->AddClass(super_name);
+}
+
+uint16_t ClassWriter::AddConstant(uint8_t tag, const std::string &a, const std::string &b, const std::string &c,
+                                  const std::vector<uint8_t> &data) {
+  const auto &it = this->constants_.find(std::make_tuple(tag, a, b, c));
+  if (it != this->constants_.end()) return it->second;
+
+  this->constant_pool_.push_back(tag);
+  this->constant_pool_.insert(this->constant_pool_.end(), data.begin(), data.end());
+  uint16_t index = this->constant_count_++;
+  this->constants_.emplace(std::make_tuple(tag, a, b, c), index);
+  return index;
+}
+uint16_t ClassWriter::AddUtf8(const std::string &value) {
+  // Only ASCII is written, for which modified UTF-8 is the same as ASCII.
+  std::vector<uint8_t> data{};
+  WriteU2(data, static_cast<uint16_t>(value.size()));
+  data.insert(data.end(), value.begin(), value.end());
+  return this->AddConstant(kUtf8Tag, value, "", "", data);
+}
+uint16_t ClassWriter::AddClass(const std::string &name) {
+  std::vector<uint8_t> data{};
+  WriteU2(data, this->AddUtf8(ToInternalName(name)));
+  return this->AddConstant(kClassTag, name, "", "", data);
+}
+uint16_t ClassWriter::AddNameAndType(const std::string &name, const std::string &descriptor) {
+  std::vector<uint8_t> data{};
+  WriteU2(data, this->AddUtf8(name));
+  WriteU2(data, this->AddUtf8(descriptor));
+  return this->AddConstant(kNameAndTypeTag, name, descriptor, "", data);
+}
+uint16_t ClassWriter::AddMemberRef(uint8_t tag, const std::string &class_name, const std::string &name,
+                                   const std::string &descriptor) {
+  std::vector<uint8_t> data{};
+  WriteU2(data, this->AddClass(class_name));
+  WriteU2(data, this->AddNameAndType(name, descriptor));
+  return this->AddConstant(tag, class_name, name, descriptor, data);
+}
+uint16_t ClassWriter::AddFieldRef(const std::string &class_name, const std::string &name,
+                                  const std::string &descriptor) {
+  return this->AddMemberRef(kFieldRefTag, class_name, name, descriptor);
+}
+uint16_t ClassWriter::AddMethodRef(const std::string &class_name, const std::string &name,
+                                   const std::string &descriptor) {
+  return this->AddMemberRef(kMethodRefTag, class_name, name, descriptor);
+}
+
+void ClassWriter::AddField(uint16_t access_flags, const std::string &name, const std::string &descriptor) {
+  this->fields_.push_back({access_flags, this->AddUtf8(name), this->AddUtf8(descriptor), {}});
+}
+void ClassWriter::AddMethod(uint16_t access_flags, const std::string &name, const std::string &descriptor,
+                            uint16_t max_stack, uint16_t max_locals, const CodeBuilder &code) {
+  std::vector<uint8_t> attribute{};
+  WriteU2(attribute, this->AddUtf8("Code"));
+  WriteU4(attribute, static_cast<uint32_t>(2 + 2 + 4 + code.code().size() + 2 + 2));
+  WriteU2(attribute, max_stack);
+  WriteU2(attribute, max_locals);
+  WriteU4(attribute, static_cast<uint32_t>(code.code().size()));
+  attribute.insert(attribute.end(), code.code().begin(), code.code().end());
+  WriteU2(attribute, 0);// Exception table length.
+  WriteU2(attribute, 0);// Attribute count.
+  this->methods_.push_back({access_flags, this->AddUtf8(name), this->AddUtf8(descriptor), std::move(attribute)});
+}
+
+std::vector<uint8_t> ClassWriter::Write() const {
+  std::vector<uint8_t> out{};
+  WriteU4(out, 0xcafebabe);
+  WriteU2(out, 0); // Minor version.
+  WriteU2(out, 49);// Major version (Java 5).
+  WriteU2(out, this->constant_count_);
+  out.insert(out.end(), this->constant_pool_.begin(), this->constant_pool_.end());
+  WriteU2(out, 0x0021);// ACC_PUBLIC | ACC_SUPER
+  WriteU2(out, this->this_class_);
+  WriteU2(out, this->super_class_);
+  WriteU2(out, 0);// Interface count.
+
+  for (const std::vector<Member> *members : {&this->fields_, &this->methods_}) {
+    WriteU2(out, static_cast<uint16_t>(members->size()));
+    for (const Member &member : *members) {
+      WriteU2(out, member.access_flags);
+      WriteU2(out, member.name_index);
+      WriteU2(out, member.descriptor_index);
+      WriteU2(out, member.code_attribute.empty() ? 0 : 1);
+      out.insert(out.end(), member.code_attribute.begin(), member.code_attribute.end());
+    }
+  }
+  WriteU2(out, 0);// Attribute count.
+  return out;
+}
+
+}// namespace magnetic::bench
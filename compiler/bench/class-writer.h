@@ -0,0 +1,92 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace magnetic::bench {
+
+/**
+ * Bytecode of a single method, with helpers for the instructions the synthetic corpus uses.
+ */
+class CodeBuilder {
+ public:
+  CodeBuilder() = default;
+
+  void Emit(uint8_t opcode) { this->code_.push_back(opcode); }
+  void EmitU1(uint8_t opcode, uint8_t operand);
+  void EmitU2(uint8_t opcode, uint16_t operand);
+  void EmitIInc(uint8_t local, int8_t value);
+
+  /**
+   * Emits a branch whose target is set later with PatchBranch.
+   * @return the position of the branch
+   */
+  size_t EmitBranch(uint8_t opcode);
+  /**
+   * Emits a branch to an earlier position.
+   */
+  void EmitBranchTo(uint8_t opcode, size_t target);
+  void PatchBranch(size_t branch, size_t target);
+
+  [[nodiscard]] size_t position() const { return this->code_.size(); }
+  [[nodiscard]] const std::vector<uint8_t> &code() const { return this->code_; }
+
+ private:
+  std::vector<uint8_t> code_;
+};
+
+/**
+ * Writes class files (version 49, so that no stack map frames are needed).
+ *
+ * Class names are dotted, as everywhere else in the compiler.
+ */
+class ClassWriter {
+ public:
+  /**
+   * @param super_name the super class, or an empty string for java.lang.Object itself
+   */
+  ClassWriter(const std::string &name, const std::string &super_name);
+
+  uint16_t AddFieldRef(const std::string &class_name, const std::string &name, const std::string &descriptor);
+  uint16_t AddMethodRef(const std::string &class_name, const std::string &name, const std::string &descriptor);
+
+  void AddField(uint16_t access_flags, const std::string &name, const std::string &descriptor);
+  void AddMethod(uint16_t access_flags, const std::string &name, const std::string &descriptor, uint16_t max_stack,
+                 uint16_t max_locals, const CodeBuilder &code);
+
+  [[nodiscard]] std::vector<uint8_t> Write() const;
+
+ private:
+  struct Member {
+    uint16_t access_flags;
+    uint16_t name_index;
+    uint16_t descriptor_index;
+    std::vector<uint8_t> code_attribute;// Empty for fields.
+  };
+
+  std::vector<uint8_t> constant_pool_;
+  uint16_t constant_count_;
+  std::map<std::tuple<uint8_t, std::string, std::string, std::string>, uint16_t> constants_;
+
+  uint16_t this_class_;
+  uint16_t super_class_;// 0 for java.lang.Object.
+  std::vector<Member> fields_;
+  std::vector<Member> methods_;
+
+  uint16_t AddConstant(uint8_t tag, const std::string &a, const std::string &b, const std::string &c,
+                       const std::vector<uint8_t> &data);
+  uint16_t AddUtf8(const std::string &value);
+  uint16_t AddClass(const std::string &name);
+  uint16_t AddNameAndType(const std::string &name, const std::string &descriptor);
+  uint16_t AddMemberRef(uint8_t tag, const std::string &class_name, const std::string &name,
+                        const std::string &descriptor);
+};
+
+}// namespace magnetic::bench
@@ -0,0 +1,256 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "synthetic-corpus.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+#include <cjbp/cjbp.h>
+#include <fmt/core.h>
+
+#include "class-writer.h"
+
+namespace magnetic::bench {
+
+bool OpcodeMix::FromName(const std::string &name, OpcodeMix &mix) {
+  mix = OpcodeMix();
+  if (name == "arithmetic") return true;
+  if (name == "branchy") {
+    mix.arithmetic = 2;
+    mix.division = 1;
+    mix.loops = 1;
+    return true;
+  }
+  if (name == "calls") {
+    mix.static_calls = 1;
+    mix.virtual_calls = 1;
+    return true;
+  }
+  if (name == "fields") {
+    mix.field_accesses = 2;
+    return true;
+  }
+  if (name == "mixed") {
+    mix.arithmetic = 3;
+    mix.division = 1;
+    mix.loops = 1;
+    mix.static_calls = 1;
+    mix.virtual_calls = 1;
+    mix.field_accesses = 1;
+    return true;
+  }
+  return false;
+}
+
+namespace {
+using namespace cjbp::Opcode;
+
+constexpr const char *kObjectName = "java.lang.Object";
+constexpr const char *kClassNamePrefix = "bench.synthetic.C";
+constexpr uint16_t kPublic = 0x0001;
+constexpr uint16_t kStatic = 0x0008;
+constexpr uint32_t kFieldCount = 4;
+// Every method has its argument plus this many more int locals, and one more local for loop counters.
+constexpr uint8_t kExtraIntLocals = 4;
+constexpr uint8_t kMaxStack = 4;
+
+enum class Statement { kArithmetic, kDivision, kLoop, kStaticCall, kVirtualCall, kFieldAccess };
+
+std::string GetClassName(uint32_t index) { return kClassNamePrefix + std::to_string(index); }
+/**
+ * Even methods are static, odd methods are virtual (and overridden by every subclass).
+ */
+bool IsStaticMethod(uint32_t index) { return index % 2 == 0; }
+std::string GetMethodName(uint32_t index) { return (IsStaticMethod(index) ? "s" : "v") + std::to_string(index); }
+
+class MethodGenerator {
+ public:
+  MethodGenerator(const SyntheticCorpusOptions &options, std::mt19937 &random, ClassWriter &writer,
+                  const std::string &class_name, bool is_static)
+      : options_(options), random_(random), writer_(writer), class_name_(class_name), is_static_(is_static),
+        first_int_local_(is_static ? 0 : 1), code_() {}
+
+  void Generate() {
+    // Derive the extra locals from the argument, so that nothing can be constant folded away.
+    for (uint8_t i = 1; i <= kExtraIntLocals; ++i) {
+      this->code_.EmitU1(kILoad, this->first_int_local_);
+      this->code_.EmitU1(kBIPush, i);
+      this->code_.Emit(kIAdd);
+      this->code_.EmitU1(kIStore, this->first_int_local_ + i);
+    }
+    for (uint32_t i = 0; i < this->options_.method_size; ++i) { this->GenerateStatement(this->PickStatement()); }
+    this->code_.EmitU1(kILoad, this->first_int_local_);
+    this->code_.Emit(kIReturn);
+  }
+
+  [[nodiscard]] const CodeBuilder &code() const { return this->code_; }
+  [[nodiscard]] uint16_t max_locals() const { return this->loop_counter_local() + 1; }
+
+ private:
+  const SyntheticCorpusOptions &options_;
+  std::mt19937 &random_;
+  ClassWriter &writer_;
+  const std::string &class_name_;
+  bool is_static_;
+  uint8_t first_int_local_;
+  CodeBuilder code_;
+
+  [[nodiscard]] uint8_t loop_counter_local() const { return this->first_int_local_ + kExtraIntLocals + 1; }
+
+  uint32_t Random(uint32_t bound) { return std::uniform_int_distribution<uint32_t>(0, bound - 1)(this->random_); }
+  uint8_t RandomLocal() { return this->first_int_local_ + static_cast<uint8_t>(this->Random(kExtraIntLocals + 1)); }
+
+  Statement PickStatement() {
+    const OpcodeMix &mix = this->options_.mix;
+    // Calls need a method to call, and virtual calls and field accesses need a receiver.
+    bool has_static_methods = (this->options_.methods_per_class >= 1);
+    bool has_virtual_methods = (this->options_.methods_per_class >= 2) && !this->is_static_;
+    std::vector<std::pair<Statement, uint32_t>> weights = {
+        {Statement::kArithmetic, mix.arithmetic},
+        {Statement::kDivision, mix.division},
+        {Statement::kLoop, mix.loops},
+        {Statement::kStaticCall, has_static_methods ? mix.static_calls : 0},
+        {Statement::kVirtualCall, has_virtual_methods ? mix.virtual_calls : 0},
+        {Statement::kFieldAccess, this->is_static_ ? 0 : mix.field_accesses},
+    };
+    uint32_t total = 0;
+    for (const auto &[statement, weight] : weights) { total += weight; }
+    if (total == 0) return Statement::kArithmetic;
+
+    uint32_t pick = this->Random(total);
+    for (const auto &[statement, weight] : weights) {
+      if (pick < weight) return statement;
+      pick -= weight;
+    }
+    return Statement::kArithmetic;
+  }
+
+  void GenerateStatement(Statement statement) {
+    switch (statement) {
+      case Statement::kArithmetic: {
+        static constexpr uint8_t kOperations[] = {kIAdd, kISub, kIMul, kIAnd, kIOr, kIXor, kIShl};
+        this->code_.EmitU1(kILoad, this->RandomLocal());
+        this->code_.EmitU1(kILoad, this->RandomLocal());
+        this->code_.Emit(kOperations[this->Random(std::size(kOperations))]);
+        this->code_.EmitU1(kIStore, this->RandomLocal());
+        break;
+      }
+      case Statement::kDivision: {
+        // Or-ing the divisor with 1 keeps the division well-defined, but the compiler can't tell.
+        this->code_.EmitU1(kILoad, this->RandomLocal());
+        this->code_.EmitU1(kILoad, this->RandomLocal());
+        this->code_.Emit(kIConst1);
+        this->code_.Emit(kIOr);
+        this->code_.Emit(this->Random(2) == 0 ? kIDiv : kIRem);
+        this->code_.EmitU1(kIStore, this->RandomLocal());
+        break;
+      }
+      case Statement::kLoop: {
+        uint8_t counter = this->loop_counter_local();
+        uint8_t accumulator = this->RandomLocal();
+        this->code_.Emit(kIConst0);
+        this->code_.EmitU1(kIStore, counter);
+        size_t header = this->code_.position();
+        this->code_.EmitU1(kILoad, counter);
+        this->code_.EmitU1(kBIPush, 16);
+        size_t exit_branch = this->code_.EmitBranch(kIfICmpGe);
+        this->code_.EmitU1(kILoad, accumulator);
+        this->code_.EmitU1(kILoad, counter);
+        this->code_.Emit(kIAdd);
+        this->code_.EmitU1(kIStore, accumulator);
+        this->code_.EmitIInc(counter, 1);
+        this->code_.EmitBranchTo(kGoto, header);
+        this->code_.PatchBranch(exit_branch, this->code_.position());
+        break;
+      }
+      case Statement::kStaticCall: {
+        std::string target_class = GetClassName(this->Random(this->options_.class_count));
+        uint32_t target_method = this->Random((this->options_.methods_per_class + 1) / 2) * 2;
+        uint16_t method = this->writer_.AddMethodRef(target_class, GetMethodName(target_method), "(I)I");
+        this->code_.EmitU1(kILoad, this->RandomLocal());
+        this->code_.EmitU2(kInvokeStatic, method);
+        this->code_.EmitU1(kIStore, this->RandomLocal());
+        break;
+      }
+      case Statement::kVirtualCall: {
+        uint32_t target_method = this->Random(this->options_.methods_per_class / 2) * 2 + 1;
+        this->code_.Emit(kALoad0);
+        this->code_.EmitU1(kILoad, this->RandomLocal());
+        this->code_.EmitU2(kInvokeVirtual,
+                           this->writer_.AddMethodRef(this->class_name_, GetMethodName(target_method), "(I)I"));
+        this->code_.EmitU1(kIStore, this->RandomLocal());
+        break;
+      }
+      case Statement::kFieldAccess: {
+        std::string field_name = "f" + std::to_string(this->Random(kFieldCount));
+        uint16_t field = this->writer_.AddFieldRef(this->class_name_, field_name, "I");
+        this->code_.Emit(kALoad0);
+        this->code_.Emit(kALoad0);
+        this->code_.EmitU2(kGetField, field);
+        this->code_.EmitU1(kILoad, this->RandomLocal());
+        this->code_.Emit(kIAdd);
+        this->code_.EmitU2(kPutField, field);
+        break;
+      }
+    }
+  }
+};
+
+void GenerateConstructor(ClassWriter &writer, const std::string &super_name) {
+  CodeBuilder code;
+  if (!super_name.empty()) {
+    code.Emit(kALoad0);
+    code.EmitU2(kInvokeSpecial, writer.AddMethodRef(super_name, "<init>", "()V"));
+  }
+  code.Emit(kReturn);
+  writer.AddMethod(kPublic, "<init>", "()V", 1, 1, code);
+}
+
+void WriteClassFile(const std::filesystem::path &directory, const std::string &class_name, const ClassWriter &writer) {
+  std::string relative_path = class_name;
+  std::replace(relative_path.begin(), relative_path.end(), '.', '/');
+  std::filesystem::path path = directory / (relative_path + ".class");
+  std::filesystem::create_directories(path.parent_path());
+
+  std::vector<uint8_t> bytes = writer.Write();
+  std::ofstream ofs(path, std::ios::out | std::ios::binary | std::ios::trunc);
+  ofs.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+  if (ofs.fail()) throw std::runtime_error(fmt::format("could not write {}", path.string()));
+}
+}// namespace
+
+std::vector<std::string> WriteSyntheticCorpus(const SyntheticCorpusOptions &options, const std::string &directory) {
+  std::vector<std::string> class_names{kObjectName};
+  ClassWriter object_writer(kObjectName, "");
+  GenerateConstructor(object_writer, "");
+  WriteClassFile(directory, kObjectName, object_writer);
+
+  std::mt19937 random(options.seed);
+  uint32_t hierarchy_depth = std::max(options.hierarchy_depth, 1u);
+  for (uint32_t i = 0; i < options.class_count; ++i) {
+    std::string class_name = GetClassName(i);
+    std::string super_name = (i % hierarchy_depth == 0) ? kObjectName : GetClassName(i - 1);
+    ClassWriter writer(class_name, super_name);
+    GenerateConstructor(writer, super_name);
+    for (uint32_t field = 0; field < kFieldCount; ++field) {
+      writer.AddField(kPublic, "f" + std::to_string(field), "I");
+    }
+    for (uint32_t method = 0; method < options.methods_per_class; ++method) {
+      bool is_static = IsStaticMethod(method);
+      MethodGenerator generator(options, random, writer, class_name, is_static);
+      generator.Generate();
+      writer.AddMethod(is_static ? (kPublic | kStatic) : kPublic, GetMethodName(method), "(I)I", kMaxStack,
+                       generator.max_locals(), generator.code());
+    }
+    WriteClassFile(directory, class_name, writer);
+    class_names.push_back(std::move(class_name));
+  }
+  return class_names;
+}
+
+}// namespace magnetic::bench
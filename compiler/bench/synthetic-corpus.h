@@ -0,0 +1,53 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace magnetic::bench {
+
+/**
+ * Relative frequency of each kind of statement in generated method bodies.
+ */
+struct OpcodeMix {
+  uint32_t arithmetic = 1;// Integer arithmetic between locals.
+  uint32_t division = 0;  // Integer division (which emits a division by zero check).
+  uint32_t loops = 0;     // Counted loops with a small body.
+  uint32_t static_calls = 0;
+  uint32_t virtual_calls = 0;
+  uint32_t field_accesses = 0;
+
+  /**
+   * @param name one of "arithmetic", "branchy", "calls", "fields" or "mixed"
+   * @return false if the name isn't a known mix
+   */
+  static bool FromName(const std::string &name, OpcodeMix &mix);
+};
+
+struct SyntheticCorpusOptions {
+  uint32_t class_count = 100;
+  /**
+   * Length of the super class chains the classes are arranged in (1 means every class extends java.lang.Object).
+   */
+  uint32_t hierarchy_depth = 4;
+  uint32_t methods_per_class = 10;
+  /**
+   * Number of statements per method body.
+   */
+  uint32_t method_size = 20;
+  OpcodeMix mix;
+  uint32_t seed = 1;
+};
+
+/**
+ * Writes a corpus of generated class files (including a minimal java.lang.Object) into a directory, laid out like a
+ * class path.
+ * @return the names of the generated classes
+ */
+std::vector<std::string> WriteSyntheticCorpus(const SyntheticCorpusOptions &options, const std::string &directory);
+
+}// namespace magnetic::bench
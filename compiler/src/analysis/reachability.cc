@@ -0,0 +1,238 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "reachability.h"
+
+#include <algorithm>
+
+#include "codegen/intrinsics.h"
+#include "context/context.h"
+#include "context/exception.h"
+#include "context/statistics.h"
+#include "types/class/class.h"
+#include "types/pool/pool.h"
+
+namespace magnetic {
+
+namespace {
+std::string GetMethodKey(const std::string &class_name, const std::string &name, const std::string &descriptor) {
+  return class_name + ' ' + name + ' ' + descriptor;
+}
+std::string GetSelectorKey(const std::string &name, const std::string &descriptor) { return name + descriptor; }
+}// namespace
+
+ReachabilityAnalysis::ReachabilityAnalysis(Context *ctx)
+    : ctx_(ctx), reachable_methods_(), called_selectors_(), instantiated_classes_(), instantiated_order_(),
+      used_class_set_(), used_classes_(), worklist_(), sees_all_instantiations_(true) {
+  // The runtime calls run() on every thread that it starts, which can run the override of any instantiated class. The
+  // Thread.run that the call goes through is marked when Thread.start is reached.
+  this->MarkCalled("run", "()V");
+}
+
+void ReachabilityAnalysis::AddRoot(ClassInfo *clazz, cjbp::Method *method) { this->MarkReachable(clazz, method); }
+
+void ReachabilityAnalysis::Run() {
+  CompileStatistics::Scope scope(this->ctx_->statistics(), CompilePhase::kReachability, "");
+  while (!this->worklist_.empty()) {
+    auto [clazz, method] = this->worklist_.back();
+    this->worklist_.pop_back();
+    this->Visit(clazz, method);
+  }
+}
+
+bool ReachabilityAnalysis::IsReachable(const std::string &class_name, const std::string &name,
+                                       const std::string &descriptor) const {
+  return this->reachable_methods_.count(GetMethodKey(class_name, name, descriptor)) != 0;
+}
+bool ReachabilityAnalysis::IsOverridden(const std::string &class_name, const std::string &name,
+                                        const std::string &descriptor) const {
+  // An object that native code created may be of any sub class.
+  if (!this->sees_all_instantiations_) return true;
+  ClassInfo *clazz = this->Load(class_name);
+  if (clazz == nullptr) return true;
+  std::pair<ClassInfo *, cjbp::Method *> method = this->Resolve(clazz, name, descriptor);
+  // An abstract method has no code to call directly, even if nothing implements it.
+  if (method.second == nullptr || (method.second->access_flags() & cjbp::AccessFlags::kAbstract)) return true;
+
+  for (ClassInfo *instantiated : this->instantiated_order_) {
+    if (!this->IsSubClassOf(instantiated, clazz)) continue;
+    if (this->Resolve(instantiated, name, descriptor) != method) return true;
+  }
+  return false;
+}
+std::vector<std::pair<ClassInfo *, cjbp::Method *>> ReachabilityAnalysis::FindImplementations(
+    const std::string &class_name, const std::string &name, const std::string &descriptor) const {
+  std::vector<std::pair<ClassInfo *, cjbp::Method *>> implementations{};
+  ClassInfo *clazz = this->Load(class_name);
+  if (clazz == nullptr) return implementations;
+
+  for (ClassInfo *instantiated : this->instantiated_order_) {
+    if (!this->IsSubClassOf(instantiated, clazz)) continue;
+    std::pair<ClassInfo *, cjbp::Method *> implementation = this->Resolve(instantiated, name, descriptor);
+    if (implementation.second == nullptr) continue;
+    if (std::find(implementations.begin(), implementations.end(), implementation) != implementations.end()) continue;
+    implementations.push_back(implementation);
+  }
+  return implementations;
+}
+bool ReachabilityAnalysis::IsInstantiated(const std::string &class_name) const {
+  ClassInfo *clazz = this->Load(class_name);
+  return (clazz != nullptr) && (this->instantiated_classes_.count(clazz) != 0);
+}
+
+void ReachabilityAnalysis::MarkReachable(ClassInfo *clazz, cjbp::Method *method) {
+  if (!this->reachable_methods_.insert(GetMethodKey(clazz->name(), method->name(), method->descriptor())).second) {
+    return;
+  }
+  this->MarkUsed(clazz);
+  this->worklist_.emplace_back(clazz, method);
+}
+
+void ReachabilityAnalysis::MarkUsed(ClassInfo *clazz) {
+  if (!this->used_class_set_.insert(clazz).second) return;
+
+  // Super classes are emitted before their sub classes.
+  ClassInfo *super_class = this->LoadSuperClass(clazz);
+  if (super_class != nullptr) this->MarkUsed(super_class);
+  this->used_classes_.push_back(clazz);
+
+  for (const auto &method : clazz->bytecode()->methods()) {
+    if (method->name() == "<clinit>") this->MarkReachable(clazz, method.get());
+  }
+}
+
+void ReachabilityAnalysis::MarkInstantiated(ClassInfo *clazz) {
+  if (!this->instantiated_classes_.insert(clazz).second) return;
+  this->instantiated_order_.push_back(clazz);
+  this->MarkUsed(clazz);
+
+  // Every virtual method that has already been called can now run on this class. A class's own methods are seen
+  // before the ones that they override, which never run on it.
+  std::unordered_set<std::string> seen_selectors{};
+  for (ClassInfo *owner = clazz; owner != nullptr; owner = this->LoadSuperClass(owner)) {
+    for (const auto &method : owner->bytecode()->methods()) {
+      if (method->access_flags() & cjbp::AccessFlags::kStatic) continue;
+      std::string selector = GetSelectorKey(method->name(), method->descriptor());
+      if (!seen_selectors.insert(selector).second) continue;
+      if (this->called_selectors_.count(selector) != 0) this->MarkReachable(owner, method.get());
+    }
+  }
+}
+
+void ReachabilityAnalysis::MarkCalled(const std::string &name, const std::string &descriptor) {
+  if (!this->called_selectors_.insert(GetSelectorKey(name, descriptor)).second) return;
+
+  for (ClassInfo *clazz : this->instantiated_order_) {
+    auto [owner, implementation] = this->Resolve(clazz, name, descriptor);
+    if (implementation == nullptr || (implementation->access_flags() & cjbp::AccessFlags::kStatic)) continue;
+    this->MarkReachable(owner, implementation);
+  }
+}
+
+void ReachabilityAnalysis::MarkStaticCall(const std::string &class_name, const std::string &name,
+                                          const std::string &descriptor) {
+  // Methods of classes that aren't on the class path are left as declarations, as they are by codegen.
+  ClassInfo *clazz = this->Load(class_name);
+  if (clazz == nullptr) return;
+  auto [owner, method] = this->Resolve(clazz, name, descriptor);
+  if (method != nullptr) this->MarkReachable(owner, method);
+}
+
+void ReachabilityAnalysis::MarkConstant(const cjbp::ConstPool &pool, uint16_t pool_index) {
+  // The runtime allocates string constants.
+  if (pool.GetTag(pool_index) != cjbp::ConstTag::kString) return;
+  ClassInfo *string_class = this->Load("java/lang/String");
+  if (string_class != nullptr) this->MarkInstantiated(string_class);
+}
+
+void ReachabilityAnalysis::Visit(ClassInfo *clazz, cjbp::Method *method) {
+  // Methods that are replaced by intrinsics never run their bytecode (or their native code).
+  const IntrinsicRegistry *intrinsics = this->ctx_->intrinsics();
+  if (intrinsics != nullptr && intrinsics->Find(clazz->name(), method->name(), method->descriptor()) != nullptr) {
+    // The runtime's Thread.start calls Thread.run through its dispatch thunk, which is emitted along with Thread.run.
+    if (clazz->name() == "java.lang.Thread" && method->name() == "start" && method->descriptor() == "()V") {
+      this->MarkStaticCall("java/lang/Thread", "run", "()V");
+    }
+    return;
+  }
+
+  cjbp::Method *body = clazz->GetMethodBody(method);
+  if (body->code_attribute() == nullptr) {
+    // Native code can create objects of any class.
+    if (method->access_flags() & cjbp::AccessFlags::kNative) this->sees_all_instantiations_ = false;
+    return;
+  }
+
+  // Instructions refer to the constant pool of the class that they are in.
+  const cjbp::ConstPool &pool = clazz->bytecode()->const_pool();
+  cjbp::CodeIterator iterator(*body->code_attribute());
+  while (iterator.HasNext()) {
+    size_t index = iterator.Next();
+    switch (iterator.ReadUInt8(index)) {
+      case cjbp::Opcode::kInvokeStatic:
+      case cjbp::Opcode::kInvokeSpecial: {
+        uint16_t pool_index = iterator.ReadUInt16(index + 1);
+        this->MarkStaticCall(*pool.GetMethodRefClass(pool_index), *pool.GetMethodRefName(pool_index),
+                             *pool.GetMethodRefType(pool_index));
+        break;
+      }
+      case cjbp::Opcode::kInvokeVirtual:
+      case cjbp::Opcode::kInvokeInterface: {
+        uint16_t pool_index = iterator.ReadUInt16(index + 1);
+        const std::string &name = *pool.GetMethodRefName(pool_index);
+        const std::string &descriptor = *pool.GetMethodRefType(pool_index);
+        this->MarkCalled(name, descriptor);
+        // Virtual calls go through the dispatch thunk of the method that they name, which is emitted along with that
+        // method.
+        this->MarkStaticCall(*pool.GetMethodRefClass(pool_index), name, descriptor);
+        break;
+      }
+      case cjbp::Opcode::kLdc: this->MarkConstant(pool, iterator.ReadUInt8(index + 1)); break;
+      case cjbp::Opcode::kLdcW: this->MarkConstant(pool, iterator.ReadUInt16(index + 1)); break;
+      case cjbp::Opcode::kNew: {
+        ClassInfo *instantiated = this->Load(*pool.GetClassName(iterator.ReadUInt16(index + 1)));
+        if (instantiated != nullptr) this->MarkInstantiated(instantiated);
+        break;
+      }
+      case cjbp::Opcode::kGetStatic:
+      case cjbp::Opcode::kPutStatic: {
+        ClassInfo *owner = this->Load(*pool.GetFieldRefClass(iterator.ReadUInt16(index + 1)));
+        if (owner != nullptr) this->MarkUsed(owner);
+        break;
+      }
+      default: break;
+    }
+  }
+}
+
+ClassInfo *ReachabilityAnalysis::Load(const std::string &class_name) const {
+  return this->ctx_->pool()->Load(class_name);
+}
+ClassInfo *ReachabilityAnalysis::LoadSuperClass(ClassInfo *clazz) const {
+  const std::string *super_class_name = clazz->bytecode()->super_class();
+  if (super_class_name == nullptr) return nullptr;
+
+  ClassInfo *super_class = this->Load(*super_class_name);
+  if (super_class == nullptr) {
+    throw BadBytecode("could not find " + clazz->name() + "'s super class " + *super_class_name);
+  }
+  return super_class;
+}
+bool ReachabilityAnalysis::IsSubClassOf(ClassInfo *clazz, const ClassInfo *super_class) const {
+  for (; clazz != nullptr; clazz = this->LoadSuperClass(clazz)) {
+    if (clazz == super_class) return true;
+  }
+  return false;
+}
+std::pair<ClassInfo *, cjbp::Method *> ReachabilityAnalysis::Resolve(ClassInfo *clazz, const std::string &name,
+                                                                     const std::string &descriptor) const {
+  for (; clazz != nullptr; clazz = this->LoadSuperClass(clazz)) {
+    for (const auto &method : clazz->bytecode()->methods()) {
+      if (method->name() == name && method->descriptor() == descriptor) return {clazz, method.get()};
+    }
+  }
+  return {nullptr, nullptr};
+}
+
+}// namespace magnetic
@@ -0,0 +1,105 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <cjbp/cjbp.h>
+
+namespace magnetic {
+
+class ClassInfo;
+class Context;
+
+/**
+ * Whole-program reachability, in the style of rapid type analysis: starting from the roots, a method is reachable if a
+ * reachable method calls it statically (invokestatic, invokespecial), or if it implements a virtual method that a
+ * reachable method calls on some class that a reachable method instantiates. Only reachable methods are compiled.
+ *
+ * The analysis reads bytecode only. Classes are loaded (see ClassPool::Load) but not emitted, so it must run to
+ * completion before the first class is emitted.
+ *
+ * A class is used, and will be emitted, if it has a reachable method, is instantiated, or has its static fields
+ * accessed. The super classes of a used class are also used, and so is its static initializer.
+ */
+class ReachabilityAnalysis {
+ public:
+  explicit ReachabilityAnalysis(Context *ctx);
+
+  void AddRoot(ClassInfo *clazz, cjbp::Method *method);
+  /**
+   * Visits the methods reached from the roots, until nothing more is reachable.
+   */
+  void Run();
+
+  [[nodiscard]] bool IsReachable(const std::string &class_name, const std::string &name,
+                                 const std::string &descriptor) const;
+  [[nodiscard]] bool IsInstantiated(const std::string &class_name) const;
+  /**
+   * Resolves the method that a call to name and descriptor on the class runs (which may be declared in a super class),
+   * and checks whether an instance of the class could run a different method instead.
+   *
+   * @return true if an instantiated sub class of the class overrides the method, or if that isn't known (the class or
+   *         the method can't be found, the method is abstract, or native code may create objects that the analysis
+   *         doesn't see)
+   */
+  [[nodiscard]] bool IsOverridden(const std::string &class_name, const std::string &name,
+                                  const std::string &descriptor) const;
+  /**
+   * @return the methods that a virtual call to name and descriptor can run on an instance of the class or of one of its
+   *         sub classes, given the classes that are instantiated
+   */
+  [[nodiscard]] std::vector<std::pair<ClassInfo *, cjbp::Method *>> FindImplementations(
+      const std::string &class_name, const std::string &name, const std::string &descriptor) const;
+  /**
+   * Objects are created by compiled code, and by the runtime for string constants, which the analysis accounts for.
+   * Reachable native methods can create objects of any class without the analysis seeing it, in which case
+   * FindImplementations may miss the methods of classes that are only instantiated by native code.
+   *
+   * @return false if a reachable native method may create objects
+   */
+  [[nodiscard]] bool sees_all_instantiations() const { return this->sees_all_instantiations_; }
+  /**
+   * @return the used classes, in the order that they were found
+   */
+  [[nodiscard]] const std::vector<ClassInfo *> &used_classes() const { return this->used_classes_; }
+
+ private:
+  Context *ctx_;
+  std::unordered_set<std::string> reachable_methods_;
+  std::unordered_set<std::string> called_selectors_;
+  std::unordered_set<const ClassInfo *> instantiated_classes_;
+  std::vector<ClassInfo *> instantiated_order_;
+  std::unordered_set<const ClassInfo *> used_class_set_;
+  std::vector<ClassInfo *> used_classes_;
+  std::vector<std::pair<ClassInfo *, cjbp::Method *>> worklist_;
+  bool sees_all_instantiations_;
+
+  void MarkReachable(ClassInfo *clazz, cjbp::Method *method);
+  void MarkUsed(ClassInfo *clazz);
+  void MarkInstantiated(ClassInfo *clazz);
+  void MarkCalled(const std::string &name, const std::string &descriptor);
+  void MarkStaticCall(const std::string &class_name, const std::string &name, const std::string &descriptor);
+  void MarkConstant(const cjbp::ConstPool &pool, uint16_t pool_index);
+
+  void Visit(ClassInfo *clazz, cjbp::Method *method);
+
+  [[nodiscard]] ClassInfo *Load(const std::string &class_name) const;
+  [[nodiscard]] ClassInfo *LoadSuperClass(ClassInfo *clazz) const;
+  [[nodiscard]] bool IsSubClassOf(ClassInfo *clazz, const ClassInfo *super_class) const;
+  /**
+   * Finds the method that a call to name and descriptor on the class runs: the class's own method, or else the one it
+   * inherits from the nearest super class.
+   *
+   * @return nullptr in both members if no class in the super class chain has the method
+   */
+  [[nodiscard]] std::pair<ClassInfo *, cjbp::Method *> Resolve(ClassInfo *clazz, const std::string &name,
+                                                                const std::string &descriptor) const;
+};
+
+}// namespace magnetic
@@ -4,6 +4,7 @@
 
 #include "basic-block.h"
 
+#include <algorithm>
 #include <cassert>
 
 namespace magnetic {
@@ -13,4 +14,19 @@ llvm::BasicBlock *BasicBlock::llvm_block() const {
   return this->llvm_block_;
 }
 
+void BasicBlock::AddSuccessor(BasicBlock *successor) {
+  // A conditional branch to the next instruction has the same block as both of its successors.
+  if (std::find(this->successors_.begin(), this->successors_.end(), successor) != this->successors_.end()) return;
+  this->successors_.push_back(successor);
+  successor->predecessors_.push_back(this);
+}
+
+bool BasicBlock::Dominates(const BasicBlock *other) const {
+  if (!this->is_reachable() || !other->is_reachable()) return false;
+  for (const BasicBlock *block = other; block != nullptr; block = block->immediate_dominator_) {
+    if (block == this) return true;
+  }
+  return false;
+}
+
 }
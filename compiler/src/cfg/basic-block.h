@@ -4,24 +4,59 @@
 
 #pragma once
 
+#include <vector>
+
 #include <llvm/IR/BasicBlock.h>
 #include <cjbp/cjbp.h>
 
 namespace magnetic {
 
+class Loop;
+
 class BasicBlock {
  public:
   BasicBlock(int32_t start, int32_t end)
-      : start_(start), end_(end), llvm_block_(nullptr) {}
+      : start_(start), end_(end), llvm_block_(nullptr), successors_(), predecessors_(), rpo_index_(-1),
+        immediate_dominator_(nullptr), loop_(nullptr) {}
 
   [[nodiscard]] int32_t start() const { return this->start_; }
   [[nodiscard]] int32_t end() const { return this->end_; }
   [[nodiscard]] llvm::BasicBlock *llvm_block() const;
   void set_llvm_block(llvm::BasicBlock *block) { this->llvm_block_ = block; }
 
+  [[nodiscard]] const std::vector<BasicBlock *> &successors() const { return this->successors_; }
+  [[nodiscard]] const std::vector<BasicBlock *> &predecessors() const { return this->predecessors_; }
+  void AddSuccessor(BasicBlock *successor);
+
+  /**
+   * @return false if the block can't be reached from the entry block (it is not part of the reverse postorder, and has
+   *         no dominator or loop)
+   */
+  [[nodiscard]] bool is_reachable() const { return this->rpo_index_ >= 0; }
+  [[nodiscard]] int32_t rpo_index() const { return this->rpo_index_; }
+  void set_rpo_index(int32_t index) { this->rpo_index_ = index; }
+  /**
+   * @return the closest block that every path from the entry block to this block goes through, or nullptr for the
+   *         entry block
+   */
+  [[nodiscard]] BasicBlock *immediate_dominator() const { return this->immediate_dominator_; }
+  void set_immediate_dominator(BasicBlock *block) { this->immediate_dominator_ = block; }
+  [[nodiscard]] bool Dominates(const BasicBlock *other) const;
+  /**
+   * @return the innermost loop that contains this block, or nullptr if it is not in a loop
+   */
+  [[nodiscard]] Loop *loop() const { return this->loop_; }
+  void set_loop(Loop *loop) { this->loop_ = loop; }
+
  private:
   int32_t start_, end_;
   llvm::BasicBlock *llvm_block_;
+
+  std::vector<BasicBlock *> successors_;
+  std::vector<BasicBlock *> predecessors_;
+  int32_t rpo_index_;
+  BasicBlock *immediate_dominator_;
+  Loop *loop_;
 };
 
 }
@@ -7,20 +7,35 @@
 #include <algorithm>
 #include <memory>
 #include <unordered_set>
+#include <utility>
 
 #include "basic-block.h"
 
 namespace magnetic {
 
-ControlFlowGraph::ControlFlowGraph(cjbp::CodeIterator &it) : entry_block_(nullptr), blocks_() {
+namespace {
+bool IsBranch(uint8_t opcode) { return cjbp::Opcode::kIfEq <= opcode && opcode <= cjbp::Opcode::kGoto; }
+bool IsUnconditionalBranch(uint8_t opcode) { return opcode == cjbp::Opcode::kGoto; }
+bool IsExit(uint8_t opcode) {
+  return (cjbp::Opcode::kIReturn <= opcode && opcode <= cjbp::Opcode::kReturn) || opcode == cjbp::Opcode::kAThrow;
+}
+}// namespace
+
+ControlFlowGraph::ControlFlowGraph(cjbp::CodeIterator &it)
+    : entry_block_(nullptr), blocks_(), reverse_post_order_(), loops_() {
   std::unordered_set<int32_t> leaders{};
+  std::vector<int32_t> instructions{};
   leaders.insert(0);
   while (it.HasNext()) {
     size_t index = it.Next();
+    instructions.push_back(static_cast<int32_t>(index));
     uint8_t opcode = it.ReadUInt8(index);
-    if (cjbp::Opcode::kIfEq <= opcode && opcode <= cjbp::Opcode::kGoto) {
+    if (IsBranch(opcode)) {
       leaders.insert(static_cast<int32_t>(index + it.ReadInt16(index + 1)));
       leaders.insert(static_cast<int32_t>(it.LookAhead()));
+    } else if (IsExit(opcode) && it.HasNext()) {
+      // Anything after a return is only reachable if it is jumped to, so it has to start a new block.
+      leaders.insert(static_cast<int32_t>(it.LookAhead()));
     }
   }
 
@@ -33,6 +48,11 @@ ControlFlowGraph::ControlFlowGraph(cjbp::CodeIterator &it) : entry_block_(nullpt
     this->blocks_.emplace(start, BasicBlock(start, end));
   }
   this->entry_block_ = &this->blocks_.at(0);
+
+  this->ComputeEdges(it, instructions);
+  this->ComputeReversePostOrder();
+  this->ComputeDominators();
+  this->ComputeLoops();
 }
 
 BasicBlock &ControlFlowGraph::entry_block() const {
@@ -43,4 +63,127 @@ BasicBlock &ControlFlowGraph::GetBlock(int32_t inst) {
   return this->blocks().at(inst);
 }
 
+void ControlFlowGraph::ComputeEdges(cjbp::CodeIterator &it, const std::vector<int32_t> &instructions) {
+  for (auto &[start, block] : this->blocks_) {
+    // The last instruction of the block decides where control goes next.
+    auto last = std::lower_bound(instructions.begin(), instructions.end(), block.end());
+    if (last == instructions.begin()) continue;
+    int32_t index = *(last - 1);
+    uint8_t opcode = it.ReadUInt8(index);
+
+    if (IsBranch(opcode)) block.AddSuccessor(&this->GetBlock(index + it.ReadInt16(index + 1)));
+    if (IsExit(opcode) || IsUnconditionalBranch(opcode)) continue;
+
+    const auto &next = this->blocks_.find(block.end());
+    if (next != this->blocks_.end()) block.AddSuccessor(&next->second);
+  }
+}
+
+void ControlFlowGraph::ComputeReversePostOrder() {
+  // Iterative depth first search; each entry is a block and the index of the next successor to visit.
+  std::vector<BasicBlock *> post_order{};
+  std::unordered_set<BasicBlock *> visited{this->entry_block_};
+  std::vector<std::pair<BasicBlock *, size_t>> stack{{this->entry_block_, 0}};
+  while (!stack.empty()) {
+    auto &[block, successor_index] = stack.back();
+    if (successor_index < block->successors().size()) {
+      BasicBlock *successor = block->successors()[successor_index++];
+      if (visited.insert(successor).second) stack.emplace_back(successor, 0);
+    } else {
+      post_order.push_back(block);
+      stack.pop_back();
+    }
+  }
+
+  this->reverse_post_order_.assign(post_order.rbegin(), post_order.rend());
+  for (size_t i = 0; i < this->reverse_post_order_.size(); ++i) {
+    this->reverse_post_order_[i]->set_rpo_index(static_cast<int32_t>(i));
+  }
+}
+
+void ControlFlowGraph::ComputeDominators() {
+  // "A Simple, Fast Dominance Algorithm" (Cooper, Harvey and Kennedy). While iterating, the entry block is its own
+  // immediate dominator so that the intersection walk terminates; it is reset to nullptr at the end.
+  BasicBlock *entry = this->entry_block_;
+  entry->set_immediate_dominator(entry);
+  auto intersect = [](BasicBlock *lhs, BasicBlock *rhs) {
+    while (lhs != rhs) {
+      while (lhs->rpo_index() > rhs->rpo_index()) lhs = lhs->immediate_dominator();
+      while (rhs->rpo_index() > lhs->rpo_index()) rhs = rhs->immediate_dominator();
+    }
+    return lhs;
+  };
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (BasicBlock *block : this->reverse_post_order_) {
+      if (block == entry) continue;
+
+      BasicBlock *dominator = nullptr;
+      for (BasicBlock *predecessor : block->predecessors()) {
+        if (predecessor->immediate_dominator() == nullptr) continue;// Not processed yet, or unreachable.
+        dominator = (dominator == nullptr) ? predecessor : intersect(predecessor, dominator);
+      }
+      if (dominator != block->immediate_dominator()) {
+        block->set_immediate_dominator(dominator);
+        changed = true;
+      }
+    }
+  }
+  entry->set_immediate_dominator(nullptr);
+}
+
+void ControlFlowGraph::ComputeLoops() {
+  // Every edge to a block that dominates its source is a back edge, and its target is a loop header. Back edges that
+  // share a header belong to the same loop. Retreating edges to blocks that don't dominate their source would make
+  // an irreducible loop; javac never produces them, and they are left as ordinary control flow.
+  std::map<BasicBlock *, Loop *> loops_by_header{};
+  for (BasicBlock *latch : this->reverse_post_order_) {
+    for (BasicBlock *header : latch->successors()) {
+      if (!header->Dominates(latch)) continue;
+
+      Loop *&loop = loops_by_header[header];
+      if (loop == nullptr) {
+        this->loops_.push_back(std::make_unique<Loop>(header));
+        loop = this->loops_.back().get();
+      }
+      loop->latches().push_back(latch);
+    }
+  }
+
+  for (const auto &loop : this->loops_) {
+    // The loop body is everything that can reach a latch backwards without going through the header.
+    std::unordered_set<BasicBlock *> body{loop->header()};
+    std::vector<BasicBlock *> worklist(loop->latches().begin(), loop->latches().end());
+    while (!worklist.empty()) {
+      BasicBlock *block = worklist.back();
+      worklist.pop_back();
+      if (!body.insert(block).second) continue;
+      for (BasicBlock *predecessor : block->predecessors()) {
+        if (predecessor->is_reachable()) worklist.push_back(predecessor);
+      }
+    }
+    for (BasicBlock *block : this->reverse_post_order_) {
+      if (body.count(block) != 0) loop->blocks().push_back(block);
+    }
+  }
+
+  // Outer loops have more blocks than the loops nested in them, so after sorting by size, the innermost loop that
+  // contains a block is the last one to claim it, and a loop's parent is the last loop before it that contains its
+  // header.
+  std::stable_sort(this->loops_.begin(), this->loops_.end(), [](const auto &lhs, const auto &rhs) {
+    return lhs->blocks().size() > rhs->blocks().size();
+  });
+  for (const auto &loop : this->loops_) {
+    Loop *parent = loop->header()->loop();
+    if (parent != nullptr) {
+      loop->set_parent(parent);
+      loop->set_depth(parent->depth() + 1);
+      parent->set_innermost(false);
+    }
+    for (BasicBlock *block : loop->blocks()) { block->set_loop(loop.get()); }
+  }
+}
+
 }
@@ -7,10 +7,12 @@
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <vector>
 
 #include <cjbp/cjbp.h>
 
 #include "basic-block.h"
+#include "loop.h"
 
 namespace magnetic {
 
@@ -22,9 +24,26 @@ class ControlFlowGraph {
   [[nodiscard]] auto &blocks() { return this->blocks_; }
   [[nodiscard]] BasicBlock &GetBlock(int32_t inst);
 
+  /**
+   * @return the blocks that are reachable from the entry block, in reverse postorder (every block comes before its
+   *         successors, except along back edges)
+   */
+  [[nodiscard]] const std::vector<BasicBlock *> &reverse_post_order() const { return this->reverse_post_order_; }
+  /**
+   * @return the natural loops of the method, outer loops before the loops nested in them
+   */
+  [[nodiscard]] const std::vector<std::unique_ptr<Loop>> &loops() const { return this->loops_; }
+
  private:
   BasicBlock *entry_block_;
   std::map<int32_t, BasicBlock> blocks_;
+  std::vector<BasicBlock *> reverse_post_order_;
+  std::vector<std::unique_ptr<Loop>> loops_;
+
+  void ComputeEdges(cjbp::CodeIterator &it, const std::vector<int32_t> &instructions);
+  void ComputeReversePostOrder();
+  void ComputeDominators();
+  void ComputeLoops();
 };
 
 }// namespace magnetic
@@ -0,0 +1,57 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace magnetic {
+
+class BasicBlock;
+
+/**
+ * A natural loop: a header block that dominates every block in the loop, and the blocks that can reach one of the
+ * header's back edges without going through the header.
+ */
+class Loop {
+ public:
+  explicit Loop(BasicBlock *header) : header_(header), blocks_(), latches_(), parent_(nullptr), depth_(1),
+                                       is_innermost_(true) {}
+
+  [[nodiscard]] BasicBlock *header() const { return this->header_; }
+  /**
+   * @return every block in the loop (including the header and the blocks of nested loops), in reverse postorder
+   */
+  [[nodiscard]] const std::vector<BasicBlock *> &blocks() const { return this->blocks_; }
+  [[nodiscard]] std::vector<BasicBlock *> &blocks() { return this->blocks_; }
+  /**
+   * @return the blocks in the loop that jump back to the header
+   */
+  [[nodiscard]] const std::vector<BasicBlock *> &latches() const { return this->latches_; }
+  [[nodiscard]] std::vector<BasicBlock *> &latches() { return this->latches_; }
+
+  /**
+   * @return the innermost loop that contains this loop, or nullptr for an outermost loop
+   */
+  [[nodiscard]] Loop *parent() const { return this->parent_; }
+  void set_parent(Loop *parent) { this->parent_ = parent; }
+  /**
+   * @return the number of loops this loop is nested in, plus one
+   */
+  [[nodiscard]] int32_t depth() const { return this->depth_; }
+  void set_depth(int32_t depth) { this->depth_ = depth; }
+  [[nodiscard]] bool is_innermost() const { return this->is_innermost_; }
+  void set_innermost(bool value) { this->is_innermost_ = value; }
+
+ private:
+  BasicBlock *header_;
+  std::vector<BasicBlock *> blocks_;
+  std::vector<BasicBlock *> latches_;
+  Loop *parent_;
+  int32_t depth_;
+  bool is_innermost_;
+};
+
+}// namespace magnetic
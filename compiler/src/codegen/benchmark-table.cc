@@ -0,0 +1,71 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "benchmark-table.h"
+
+#include <optional>
+
+#include <cjbp/cjbp.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/IRBuilder.h>
+
+#include "context/context.h"
+#include "types/class/class.h"
+#include "types/class/method.h"
+
+namespace magnetic {
+
+namespace {
+// Must match MagneticBenchmarkKind in runtime/bench/harness.h.
+enum BenchmarkKind : uint32_t { kReturnsVoid = 0, kReturnsInt = 1, kReturnsLong = 2 };
+
+std::optional<BenchmarkKind> GetBenchmarkKind(const cjbp::Method &method) {
+  if (!(method.access_flags() & cjbp::AccessFlags::kStatic)) return std::nullopt;
+  if (method.name().rfind("bench", 0) != 0) return std::nullopt;
+  if (method.descriptor() == "()V") return kReturnsVoid;
+  if (method.descriptor() == "()I") return kReturnsInt;
+  if (method.descriptor() == "()J") return kReturnsLong;
+  return std::nullopt;
+}
+}// namespace
+
+size_t EmitBenchmarkTable(llvm::Module *module, const std::vector<ClassInfo *> &classes,
+                          const std::string &configuration) {
+  llvm::LLVMContext &llvm_ctx = module->getContext();
+  llvm::IRBuilder<> builder(llvm_ctx);
+  llvm::PointerType *ptr_type = llvm::PointerType::get(llvm_ctx, 0);
+  llvm::StructType *entry_type =
+      llvm::StructType::create(llvm_ctx, {ptr_type, ptr_type, builder.getInt32Ty()}, "magnetic.benchmark");
+
+  std::vector<llvm::Constant *> entries{};
+  for (ClassInfo *class_info : classes) {
+    Context *ctx = class_info->ctx();
+    for (const auto &method_bytecode : class_info->bytecode()->methods()) {
+      std::optional<BenchmarkKind> kind = GetBenchmarkKind(*method_bytecode);
+      if (!kind.has_value()) continue;
+
+      MethodDeclaration *method =
+          ctx->GetMethod(class_info->name(), method_bytecode->name(), method_bytecode->descriptor(), true);
+      // Benchmarks are reported as Class.method, matching the Java source rather than the mangled symbol.
+      std::string name = class_info->name() + "." + method_bytecode->name();
+      llvm::Constant *name_string = builder.CreateGlobalStringPtr(name, "", 0, module);
+      entries.push_back(llvm::ConstantStruct::get(
+          entry_type, {name_string, method->GetFunctionInModule(module), builder.getInt32(*kind)}));
+    }
+  }
+
+  llvm::ArrayType *table_type = llvm::ArrayType::get(entry_type, entries.size());
+  new llvm::GlobalVariable(*module, table_type, true, llvm::GlobalValue::ExternalLinkage,
+                           llvm::ConstantArray::get(table_type, entries), "Magnetic_bench_table");
+  new llvm::GlobalVariable(*module, builder.getInt32Ty(), true, llvm::GlobalValue::ExternalLinkage,
+                           builder.getInt32(entries.size()), "Magnetic_bench_table_size");
+  llvm::Constant *configuration_string = builder.CreateGlobalStringPtr(configuration, "", 0, module);
+  new llvm::GlobalVariable(*module, ptr_type, true, llvm::GlobalValue::ExternalLinkage, configuration_string,
+                           "Magnetic_bench_configuration");
+  return entries.size();
+}
+
+bool IsBenchmarkMethod(const cjbp::Method &method) { return GetBenchmarkKind(method).has_value(); }
+
+}// namespace magnetic
@@ -0,0 +1,40 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <cjbp/cjbp.h>
+#include <llvm/IR/Module.h>
+
+namespace magnetic {
+
+class ClassInfo;
+
+/**
+ * Emits the table of benchmark methods that the runtime benchmark harness (runtime/bench) runs.
+ *
+ * A benchmark is a static method whose name starts with "bench", that takes no arguments and returns void, int or
+ * long. Returning the computed value is how a benchmark keeps its work alive: the harness consumes the result, so the
+ * optimizer can't delete the computation.
+ *
+ * The table is laid out as:
+ *   Magnetic_bench_table: [N x {ptr name, ptr function, i32 result kind}]
+ *   Magnetic_bench_table_size: i32 N
+ *   Magnetic_bench_configuration: ptr to a string describing how the module was compiled (such as "O2")
+ * which must match MagneticBenchmark in runtime/bench/harness.h.
+ *
+ * @return the number of benchmarks in the table
+ */
+size_t EmitBenchmarkTable(llvm::Module *module, const std::vector<ClassInfo *> &classes,
+                          const std::string &configuration);
+
+/**
+ * @return true if the method is a benchmark that EmitBenchmarkTable would put in the table
+ */
+[[nodiscard]] bool IsBenchmarkMethod(const cjbp::Method &method);
+
+}// namespace magnetic
@@ -0,0 +1,174 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "call-profile.h"
+
+#include <cassert>
+
+#include <llvm/IR/Constants.h>
+#include <llvm/Transforms/Utils/ModuleUtils.h>
+
+namespace magnetic {
+
+std::unique_ptr<CallProfileEmitter> CallProfileEmitter::Create(llvm::Module *module) {
+  return std::make_unique<CallProfileEmitter>(module);
+}
+CallProfileEmitter::CallProfileEmitter(llvm::Module *module)
+    : module_(module), counters_(nullptr), counter_count_(0), records_(), vtables_(), is_finalized_(false) {}
+
+llvm::Constant *CallProfileEmitter::GetCounter(int32_t offset) {
+  llvm::IntegerType *int64 = llvm::Type::getInt64Ty(this->module_->getContext());
+  if (this->counters_ == nullptr) {
+    this->counters_ = new llvm::GlobalVariable(*this->module_, int64, false, llvm::GlobalValue::ExternalLinkage,
+                                               nullptr, "magnetic.call_counters.placeholder", nullptr,
+                                               llvm::GlobalValue::InitialExecTLSModel);
+  }
+  return llvm::ConstantExpr::getGetElementPtr(int64, this->counters_, llvm::ConstantInt::get(int64, offset));
+}
+int32_t CallProfileEmitter::AddRecord(RecordKind kind, int32_t counter_count, std::string name, std::string target) {
+  assert(!this->is_finalized_);
+
+  int32_t offset = this->counter_count_;
+  this->counter_count_ += counter_count;
+  this->records_.push_back({kind, offset, std::move(name), std::move(target)});
+  return offset;
+}
+
+void CallProfileEmitter::EmitMethodEntry(llvm::IRBuilder<> &builder, const std::string &method_name) {
+  int32_t offset = this->AddRecord(RecordKind::kMethodEntry, 1, method_name, "");
+  llvm::Constant *counter = this->GetCounter(offset);
+  llvm::Value *count = builder.CreateLoad(builder.getInt64Ty(), counter, "entry_count");
+  builder.CreateStore(builder.CreateAdd(count, builder.getInt64(1)), counter);
+}
+
+void CallProfileEmitter::EmitReceiverProfile(llvm::IRBuilder<> &builder, const std::string &site_name,
+                                             const std::string &target_name, llvm::Value *vtable) {
+  static constexpr const char *kRecordReceiverName = "Magnetic_rt_record_receiver";
+
+  int32_t offset = this->AddRecord(RecordKind::kReceivers, kReceiverRows * 2 + 1, site_name, target_name);
+  llvm::LLVMContext &llvm_ctx = builder.getContext();
+  llvm::Function *function = builder.GetInsertBlock()->getParent();
+  llvm::PointerType *ptr_type = llvm::PointerType::get(llvm_ctx, 0);
+  llvm::Constant *histogram = this->GetCounter(offset);
+
+  // Most sites only ever see one class, so the first row is checked inline.
+  llvm::BasicBlock *hit_block = llvm::BasicBlock::Create(llvm_ctx, "first_receiver_hit", function);
+  llvm::BasicBlock *miss_block = llvm::BasicBlock::Create(llvm_ctx, "first_receiver_miss", function);
+  llvm::BasicBlock *done_block = llvm::BasicBlock::Create(llvm_ctx, "receiver_profile_done", function);
+  llvm::Value *first_vtable = builder.CreateLoad(ptr_type, histogram, "first_receiver");
+  builder.CreateCondBr(builder.CreateICmpEQ(first_vtable, vtable, "is_first_receiver"), hit_block, miss_block);
+
+  builder.SetInsertPoint(hit_block);
+  llvm::Constant *counter = this->GetCounter(offset + 1);
+  llvm::Value *count = builder.CreateLoad(builder.getInt64Ty(), counter, "first_receiver_count");
+  builder.CreateStore(builder.CreateAdd(count, builder.getInt64(1)), counter);
+  builder.CreateBr(done_block);
+
+  // The runtime claims the first row if it is still empty, so the inline check starts hitting after the first call.
+  builder.SetInsertPoint(miss_block);
+  llvm::FunctionType *record_type = llvm::FunctionType::get(builder.getVoidTy(), {ptr_type, ptr_type}, false);
+  llvm::FunctionCallee record = this->module_->getOrInsertFunction(kRecordReceiverName, record_type);
+  if (auto *declaration = llvm::dyn_cast<llvm::Function>(record.getCallee())) {
+    declaration->addFnAttr(llvm::Attribute::NoUnwind);
+  }
+  builder.CreateCall(record, {histogram, vtable});
+  builder.CreateBr(done_block);
+
+  builder.SetInsertPoint(done_block);
+}
+
+void CallProfileEmitter::AddVTable(llvm::GlobalVariable *vtable, const std::string &class_name) {
+  assert(!this->is_finalized_);
+  this->vtables_.emplace_back(vtable, class_name);
+}
+
+void CallProfileEmitter::Finalize() {
+  if (this->is_finalized_) return;
+  this->is_finalized_ = true;
+  this->EmitCounters();
+  this->EmitVTableTable();
+}
+
+void CallProfileEmitter::EmitCounters() {
+  if (this->counters_ == nullptr) return;
+
+  llvm::LLVMContext &llvm_ctx = this->module_->getContext();
+  llvm::IRBuilder<> builder(llvm_ctx);
+  llvm::PointerType *ptr_type = llvm::PointerType::get(llvm_ctx, 0);
+  llvm::Align ptr_align(this->module_->getDataLayout().getPointerABIAlignment(0));
+
+  // Counting code was emitted against a placeholder, since the number of counters is only known now.
+  llvm::ArrayType *counters_type = llvm::ArrayType::get(builder.getInt64Ty(), this->counter_count_);
+  auto *counters = new llvm::GlobalVariable(*this->module_, counters_type, false, llvm::GlobalValue::InternalLinkage,
+                                            llvm::ConstantAggregateZero::get(counters_type), "magnetic.call_counters",
+                                            nullptr, llvm::GlobalValue::InitialExecTLSModel);
+  counters->setAlignment(llvm::Align(64));// Keeps a thread's counters off of the cache lines of other data.
+  this->counters_->replaceAllUsesWith(counters);
+  this->counters_->eraseFromParent();
+  this->counters_ = counters;
+
+  // A thread-local variable's address depends on the thread, so the runtime calls this on each thread that it attaches
+  // to find that thread's counters.
+  llvm::Function *getter =
+      llvm::Function::Create(llvm::FunctionType::get(ptr_type, llvm::None, false), llvm::GlobalValue::InternalLinkage,
+                             "magnetic.call_counters.get", this->module_);
+  getter->addFnAttr(llvm::Attribute::NoInline);
+  getter->addFnAttr(llvm::Attribute::NoUnwind);
+  builder.SetInsertPoint(llvm::BasicBlock::Create(llvm_ctx, "", getter));
+  builder.CreateRet(counters);
+
+  llvm::StructType *record_type =
+      llvm::StructType::get(llvm_ctx, {builder.getInt32Ty(), builder.getInt32Ty(), ptr_type, ptr_type});
+  std::vector<llvm::Constant *> records{};
+  records.reserve(this->records_.size());
+  for (const Record &record : this->records_) {
+    llvm::Constant *target = record.target.empty()
+                                 ? llvm::ConstantPointerNull::get(ptr_type)
+                                 : builder.CreateGlobalStringPtr(record.target, "", 0, this->module_);
+    records.push_back(llvm::ConstantStruct::get(
+        record_type, {builder.getInt32(static_cast<int32_t>(record.kind)), builder.getInt32(record.offset),
+                      builder.CreateGlobalStringPtr(record.name, "", 0, this->module_), target}));
+  }
+  llvm::ArrayType *records_type = llvm::ArrayType::get(record_type, records.size());
+  auto *records_table = new llvm::GlobalVariable(*this->module_, records_type, true, llvm::GlobalValue::PrivateLinkage,
+                                                 llvm::ConstantArray::get(records_type, records),
+                                                 "magnetic.call_profile.records");
+
+  // Like the method table, each module contributes an entry to the section, which the runtime finds through
+  // __start_magnetic_call_profile and __stop_magnetic_call_profile.
+  llvm::StructType *module_type =
+      llvm::StructType::get(llvm_ctx, {ptr_type, builder.getInt64Ty(), builder.getInt64Ty(), ptr_type});
+  llvm::Constant *module_entry = llvm::ConstantStruct::get(
+      module_type, {getter, builder.getInt64(this->counter_count_), builder.getInt64(records.size()), records_table});
+  auto *module_profile = new llvm::GlobalVariable(*this->module_, module_type, false, llvm::GlobalValue::PrivateLinkage,
+                                                  module_entry, "magnetic.call_profile");
+  module_profile->setSection("magnetic_call_profile");
+  module_profile->setAlignment(ptr_align);
+  llvm::appendToUsed(*this->module_, {module_profile});
+}
+
+void CallProfileEmitter::EmitVTableTable() {
+  if (this->vtables_.empty()) return;
+
+  llvm::LLVMContext &llvm_ctx = this->module_->getContext();
+  llvm::IRBuilder<> builder(llvm_ctx);
+  llvm::PointerType *ptr_type = llvm::PointerType::get(llvm_ctx, 0);
+  llvm::StructType *entry_type = llvm::StructType::get(llvm_ctx, {ptr_type, ptr_type});
+
+  std::vector<llvm::Constant *> entries{};
+  entries.reserve(this->vtables_.size());
+  for (const auto &[vtable, class_name] : this->vtables_) {
+    llvm::Constant *name_string = builder.CreateGlobalStringPtr(class_name, "", 0, this->module_);
+    entries.push_back(llvm::ConstantStruct::get(entry_type, {vtable, name_string}));
+  }
+
+  llvm::ArrayType *table_type = llvm::ArrayType::get(entry_type, entries.size());
+  auto *table = new llvm::GlobalVariable(*this->module_, table_type, false, llvm::GlobalValue::PrivateLinkage,
+                                         llvm::ConstantArray::get(table_type, entries), "magnetic.vtables");
+  table->setSection("magnetic_vtables");
+  table->setAlignment(llvm::Align(this->module_->getDataLayout().getPointerABIAlignment(0)));
+  llvm::appendToUsed(*this->module_, {table});
+}
+
+}// namespace magnetic
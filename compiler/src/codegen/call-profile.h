@@ -0,0 +1,84 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <llvm/IR/GlobalVariable.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Module.h>
+
+namespace magnetic {
+
+/**
+ * Instruments a module for the runtime's call profiler: every method counts its entries, and every virtual call site
+ * keeps a histogram of the classes (vtables) of its receivers.
+ *
+ * The counters of a module live in one thread-local array, so counting is a single increment that no other thread
+ * contends on. A receiver histogram has kReceiverRows rows of {vtable, count} followed by a count of the receivers that
+ * didn't fit; the site checks the first row inline, and leaves the other rows to Magnetic_rt_record_receiver.
+ *
+ * Finalize describes the counters to the runtime in the "magnetic_call_profile" section (one {ptr counters getter,
+ * i64 counter count, i64 record count, ptr records} per module, where each record is {i32 kind, i32 offset, ptr name,
+ * ptr target}), and lists the module's vtables with their class names in the "magnetic_vtables" section.
+ */
+class CallProfileEmitter {
+ public:
+  static constexpr int32_t kReceiverRows = 4;
+
+  static std::unique_ptr<CallProfileEmitter> Create(llvm::Module *module);
+
+  explicit CallProfileEmitter(llvm::Module *module);
+  CallProfileEmitter(const CallProfileEmitter &) = delete;
+  CallProfileEmitter &operator=(const CallProfileEmitter &) = delete;
+
+  /**
+   * Emits IR that counts an entry to the method.
+   * @param method_name the method's qualified name and descriptor, e.g. "java.lang.Object.hashCode()I"
+   */
+  void EmitMethodEntry(llvm::IRBuilder<> &builder, const std::string &method_name);
+  /**
+   * Emits IR that adds the receiver's vtable to a virtual call site's histogram. Leaves the builder in a new block.
+   * @param site_name the calling method and the bytecode offset of the call, e.g. "Main.run()V@12"
+   * @param target_name the method being called
+   */
+  void EmitReceiverProfile(llvm::IRBuilder<> &builder, const std::string &site_name, const std::string &target_name,
+                           llvm::Value *vtable);
+  /**
+   * Names a vtable in the receiver histograms.
+   */
+  void AddVTable(llvm::GlobalVariable *vtable, const std::string &class_name);
+
+  /**
+   * Sizes the counters and emits the descriptions of the counters and vtables. Nothing can be added afterwards;
+   * calling this again does nothing.
+   */
+  void Finalize();
+
+ private:
+  enum class RecordKind : int32_t { kMethodEntry = 0, kReceivers = 1 };
+  struct Record {
+    RecordKind kind;
+    int32_t offset;
+    std::string name, target;
+  };
+
+  llvm::Module *module_;
+  llvm::GlobalVariable *counters_;// Until Finalize, a placeholder for the array, which is only sized then.
+  int32_t counter_count_;
+  std::vector<Record> records_;
+  std::vector<std::pair<llvm::GlobalVariable *, std::string>> vtables_;
+  bool is_finalized_;
+
+  llvm::Constant *GetCounter(int32_t offset);
+  int32_t AddRecord(RecordKind kind, int32_t counter_count, std::string name, std::string target);
+  void EmitCounters();
+  void EmitVTableTable();
+};
+
+}// namespace magnetic
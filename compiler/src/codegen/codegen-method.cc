@@ -4,22 +4,49 @@
 
 #include "codegen-method.h"
 
+#include <map>
+
 #include <fmt/core.h>
 #include <llvm/IR/BasicBlock.h>
+#include <llvm/IR/DebugInfoMetadata.h>
 
+#include "call-profile.h"
+#include "class/class.h"
+#include "class/debug-attributes.h"
 #include "class/descriptor.h"
+#include "compilation-unit/compilation-unit.h"
+#include "debug-info.h"
 #include "environment.h"
 #include "instructions.h"
+#include "runtime-abi.h"
 #include "types/type.h"
 
 namespace magnetic {
 
 namespace {
 void EmitBasicBlocks(codegen::Environment &env) {
-  for (auto &it : env.cfg().blocks()) {
-    std::string block_name = "block" + std::to_string(it.first);
-    llvm::BasicBlock *block = llvm::BasicBlock::Create(*env.ctx()->llvm_ctx(), block_name, env.function());
-    it.second.set_llvm_block(block);
+  // Blocks are laid out in reverse postorder, which keeps loop bodies together and puts blocks after the blocks that
+  // jump to them. Unreachable blocks are never emitted.
+  for (BasicBlock *block : env.cfg().reverse_post_order()) {
+    std::string block_name = "block" + std::to_string(block->start());
+    block->set_llvm_block(llvm::BasicBlock::Create(*env.ctx()->llvm_ctx(), block_name, env.function()));
+  }
+}
+
+/**
+ * Polls at the end of every block that jumps back to a loop header, so that a thread running a loop reaches a
+ * safepoint on every iteration. Together with the poll at method entry, there is no path that runs indefinitely
+ * without polling.
+ */
+void EmitLoopSafepointPolls(codegen::Environment &env,
+                            const std::map<BasicBlock *, llvm::Instruction *> &terminators) {
+  if (!env.ctx()->emit_safepoint_polls()) return;
+
+  for (const auto &loop : env.cfg().loops()) {
+    for (BasicBlock *latch : loop->latches()) {
+      env.builder().SetInsertPoint(terminators.at(latch));
+      env.ctx()->runtime_abi()->EmitSafepointPoll(env.builder());
+    }
   }
 }
 
@@ -42,20 +69,85 @@ void EmitCopyAllParameters(codegen::Environment &env) {
   int32_t java_index = 0;
   int32_t llvm_index = 0;
   for (Type param_type : descriptor->instance_params()) { EmitCopyParameter(env, java_index, llvm_index, param_type); }
-  env.builder().CreateBr(env.cfg().entry_block().llvm_block());
 }
+
+/**
+ * Synchronized methods hold the monitor of "this" (or of the class, for static methods) while they run. The monitor is
+ * released before every return.
+ */
+void EmitSynchronizedMethodEntry(codegen::Environment &env) {
+  if (!env.method()->is_synchronized()) return;
+
+  const Monitor &monitor = env.clazz()->monitor();
+  llvm::Value *lock_word;
+  if (env.method()->is_static()) {
+    lock_word = monitor.GetClassLockWordInModule(env.module(), env.clazz()->name());
+  } else {
+    lock_word = monitor.EmitLockWordPointer(env.builder(), {env.function()->getArg(0), Type::kObject});
+  }
+  monitor.EmitEnter(env.builder(), lock_word);
+  env.set_method_lock_word(lock_word);
+}
+
+void EmitMethodEntryCount(codegen::Environment &env) {
+  CallProfileEmitter *call_profile = env.clazz()->compilation_unit()->call_profile();
+  if (call_profile == nullptr) return;
+  call_profile->EmitMethodEntry(env.builder(),
+                                env.clazz()->name() + "." + env.method()->name() + env.method()->raw_descriptor());
+}
+
+/**
+ * Gives each instruction the source line of the bytecode instruction that it was compiled from.
+ */
+class LineLocator {
+ public:
+  explicit LineLocator(codegen::Environment &env) : subprogram_(nullptr), line_numbers_(nullptr) {
+    DebugInfoEmitter *debug_info = env.clazz()->compilation_unit()->debug_info();
+    if (debug_info == nullptr) return;
+
+    const ClassDebugAttributes *attributes = env.clazz()->debug_attributes();
+    if (attributes != nullptr) {
+      this->line_numbers_ = attributes->FindLineNumbers(env.method()->name(), env.method()->raw_descriptor());
+    }
+    uint32_t first_line = (this->line_numbers_ != nullptr) ? this->line_numbers_->first_line() : 0;
+    this->subprogram_ = debug_info->EmitMethod(env.clazz(), env.method(), env.function(), first_line);
+    // The prologue (parameter copies, monitor entry, the entry safepoint poll) belongs to the method's first line.
+    env.builder().SetCurrentDebugLocation(
+        llvm::DILocation::get(env.function()->getContext(), first_line, 0, this->subprogram_));
+  }
+
+  void MoveTo(codegen::Environment &env, uint32_t pc) const {
+    if (this->subprogram_ == nullptr) return;
+    uint32_t line = (this->line_numbers_ != nullptr) ? this->line_numbers_->GetLine(pc) : 0;
+    env.builder().SetCurrentDebugLocation(
+        llvm::DILocation::get(env.function()->getContext(), line, 0, this->subprogram_));
+  }
+
+ private:
+  llvm::DISubprogram *subprogram_;     // nullptr if debug info isn't being emitted.
+  const LineNumberTable *line_numbers_;// Can be nullptr.
+};
 }// namespace
 
 void codegen::EmitMethod(ClassInfo *owner, MethodDeclaration *method, cjbp::Method *bytecode, llvm::Function *function,
                          llvm::Module *module) {
   Environment env(owner, method, bytecode, function, module);
+  LineLocator line_locator(env);
   EmitBasicBlocks(env);
   EmitCopyAllParameters(env);
-  for (const auto &it : env.cfg().blocks()) {
-    const BasicBlock &block = it.second;
+  EmitSynchronizedMethodEntry(env);
+  EmitMethodEntryCount(env);
+  if (env.ctx()->emit_safepoint_polls()) env.ctx()->runtime_abi()->EmitSafepointPoll(env.builder());
+  env.builder().CreateBr(env.cfg().entry_block().llvm_block());
+  std::map<BasicBlock *, llvm::Instruction *> terminators{};
+  for (BasicBlock *block_ptr : env.cfg().reverse_post_order()) {
+    const BasicBlock &block = *block_ptr;
     env.iterator().MoveTo(block.start());
     env.builder().SetInsertPoint(block.llvm_block());
-    while (env.iterator().position() < block.end()) { EmitInstruction(env); }
+    while (env.iterator().position() < block.end()) {
+      line_locator.MoveTo(env, env.iterator().position());
+      EmitInstruction(env);
+    }
 
     // It is possible for a basic block to not end with a jump instruction if it was split due to there being
     // an instruction that jumps there.
@@ -63,10 +155,15 @@ void codegen::EmitMethod(ClassInfo *owner, MethodDeclaration *method, cjbp::Meth
     // LLVM requires that all basic blocks end with a terminator (e.g. jump to another block, return from the
     // function, etc). This is kind of a hack, but we can just check if the basic block has a terminator and if
     // it doesn't, jump to the next basic block.
-    if (block.llvm_block()->getTerminator() == nullptr) {
+    //
+    // Some instructions (e.g. idiv's division by zero check) split the block, so check the block that is currently
+    // being emitted into rather than the block's first LLVM block.
+    if (env.builder().GetInsertBlock()->getTerminator() == nullptr) {
       env.builder().CreateBr(env.cfg().GetBlock(block.end()).llvm_block());
     }
+    terminators.emplace(block_ptr, env.builder().GetInsertBlock()->getTerminator());
   }
+  EmitLoopSafepointPolls(env, terminators);
 }
 
 }// namespace magnetic
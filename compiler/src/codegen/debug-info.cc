@@ -0,0 +1,122 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "debug-info.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include <llvm/BinaryFormat/Dwarf.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/Transforms/Utils/ModuleUtils.h>
+
+#include "class/class.h"
+#include "class/debug-attributes.h"
+#include "class/method.h"
+
+namespace magnetic {
+
+namespace {
+/**
+ * @return the path of the class's source file relative to the source root, e.g. "io/github/lunbun/Main.java"
+ */
+std::pair<std::string, std::string> GetSourcePath(ClassInfo *owner) {
+  const std::string &class_name = owner->name();
+  size_t package_end = class_name.rfind('.');
+  std::string directory = (package_end == std::string::npos) ? "" : class_name.substr(0, package_end);
+  std::replace(directory.begin(), directory.end(), '.', '/');
+
+  const ClassDebugAttributes *attributes = owner->debug_attributes();
+  if (attributes != nullptr && !attributes->source_file().empty()) return {attributes->source_file(), directory};
+
+  // Without a SourceFile attribute, guess the file from the outermost class's name, as javac names it.
+  std::string simple_name = (package_end == std::string::npos) ? class_name : class_name.substr(package_end + 1);
+  return {simple_name.substr(0, simple_name.find('$')) + ".java", directory};
+}
+}// namespace
+
+std::unique_ptr<DebugInfoEmitter> DebugInfoEmitter::Create(llvm::Module *module) {
+  return std::make_unique<DebugInfoEmitter>(module);
+}
+DebugInfoEmitter::DebugInfoEmitter(llvm::Module *module)
+    : module_(module), builder_(*module), files_(), methods_(), is_finalized_(false) {
+  this->module_->addModuleFlag(llvm::Module::Warning, "Debug Info Version", llvm::DEBUG_METADATA_VERSION);
+  this->module_->addModuleFlag(llvm::Module::Warning, "Dwarf Version", 4);
+
+  llvm::DIFile *unit_file = this->builder_.createFile(module->getName(), ".");
+  this->compile_unit_ =
+      this->builder_.createCompileUnit(llvm::dwarf::DW_LANG_Java, unit_file, "magnetic-vm", true, "", 0);
+  // Java types aren't described, so every method shares a type without parameters.
+  this->method_type_ = this->builder_.createSubroutineType(this->builder_.getOrCreateTypeArray({}));
+}
+
+llvm::DIFile *DebugInfoEmitter::GetFile(ClassInfo *owner) {
+  auto [file_name, directory] = GetSourcePath(owner);
+  std::string key = directory + "/" + file_name;
+  const auto &it = this->files_.find(key);
+  if (it != this->files_.end()) return it->second;
+
+  llvm::DIFile *file = this->builder_.createFile(file_name, directory);
+  this->files_.emplace(key, file);
+  return file;
+}
+
+llvm::DISubprogram *DebugInfoEmitter::EmitMethod(ClassInfo *owner, MethodDeclaration *method,
+                                                 llvm::Function *function, uint32_t line) {
+  assert(!this->is_finalized_);
+
+  llvm::DIFile *file = this->GetFile(owner);
+  std::string qualified_name = owner->name() + "." + method->name();
+  llvm::DISubprogram *subprogram = this->builder_.createFunction(
+      file, qualified_name, function->getName(), file, line, this->method_type_, line, llvm::DINode::FlagPrototyped,
+      llvm::DISubprogram::SPFlagDefinition | llvm::DISubprogram::SPFlagOptimized);
+  function->setSubprogram(subprogram);
+
+  // The descriptor tells overloads apart.
+  this->methods_.emplace_back(function, qualified_name + method->raw_descriptor());
+  return subprogram;
+}
+
+void DebugInfoEmitter::Finalize() {
+  if (this->is_finalized_) return;
+  this->is_finalized_ = true;
+  this->builder_.finalize();
+  this->EmitMethodTable();
+}
+
+void DebugInfoEmitter::EmitMethodTable() {
+  if (this->methods_.empty()) return;
+
+  llvm::LLVMContext &llvm_ctx = this->module_->getContext();
+  llvm::IRBuilder<> builder(llvm_ctx);
+  llvm::PointerType *ptr_type = llvm::PointerType::get(llvm_ctx, 0);
+  llvm::StructType *entry_type = llvm::StructType::get(llvm_ctx, {ptr_type, ptr_type});
+
+  // Each method gets its own entry in the section; the linker concatenates them, and the runtime finds the whole table
+  // through the __start_magnetic_methods and __stop_magnetic_methods symbols that it defines. Entries aren't marked
+  // constant, since the function pointers in them are relocated at load time in position-independent executables,
+  // which a read-only section can't be.
+  //
+  // An entry is associated with its method, which puts it in a section linked to the method's section (SHF_LINK_ORDER),
+  // so that the linker drops the entry when it garbage collects the method instead of the entry keeping the method
+  // alive. For the same reason, entries are only kept from the optimizer with llvm.compiler.used: llvm.used would
+  // also mark their sections as retained.
+  llvm::Align alignment(this->module_->getDataLayout().getPointerABIAlignment(0));
+  std::vector<llvm::GlobalValue *> entries{};
+  entries.reserve(this->methods_.size());
+  for (const auto &[function, name] : this->methods_) {
+    llvm::Constant *name_string = builder.CreateGlobalStringPtr(name, "", 0, this->module_);
+    auto *entry = new llvm::GlobalVariable(*this->module_, entry_type, false, llvm::GlobalValue::PrivateLinkage,
+                                           llvm::ConstantStruct::get(entry_type, {function, name_string}),
+                                           "magnetic.method");
+    entry->setSection("magnetic_methods");
+    entry->setAlignment(alignment);
+    entry->setMetadata(llvm::LLVMContext::MD_associated,
+                       llvm::MDNode::get(llvm_ctx, llvm::ValueAsMetadata::get(function)));
+    entries.push_back(entry);
+  }
+  llvm::appendToCompilerUsed(*this->module_, entries);
+}
+
+}// namespace magnetic
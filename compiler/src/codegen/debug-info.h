@@ -0,0 +1,67 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <llvm/IR/DIBuilder.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Module.h>
+
+namespace magnetic {
+
+class ClassInfo;
+class MethodDeclaration;
+
+/**
+ * Describes the Java methods of a module to debuggers and profilers.
+ *
+ * Every compiled method gets a DWARF subprogram named after the Java method (with the mangled symbol as its linkage
+ * name), and its instructions are given the source lines from the class file's LineNumberTable, so perf, gdb and
+ * llvm-symbolizer show Java frames and lines.
+ *
+ * The methods are also listed in the method table: an entry of {ptr function, ptr java name} per method in the
+ * "magnetic_methods" section, which the runtime uses to symbolize addresses itself (for perf maps and its own
+ * profilers) without parsing DWARF. Entries don't keep their methods from being garbage collected by the linker.
+ */
+class DebugInfoEmitter {
+ public:
+  static std::unique_ptr<DebugInfoEmitter> Create(llvm::Module *module);
+
+  explicit DebugInfoEmitter(llvm::Module *module);
+  DebugInfoEmitter(const DebugInfoEmitter &) = delete;
+  DebugInfoEmitter &operator=(const DebugInfoEmitter &) = delete;
+
+  /**
+   * Attaches a subprogram to the function that a Java method is compiled to, and adds it to the method table.
+   * @param line the line the method starts at, or 0 if it is unknown
+   */
+  llvm::DISubprogram *EmitMethod(ClassInfo *owner, MethodDeclaration *method, llvm::Function *function,
+                                 uint32_t line);
+
+  /**
+   * Finishes the debug info and emits the method table. Nothing can be added afterwards; calling this again does
+   * nothing.
+   */
+  void Finalize();
+
+ private:
+  llvm::Module *module_;
+  llvm::DIBuilder builder_;
+  llvm::DICompileUnit *compile_unit_;
+  llvm::DISubroutineType *method_type_;
+  std::unordered_map<std::string, llvm::DIFile *> files_;
+  std::vector<std::pair<llvm::Function *, std::string>> methods_;
+  bool is_finalized_;
+
+  llvm::DIFile *GetFile(ClassInfo *owner);
+  void EmitMethodTable();
+};
+
+}// namespace magnetic
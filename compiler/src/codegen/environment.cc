@@ -23,7 +23,7 @@ const Value &Stack::Top() const { return this->container_.back(); }
 Environment::Environment(ClassInfo *owner, MethodDeclaration *method, cjbp::Method *bytecode, llvm::Function *function,
                          llvm::Module *module)
     : module_(module), method_(method), stack_(), iterator_(nullptr), locals_(nullptr), cfg_(nullptr),
-      builder_(nullptr) {
+      builder_(nullptr), method_lock_word_(nullptr) {
   this->class_ = owner;
   this->function_ = function;
   this->builder_ = std::make_unique<llvm::IRBuilder<>>(*this->ctx()->llvm_ctx());
@@ -43,6 +43,11 @@ class Environment {
   [[nodiscard]] LocalVariables &locals() const { return *this->locals_; }
   [[nodiscard]] ControlFlowGraph &cfg() const { return *this->cfg_; }
   [[nodiscard]] llvm::IRBuilder<> &builder() const { return *this->builder_; }
+  /**
+   * @return the lock word of the monitor held for the whole method if it is synchronized, otherwise nullptr
+   */
+  [[nodiscard]] llvm::Value *method_lock_word() const { return this->method_lock_word_; }
+  void set_method_lock_word(llvm::Value *lock_word) { this->method_lock_word_ = lock_word; }
 
  private:
   ClassInfo *class_;
@@ -54,6 +59,7 @@ class Environment {
   std::unique_ptr<LocalVariables> locals_;
   std::unique_ptr<ControlFlowGraph> cfg_;
   std::unique_ptr<llvm::IRBuilder<>> builder_;
+  llvm::Value *method_lock_word_;
 };
 
 }
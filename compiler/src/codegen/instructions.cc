@@ -10,7 +10,9 @@
 #include <cjbp/cjbp.h>
 #include <fmt/core.h>
 #include <llvm/IR/Instructions.h>
+#include <llvm/IR/Intrinsics.h>
 
+#include "call-profile.h"
 #include "class/class.h"
 #include "class/descriptor.h"
 #include "class/field.h"
@@ -18,7 +20,9 @@
 #include "class/method.h"
 #include "compilation-unit/compilation-unit.h"
 #include "context/exception.h"
+#include "intrinsics.h"
 #include "runtime-abi.h"
+#include "types/pool/pool.h"
 #include "types/type.h"
 
 using namespace cjbp::Opcode;
@@ -26,6 +30,14 @@ using namespace cjbp::Opcode;
 namespace magnetic {
 
 namespace {
+/**
+ * Records that the code being emitted depends on another class, so that incremental builds recompile the method's
+ * class when that class changes.
+ */
+void RecordDependency(codegen::Environment &env, const std::string &class_name, DependencyKind kind) {
+  env.ctx()->RecordDependency(env.clazz()->name(), class_name, kind);
+}
+
 void EmitIConst(codegen::Environment &env, int32_t num) {
   llvm::Value *value = llvm::ConstantInt::get(env.ctx()->int32(), num);
   env.stack().Push({value, Type::kInt});
@@ -89,12 +101,132 @@ void EmitBinaryOp(codegen::Environment &env, llvm::Instruction::BinaryOps op, Ty
   env.stack().Push({env.builder().CreateBinOp(op, lhs.value, rhs.value, name), type});
 }
 
+void EmitNegate(codegen::Environment &env, Type type, const std::string &name) {
+  Value value = env.stack().Pop();
+  if (type == Type::kFloat || type == Type::kDouble) {
+    env.stack().Push({env.builder().CreateFNeg(value.value, name), type});
+  } else {
+    env.stack().Push({env.builder().CreateNeg(value.value, name), type});
+  }
+}
+
+void EmitShift(codegen::Environment &env, llvm::Instruction::BinaryOps op, Type type, const std::string &name) {
+  // Java only uses the low 5 (int) or 6 (long) bits of the shift distance, so it can never shift by the full width of
+  // the value (which would be poison in LLVM). The mask is free on x86 and AArch64, whose shift instructions mask the
+  // same way.
+  Value rhs = env.stack().Pop();
+  Value lhs = env.stack().Pop();
+  llvm::Type *llvm_type = type.llvm_type(env.ctx());
+  llvm::Value *distance = env.builder().CreateZExtOrTrunc(rhs.value, llvm_type);
+  distance = env.builder().CreateAnd(distance, llvm::ConstantInt::get(llvm_type, (type == Type::kLong) ? 63 : 31));
+  env.stack().Push({env.builder().CreateBinOp(op, lhs.value, distance, name), type});
+}
+
+/**
+ * Throws ArithmeticException if the divisor is zero. The rest of the instruction is emitted into a new block.
+ */
+void EmitDivisionByZeroCheck(codegen::Environment &env, llvm::Value *divisor) {
+  llvm::LLVMContext &llvm_ctx = *env.ctx()->llvm_ctx();
+  llvm::BasicBlock *throw_block = llvm::BasicBlock::Create(llvm_ctx, "division_by_zero", env.function());
+  llvm::BasicBlock *continue_block = llvm::BasicBlock::Create(llvm_ctx, "division", env.function());
+
+  llvm::Value *is_zero = env.builder().CreateICmpEQ(divisor, llvm::ConstantInt::get(divisor->getType(), 0), "is_zero");
+  // No branch weights needed: branch probability analysis already treats paths to cold, noreturn calls as unlikely.
+  env.builder().CreateCondBr(is_zero, throw_block, continue_block);
+
+  env.builder().SetInsertPoint(throw_block);
+  env.ctx()->runtime_abi()->EmitThrowDivisionByZero(env.builder());
+
+  env.builder().SetInsertPoint(continue_block);
+}
+void EmitIntegerDivision(codegen::Environment &env, bool is_remainder, Type type, const std::string &name) {
+  Value rhs = env.stack().Pop();
+  Value lhs = env.stack().Pop();
+  EmitDivisionByZeroCheck(env, rhs.value);
+
+  // MIN_VALUE / -1 overflows, which is undefined behavior in LLVM, but Java defines it as MIN_VALUE (and the remainder
+  // as 0). Since x / -1 == -x (with wrapping) and x % -1 == 0 for every x, dividing by 1 instead and fixing up the
+  // result with selects handles the case without a branch.
+  llvm::Type *llvm_type = type.llvm_type(env.ctx());
+  llvm::Value *is_minus_one = env.builder().CreateICmpEQ(rhs.value, llvm::ConstantInt::get(llvm_type, -1, true));
+  llvm::Value *divisor = env.builder().CreateSelect(is_minus_one, llvm::ConstantInt::get(llvm_type, 1), rhs.value);
+  llvm::Value *result;
+  if (is_remainder) {
+    llvm::Value *remainder = env.builder().CreateSRem(lhs.value, divisor);
+    result = env.builder().CreateSelect(is_minus_one, llvm::ConstantInt::get(llvm_type, 0), remainder, name);
+  } else {
+    llvm::Value *quotient = env.builder().CreateSDiv(lhs.value, divisor);
+    result = env.builder().CreateSelect(is_minus_one, env.builder().CreateNeg(lhs.value), quotient, name);
+  }
+  env.stack().Push({result, type});
+}
+
+void EmitIInc(codegen::Environment &env, uint16_t local_index, int16_t increment) {
+  const codegen::TypedLocal &local = env.locals().GetInt(local_index);
+  Value value = local.EmitLoad(env.ctx(), env.builder(), "iinc");
+  llvm::Value *constant = llvm::ConstantInt::get(env.ctx()->int32(), increment, true);
+  llvm::Value *result = env.builder().CreateAdd(value.value, constant);
+  local.EmitStore(env.builder(), {result, Type::kInt});
+}
+
+/**
+ * Produces -1, 0 or 1 without branching: (lhs > rhs) - (lhs < rhs).
+ */
+void EmitThreeWayComparison(codegen::Environment &env, llvm::Value *greater, llvm::Value *less,
+                            const std::string &name) {
+  llvm::Value *greater_int = env.builder().CreateZExt(greater, env.ctx()->int32());
+  llvm::Value *less_int = env.builder().CreateZExt(less, env.ctx()->int32());
+  env.stack().Push({env.builder().CreateSub(greater_int, less_int, name), Type::kInt});
+}
+void EmitLCmp(codegen::Environment &env) {
+  Value rhs = env.stack().Pop();
+  Value lhs = env.stack().Pop();
+  EmitThreeWayComparison(env, env.builder().CreateICmpSGT(lhs.value, rhs.value),
+                         env.builder().CreateICmpSLT(lhs.value, rhs.value), "lcmp");
+}
+/**
+ * fcmpl/dcmpl push -1 if either value is NaN, fcmpg/dcmpg push 1. Using an unordered comparison for the side that
+ * should win on NaN gives that result with the same branch-free sequence as lcmp.
+ */
+void EmitFloatingPointComparison(codegen::Environment &env, bool nan_is_greater, const std::string &name) {
+  Value rhs = env.stack().Pop();
+  Value lhs = env.stack().Pop();
+  llvm::Value *greater = nan_is_greater ? env.builder().CreateFCmpUGT(lhs.value, rhs.value)
+                                        : env.builder().CreateFCmpOGT(lhs.value, rhs.value);
+  llvm::Value *less = nan_is_greater ? env.builder().CreateFCmpOLT(lhs.value, rhs.value)
+                                     : env.builder().CreateFCmpULT(lhs.value, rhs.value);
+  EmitThreeWayComparison(env, greater, less, name);
+}
+
 void EmitScalarCast(codegen::Environment &env, llvm::Instruction::CastOps op, Type src, Type dest,
                     const std::string &name) {
   Value value = env.stack().Pop();
   env.stack().Push({env.builder().CreateCast(op, value.value, dest.llvm_type(env.ctx()), name), dest});
 }
 
+/**
+ * Truncates an int to a byte, char or short, then extends it back to an int (i2b, i2c and i2s).
+ */
+void EmitNarrowingCast(codegen::Environment &env, llvm::IntegerType *narrow_type, bool is_signed,
+                       const std::string &name) {
+  Value value = env.stack().Pop();
+  llvm::Value *narrow = env.builder().CreateTrunc(value.value, narrow_type);
+  llvm::Value *result = is_signed ? env.builder().CreateSExt(narrow, env.ctx()->int32(), name)
+                                  : env.builder().CreateZExt(narrow, env.ctx()->int32(), name);
+  env.stack().Push({result, Type::kInt});
+}
+/**
+ * Java defines float to integer conversions for every input: NaN becomes 0 and out of range values saturate, which is
+ * what llvm.fptosi.sat does (fptosi would be poison for those inputs).
+ */
+void EmitFloatToIntCast(codegen::Environment &env, Type dest, const std::string &name) {
+  Value value = env.stack().Pop();
+  llvm::Value *result = env.builder().CreateIntrinsic(llvm::Intrinsic::fptosi_sat,
+                                                      {dest.llvm_type(env.ctx()), value.value->getType()},
+                                                      {value.value}, nullptr, name);
+  env.stack().Push({result, dest});
+}
+
 void EmitICmpBranch(codegen::Environment &env, llvm::CmpInst::Predicate op, size_t inst_offset, llvm::Value *lhs,
                     llvm::Value *rhs, const std::string &name) {
   llvm::Value *condition = env.builder().CreateICmp(op, lhs, rhs, name);
@@ -120,18 +252,58 @@ void EmitGoto(codegen::Environment &env, size_t destination) {
   env.builder().CreateBr(block.llvm_block());
 }
 
+void EmitSynchronizedMethodExit(codegen::Environment &env) {
+  if (env.method_lock_word() == nullptr) return;
+  env.clazz()->monitor().EmitExit(env.builder(), env.method_lock_word());
+}
 void EmitReturn(codegen::Environment &env, Type type) {
   Value value = env.stack().Pop();
+  EmitSynchronizedMethodExit(env);
   env.builder().CreateRet(value.value);
 }
 void EmitObjectReturn(codegen::Environment &env) {
   Type return_type = env.method()->descriptor()->return_type();
-  env.builder().CreateRet(env.stack().Pop().value);
+  Value value = env.stack().Pop();
+  EmitSynchronizedMethodExit(env);
+  env.builder().CreateRet(value.value);
+}
+void EmitVoidReturn(codegen::Environment &env) {
+  EmitSynchronizedMethodExit(env);
+  env.builder().CreateRetVoid();
+}
+
+/**
+ * Throws NullPointerException if the object reference is null. The rest of the instruction is emitted into a new block.
+ */
+void EmitNullCheck(codegen::Environment &env, llvm::Value *object_ref) {
+  llvm::LLVMContext &llvm_ctx = *env.ctx()->llvm_ctx();
+  llvm::BasicBlock *throw_block = llvm::BasicBlock::Create(llvm_ctx, "null_pointer", env.function());
+  llvm::BasicBlock *continue_block = llvm::BasicBlock::Create(llvm_ctx, "not_null", env.function());
+
+  llvm::Value *is_null = env.builder().CreateIsNull(object_ref, "is_null");
+  env.builder().CreateCondBr(is_null, throw_block, continue_block);
+
+  env.builder().SetInsertPoint(throw_block);
+  env.ctx()->runtime_abi()->EmitThrowNullPointer(env.builder());
+
+  env.builder().SetInsertPoint(continue_block);
+}
+void EmitMonitorEnter(codegen::Environment &env) {
+  Value object_ref = env.stack().Pop();
+  EmitNullCheck(env, object_ref.value);
+  const Monitor &monitor = env.clazz()->monitor();
+  monitor.EmitEnter(env.builder(), monitor.EmitLockWordPointer(env.builder(), object_ref));
+}
+void EmitMonitorExit(codegen::Environment &env) {
+  Value object_ref = env.stack().Pop();
+  EmitNullCheck(env, object_ref.value);
+  const Monitor &monitor = env.clazz()->monitor();
+  monitor.EmitExit(env.builder(), monitor.EmitLockWordPointer(env.builder(), object_ref));
 }
-void EmitVoidReturn(codegen::Environment &env) { env.builder().CreateRetVoid(); }
 
 void EmitGetStatic(codegen::Environment &env, uint16_t pool_index) {
   const cjbp::ConstPool &pool = env.clazz()->bytecode()->const_pool();
+  RecordDependency(env, *pool.GetFieldRefClass(pool_index), DependencyKind::kSymbol);
   FieldDeclaration *target_field = env.ctx()->GetField(
       *pool.GetFieldRefClass(pool_index), *pool.GetFieldRefName(pool_index), *pool.GetFieldRefType(pool_index), true);
   Value field_value = target_field->EmitLoad(env.builder(), std::nullopt, "getstatic");
@@ -140,6 +312,7 @@ void EmitGetStatic(codegen::Environment &env, uint16_t pool_index) {
 
 void EmitPutStatic(codegen::Environment &env, uint16_t pool_index) {
   const cjbp::ConstPool &pool = env.clazz()->bytecode()->const_pool();
+  RecordDependency(env, *pool.GetFieldRefClass(pool_index), DependencyKind::kSymbol);
   FieldDeclaration *target_field = env.ctx()->GetField(
       *pool.GetFieldRefClass(pool_index), *pool.GetFieldRefName(pool_index), *pool.GetFieldRefType(pool_index), true);
   Value field_value = env.stack().Pop();
@@ -148,6 +321,7 @@ void EmitPutStatic(codegen::Environment &env, uint16_t pool_index) {
 
 void EmitGetField(codegen::Environment &env, uint16_t pool_index) {
   const cjbp::ConstPool &pool = env.clazz()->bytecode()->const_pool();
+  RecordDependency(env, *pool.GetFieldRefClass(pool_index), DependencyKind::kLayout);
   FieldDeclaration *target_field = env.ctx()->GetField(
       *pool.GetFieldRefClass(pool_index), *pool.GetFieldRefName(pool_index), *pool.GetFieldRefType(pool_index), true);
 
@@ -160,6 +334,7 @@ void EmitGetField(codegen::Environment &env, uint16_t pool_index) {
 
 void EmitPutField(codegen::Environment &env, uint16_t pool_index) {
   const cjbp::ConstPool &pool = env.clazz()->bytecode()->const_pool();
+  RecordDependency(env, *pool.GetFieldRefClass(pool_index), DependencyKind::kLayout);
   FieldDeclaration *target_field = env.ctx()->GetField(
       *pool.GetFieldRefClass(pool_index), *pool.GetFieldRefName(pool_index), *pool.GetFieldRefType(pool_index), true);
 
@@ -200,24 +375,46 @@ void CreateNonVirtualInstanceInvoke(codegen::Environment &env, MethodDeclaration
   // TODO: null check
   CreateCallAndMaybePushResultOntoStack(env, target_method, object_ref, params, name);
 }
-void CreateVirtualInstanceInvoke(codegen::Environment &env, MethodDeclaration *target_method, const std::string &name) {
+
+/**
+ * Records the class of the receiver of a virtual call in the call site's receiver histogram, when calls are being
+ * counted.
+ */
+void EmitReceiverProfile(codegen::Environment &env, MethodDeclaration *target_method, Value object_ref, size_t index) {
+  CallProfileEmitter *call_profile = env.clazz()->compilation_unit()->call_profile();
+  if (call_profile == nullptr) return;
+
+  ClassInfo *target_class = env.ctx()->pool()->Get(target_method->class_name());
+  if (target_class == nullptr) throw BadBytecode("could not find class " + target_method->class_name());
+  llvm::Value *vtable = target_class->vtable().EmitLoadVTablePointer(env.builder(), object_ref);
+  std::string site_name = fmt::format("{}.{}{}@{}", env.clazz()->name(), env.method()->name(),
+                                      env.method()->raw_descriptor(), index);
+  std::string target_name = target_method->class_name() + "." + target_method->name() + target_method->raw_descriptor();
+  call_profile->EmitReceiverProfile(env.builder(), site_name, target_name, vtable);
+}
+
+void CreateVirtualInstanceInvoke(codegen::Environment &env, MethodDeclaration *target_method, size_t index,
+                                 const std::string &name) {
   std::vector<Value> params = PopAllMethodParams(env, target_method->descriptor());
   // TODO: cast to java.lang.Object
   Value object_ref = env.stack().Pop();
   // TODO: null check
+  EmitReceiverProfile(env, target_method, object_ref, index);
   Value call_result = target_method->EmitVirtualCall(env.builder(), object_ref, params, "");
   MaybePushCallResultOntoStack(env, call_result, name);
 }
 
-void EmitInvokeVirtualInst(codegen::Environment &env, uint16_t pool_index) {
+void EmitInvokeVirtualInst(codegen::Environment &env, size_t index, uint16_t pool_index) {
   const cjbp::ConstPool &pool = env.clazz()->bytecode()->const_pool();
   MethodDeclaration *target_method =
       env.ctx()->GetMethod(*pool.GetMethodRefClass(pool_index), *pool.GetMethodRefName(pool_index),
                            *pool.GetMethodRefType(pool_index), false);
   if (!target_method->CanBeOverridden()) {
+    RecordDependency(env, target_method->class_name(), DependencyKind::kSymbol);
     CreateNonVirtualInstanceInvoke(env, target_method, "invokevirtual");
   } else {
-    CreateVirtualInstanceInvoke(env, target_method, "invokevirtual");
+    RecordDependency(env, target_method->class_name(), DependencyKind::kVTable);
+    CreateVirtualInstanceInvoke(env, target_method, index, "invokevirtual");
   }
 }
 
@@ -226,23 +423,47 @@ void EmitInvokeSpecialInst(codegen::Environment &env, uint16_t pool_index) {
   MethodDeclaration *target_method =
       env.ctx()->GetMethod(*pool.GetMethodRefClass(pool_index), *pool.GetMethodRefName(pool_index),
                            *pool.GetMethodRefType(pool_index), false);
+  RecordDependency(env, target_method->class_name(), DependencyKind::kSymbol);
   CreateNonVirtualInstanceInvoke(env, target_method, "invokespecial");
 }
 
+const IntrinsicEmitter *FindIntrinsic(codegen::Environment &env, MethodDeclaration *target_method) {
+  if (env.ctx()->intrinsics() == nullptr) return nullptr;
+  return env.ctx()->intrinsics()->Find(target_method->class_name(), target_method->name(),
+                                       target_method->raw_descriptor());
+}
+void EmitIntrinsic(codegen::Environment &env, const IntrinsicEmitter &intrinsic, MethodDeclaration *target_method,
+                   const std::vector<Value> &params, const std::string &name) {
+  std::vector<llvm::Value *> args{};
+  args.reserve(params.size());
+  for (const Value &param : params) { args.push_back(param.value); }
+  llvm::Value *result = intrinsic(env.builder(), args);
+  MaybePushCallResultOntoStack(env, {result, target_method->descriptor()->return_type()}, name);
+}
+
 void EmitInvokeStaticInst(codegen::Environment &env, uint16_t pool_index) {
   const cjbp::ConstPool &pool = env.clazz()->bytecode()->const_pool();
   MethodDeclaration *target_method =
       env.ctx()->GetMethod(*pool.GetMethodRefClass(pool_index), *pool.GetMethodRefName(pool_index),
                            *pool.GetMethodRefType(pool_index), true);
+  RecordDependency(env, target_method->class_name(), DependencyKind::kSymbol);
 
   std::vector<Value> params = PopAllMethodParams(env, target_method->descriptor());
-  CreateCallAndMaybePushResultOntoStack(env, target_method, std::nullopt, params, "invokestatic");
+  const IntrinsicEmitter *intrinsic = FindIntrinsic(env, target_method);
+  if (intrinsic != nullptr) {
+    EmitIntrinsic(env, *intrinsic, target_method, params, "invokestatic");
+  } else {
+    CreateCallAndMaybePushResultOntoStack(env, target_method, std::nullopt, params, "invokestatic");
+  }
 }
 
-void EmitNew(codegen::Environment &env, uint16_t pool_index) {
+void EmitNew(codegen::Environment &env, size_t index, uint16_t pool_index) {
   const cjbp::ConstPool &pool = env.clazz()->bytecode()->const_pool();
+  RecordDependency(env, *pool.GetClassName(pool_index), DependencyKind::kSymbol);
   ClassInstantiator *instantiator = env.ctx()->GetInstantiator(*pool.GetClassName(pool_index));
-  Value instance = instantiator->EmitInstantiation(env.builder(), "new");
+  std::string site_name = fmt::format("{}.{}{}@{}", env.clazz()->name(), env.method()->name(),
+                                      env.method()->raw_descriptor(), index);
+  Value instance = instantiator->EmitInstantiation(env.builder(), site_name, "new");
   env.stack().Push(instance);
 }
 }// namespace
@@ -318,7 +539,45 @@ void codegen::EmitInstruction(codegen::Environment &env) {
     case Opcode::kDup: EmitDup(env); break;
 
     case Opcode::kIAdd: EmitBinaryOp(env, llvm::Instruction::BinaryOps::Add, Type::kInt, "iadd"); break;
+    case Opcode::kLAdd: EmitBinaryOp(env, llvm::Instruction::BinaryOps::Add, Type::kLong, "ladd"); break;
+    case Opcode::kFAdd: EmitBinaryOp(env, llvm::Instruction::BinaryOps::FAdd, Type::kFloat, "fadd"); break;
+    case Opcode::kDAdd: EmitBinaryOp(env, llvm::Instruction::BinaryOps::FAdd, Type::kDouble, "dadd"); break;
+    case Opcode::kISub: EmitBinaryOp(env, llvm::Instruction::BinaryOps::Sub, Type::kInt, "isub"); break;
+    case Opcode::kLSub: EmitBinaryOp(env, llvm::Instruction::BinaryOps::Sub, Type::kLong, "lsub"); break;
+    case Opcode::kFSub: EmitBinaryOp(env, llvm::Instruction::BinaryOps::FSub, Type::kFloat, "fsub"); break;
+    case Opcode::kDSub: EmitBinaryOp(env, llvm::Instruction::BinaryOps::FSub, Type::kDouble, "dsub"); break;
     case Opcode::kIMul: EmitBinaryOp(env, llvm::Instruction::BinaryOps::Mul, Type::kInt, "imul"); break;
+    case Opcode::kLMul: EmitBinaryOp(env, llvm::Instruction::BinaryOps::Mul, Type::kLong, "lmul"); break;
+    case Opcode::kFMul: EmitBinaryOp(env, llvm::Instruction::BinaryOps::FMul, Type::kFloat, "fmul"); break;
+    case Opcode::kDMul: EmitBinaryOp(env, llvm::Instruction::BinaryOps::FMul, Type::kDouble, "dmul"); break;
+    case Opcode::kIDiv: EmitIntegerDivision(env, false, Type::kInt, "idiv"); break;
+    case Opcode::kLDiv: EmitIntegerDivision(env, false, Type::kLong, "ldiv"); break;
+    case Opcode::kFDiv: EmitBinaryOp(env, llvm::Instruction::BinaryOps::FDiv, Type::kFloat, "fdiv"); break;
+    case Opcode::kDDiv: EmitBinaryOp(env, llvm::Instruction::BinaryOps::FDiv, Type::kDouble, "ddiv"); break;
+    case Opcode::kIRem: EmitIntegerDivision(env, true, Type::kInt, "irem"); break;
+    case Opcode::kLRem: EmitIntegerDivision(env, true, Type::kLong, "lrem"); break;
+    // Java's floating point remainder truncates like C's fmod (it is not IEEE 754 remainder), which is what frem does.
+    case Opcode::kFRem: EmitBinaryOp(env, llvm::Instruction::BinaryOps::FRem, Type::kFloat, "frem"); break;
+    case Opcode::kDRem: EmitBinaryOp(env, llvm::Instruction::BinaryOps::FRem, Type::kDouble, "drem"); break;
+    case Opcode::kINeg: EmitNegate(env, Type::kInt, "ineg"); break;
+    case Opcode::kLNeg: EmitNegate(env, Type::kLong, "lneg"); break;
+    case Opcode::kFNeg: EmitNegate(env, Type::kFloat, "fneg"); break;
+    case Opcode::kDNeg: EmitNegate(env, Type::kDouble, "dneg"); break;
+    case Opcode::kIShl: EmitShift(env, llvm::Instruction::BinaryOps::Shl, Type::kInt, "ishl"); break;
+    case Opcode::kLShl: EmitShift(env, llvm::Instruction::BinaryOps::Shl, Type::kLong, "lshl"); break;
+    case Opcode::kIShr: EmitShift(env, llvm::Instruction::BinaryOps::AShr, Type::kInt, "ishr"); break;
+    case Opcode::kLShr: EmitShift(env, llvm::Instruction::BinaryOps::AShr, Type::kLong, "lshr"); break;
+    case Opcode::kIUShr: EmitShift(env, llvm::Instruction::BinaryOps::LShr, Type::kInt, "iushr"); break;
+    case Opcode::kLUShr: EmitShift(env, llvm::Instruction::BinaryOps::LShr, Type::kLong, "lushr"); break;
+    case Opcode::kIAnd: EmitBinaryOp(env, llvm::Instruction::BinaryOps::And, Type::kInt, "iand"); break;
+    case Opcode::kLAnd: EmitBinaryOp(env, llvm::Instruction::BinaryOps::And, Type::kLong, "land"); break;
+    case Opcode::kIOr: EmitBinaryOp(env, llvm::Instruction::BinaryOps::Or, Type::kInt, "ior"); break;
+    case Opcode::kLOr: EmitBinaryOp(env, llvm::Instruction::BinaryOps::Or, Type::kLong, "lor"); break;
+    case Opcode::kIXor: EmitBinaryOp(env, llvm::Instruction::BinaryOps::Xor, Type::kInt, "ixor"); break;
+    case Opcode::kLXor: EmitBinaryOp(env, llvm::Instruction::BinaryOps::Xor, Type::kLong, "lxor"); break;
+    case Opcode::kIInc:
+      EmitIInc(env, env.iterator().ReadUInt8(index + 1), env.iterator().ReadInt8(index + 2));
+      break;
 
     case Opcode::kI2L: EmitScalarCast(env, llvm::Instruction::CastOps::SExt, Type::kInt, Type::kLong, "i2l"); break;
     case Opcode::kI2F: EmitScalarCast(env, llvm::Instruction::CastOps::SIToFP, Type::kInt, Type::kFloat, "i2f"); break;
@@ -328,18 +587,25 @@ void codegen::EmitInstruction(codegen::Environment &env) {
     case Opcode::kL2D:
       EmitScalarCast(env, llvm::Instruction::CastOps::SIToFP, Type::kLong, Type::kDouble, "l2d");
       break;
-    case Opcode::kF2I: EmitScalarCast(env, llvm::Instruction::CastOps::FPToSI, Type::kFloat, Type::kInt, "f2i"); break;
-    case Opcode::kF2L: EmitScalarCast(env, llvm::Instruction::CastOps::FPToSI, Type::kFloat, Type::kLong, "f2l"); break;
+    case Opcode::kF2I: EmitFloatToIntCast(env, Type::kInt, "f2i"); break;
+    case Opcode::kF2L: EmitFloatToIntCast(env, Type::kLong, "f2l"); break;
     case Opcode::kF2D:
       EmitScalarCast(env, llvm::Instruction::CastOps::FPExt, Type::kFloat, Type::kDouble, "f2d");
       break;
-    case Opcode::kD2I: EmitScalarCast(env, llvm::Instruction::CastOps::FPToSI, Type::kDouble, Type::kInt, "d2i"); break;
-    case Opcode::kD2L:
-      EmitScalarCast(env, llvm::Instruction::CastOps::FPToSI, Type::kDouble, Type::kLong, "d2l");
-      break;
+    case Opcode::kD2I: EmitFloatToIntCast(env, Type::kInt, "d2i"); break;
+    case Opcode::kD2L: EmitFloatToIntCast(env, Type::kLong, "d2l"); break;
     case Opcode::kD2F:
       EmitScalarCast(env, llvm::Instruction::CastOps::FPTrunc, Type::kDouble, Type::kFloat, "d2f");
       break;
+    case Opcode::kI2B: EmitNarrowingCast(env, env.ctx()->int8(), true, "i2b"); break;
+    case Opcode::kI2C: EmitNarrowingCast(env, env.ctx()->int16(), false, "i2c"); break;
+    case Opcode::kI2S: EmitNarrowingCast(env, env.ctx()->int16(), true, "i2s"); break;
+
+    case Opcode::kLCmp: EmitLCmp(env); break;
+    case Opcode::kFCmpL: EmitFloatingPointComparison(env, false, "fcmpl"); break;
+    case Opcode::kFCmpG: EmitFloatingPointComparison(env, true, "fcmpg"); break;
+    case Opcode::kDCmpL: EmitFloatingPointComparison(env, false, "dcmpl"); break;
+    case Opcode::kDCmpG: EmitFloatingPointComparison(env, true, "dcmpg"); break;
 
     case Opcode::kIfEq: EmitZeroComparisonBranch(env, llvm::CmpInst::ICMP_EQ, index, "ifeq"); break;
     case Opcode::kIfNe: EmitZeroComparisonBranch(env, llvm::CmpInst::ICMP_NE, index, "ifne"); break;
@@ -368,10 +634,13 @@ void codegen::EmitInstruction(codegen::Environment &env) {
     case Opcode::kPutStatic: EmitPutStatic(env, env.iterator().ReadUInt16(index + 1)); break;
     case Opcode::kGetField: EmitGetField(env, env.iterator().ReadUInt16(index + 1)); break;
     case Opcode::kPutField: EmitPutField(env, env.iterator().ReadUInt16(index + 1)); break;
-    case Opcode::kInvokeVirtual: EmitInvokeVirtualInst(env, env.iterator().ReadUInt16(index + 1)); break;
+    case Opcode::kInvokeVirtual: EmitInvokeVirtualInst(env, index, env.iterator().ReadUInt16(index + 1)); break;
     case Opcode::kInvokeSpecial: EmitInvokeSpecialInst(env, env.iterator().ReadUInt16(index + 1)); break;
     case Opcode::kInvokeStatic: EmitInvokeStaticInst(env, env.iterator().ReadUInt16(index + 1)); break;
-    case Opcode::kNew: EmitNew(env, env.iterator().ReadUInt16(index + 1)); break;
+    case Opcode::kNew: EmitNew(env, index, env.iterator().ReadUInt16(index + 1)); break;
+
+    case Opcode::kMonitorEnter: EmitMonitorEnter(env); break;
+    case Opcode::kMonitorExit: EmitMonitorExit(env); break;
 
     default: throw BadBytecode(fmt::format("unknown opcode {:#04x}", opcode));
   }
@@ -0,0 +1,144 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "intrinsics.h"
+
+#include <llvm/IR/Intrinsics.h>
+
+namespace magnetic {
+
+void IntrinsicRegistry::Register(std::string class_name, std::string name, std::string descriptor,
+                                 IntrinsicEmitter emitter) {
+  this->intrinsics_.insert_or_assign(std::make_tuple(std::move(class_name), std::move(name), std::move(descriptor)),
+                                     std::move(emitter));
+}
+const IntrinsicEmitter *IntrinsicRegistry::Find(const std::string &class_name, const std::string &name,
+                                                const std::string &descriptor) const {
+  const auto &it = this->intrinsics_.find(std::make_tuple(class_name, name, descriptor));
+  if (it == this->intrinsics_.end()) return nullptr;
+  return &it->second;
+}
+
+namespace {
+IntrinsicEmitter CreateUnaryIntrinsic(llvm::Intrinsic::ID id) {
+  return [id](llvm::IRBuilder<> &builder, const std::vector<llvm::Value *> &args) {
+    return builder.CreateUnaryIntrinsic(id, args[0]);
+  };
+}
+IntrinsicEmitter CreateBinaryIntrinsic(llvm::Intrinsic::ID id) {
+  return [id](llvm::IRBuilder<> &builder, const std::vector<llvm::Value *> &args) {
+    return builder.CreateBinaryIntrinsic(id, args[0], args[1]);
+  };
+}
+/**
+ * For intrinsics that take a flag saying whether an edge case input (INT_MIN for abs, zero for ctlz/cttz) is poison.
+ * Java defines a result for all of these, so the flag is always false.
+ */
+IntrinsicEmitter CreateIntrinsicWithoutPoison(llvm::Intrinsic::ID id) {
+  return [id](llvm::IRBuilder<> &builder, const std::vector<llvm::Value *> &args) {
+    return builder.CreateIntrinsic(id, {args[0]->getType()}, {args[0], builder.getFalse()});
+  };
+}
+/**
+ * Java's floating point min/max return NaN if either operand is NaN, and order -0.0 before 0.0. llvm.minimum and
+ * llvm.maximum have those semantics too, but LLVM 14 can't select them on x86-64, so they are built from compares and
+ * selects instead.
+ */
+IntrinsicEmitter CreateFloatMinMax(bool is_max) {
+  return [is_max](llvm::IRBuilder<> &builder, const std::vector<llvm::Value *> &args) {
+    llvm::Value *lhs = args[0];
+    llvm::Value *rhs = args[1];
+    // Equal operands only differ if they are 0.0 and -0.0, which differ only in the sign bit: or-ing the bits picks
+    // -0.0 for min, and and-ing them picks 0.0 for max.
+    llvm::Type *bits_type = builder.getIntNTy(lhs->getType()->getPrimitiveSizeInBits());
+    llvm::Value *lhs_bits = builder.CreateBitCast(lhs, bits_type);
+    llvm::Value *rhs_bits = builder.CreateBitCast(rhs, bits_type);
+    llvm::Value *tie = builder.CreateBitCast(
+        is_max ? builder.CreateAnd(lhs_bits, rhs_bits) : builder.CreateOr(lhs_bits, rhs_bits), lhs->getType());
+
+    llvm::Value *is_lhs = is_max ? builder.CreateFCmpOGT(lhs, rhs) : builder.CreateFCmpOLT(lhs, rhs);
+    llvm::Value *is_rhs = is_max ? builder.CreateFCmpOLT(lhs, rhs) : builder.CreateFCmpOGT(lhs, rhs);
+    llvm::Value *ordered = builder.CreateSelect(is_lhs, lhs, builder.CreateSelect(is_rhs, rhs, tie));
+    // The NaN operand is returned, lhs if both are NaN.
+    llvm::Value *nan = builder.CreateSelect(builder.CreateFCmpUNO(lhs, lhs), lhs, rhs);
+    return builder.CreateSelect(builder.CreateFCmpUNO(lhs, rhs), nan, ordered);
+  };
+}
+/**
+ * Long.bitCount and friends count bits in a long, but return an int.
+ */
+IntrinsicEmitter TruncateToInt(IntrinsicEmitter emitter) {
+  return [emitter = std::move(emitter)](llvm::IRBuilder<> &builder, const std::vector<llvm::Value *> &args) {
+    return builder.CreateTrunc(emitter(builder, args), builder.getInt32Ty());
+  };
+}
+
+void RegisterMathIntrinsics(IntrinsicRegistry &registry, const std::string &class_name) {
+  registry.Register(class_name, "sqrt", "(D)D", CreateUnaryIntrinsic(llvm::Intrinsic::sqrt));
+  registry.Register(class_name, "floor", "(D)D", CreateUnaryIntrinsic(llvm::Intrinsic::floor));
+  registry.Register(class_name, "ceil", "(D)D", CreateUnaryIntrinsic(llvm::Intrinsic::ceil));
+  registry.Register(class_name, "abs", "(I)I", CreateIntrinsicWithoutPoison(llvm::Intrinsic::abs));
+  registry.Register(class_name, "abs", "(J)J", CreateIntrinsicWithoutPoison(llvm::Intrinsic::abs));
+  registry.Register(class_name, "abs", "(F)F", CreateUnaryIntrinsic(llvm::Intrinsic::fabs));
+  registry.Register(class_name, "abs", "(D)D", CreateUnaryIntrinsic(llvm::Intrinsic::fabs));
+  registry.Register(class_name, "min", "(II)I", CreateBinaryIntrinsic(llvm::Intrinsic::smin));
+  registry.Register(class_name, "min", "(JJ)J", CreateBinaryIntrinsic(llvm::Intrinsic::smin));
+  registry.Register(class_name, "min", "(FF)F", CreateFloatMinMax(false));
+  registry.Register(class_name, "min", "(DD)D", CreateFloatMinMax(false));
+  registry.Register(class_name, "max", "(II)I", CreateBinaryIntrinsic(llvm::Intrinsic::smax));
+  registry.Register(class_name, "max", "(JJ)J", CreateBinaryIntrinsic(llvm::Intrinsic::smax));
+  registry.Register(class_name, "max", "(FF)F", CreateFloatMinMax(true));
+  registry.Register(class_name, "max", "(DD)D", CreateFloatMinMax(true));
+}
+
+void RegisterBitIntrinsics(IntrinsicRegistry &registry, const std::string &class_name, const std::string &type) {
+  // Integer methods return the same type as their argument (int), Long methods return an int.
+  bool is_long = (type == "J");
+  auto wrap = [is_long](IntrinsicEmitter emitter) { return is_long ? TruncateToInt(std::move(emitter)) : emitter; };
+  std::string descriptor = "(" + type + ")I";
+  registry.Register(class_name, "bitCount", descriptor, wrap(CreateUnaryIntrinsic(llvm::Intrinsic::ctpop)));
+  registry.Register(class_name, "numberOfLeadingZeros", descriptor,
+                    wrap(CreateIntrinsicWithoutPoison(llvm::Intrinsic::ctlz)));
+  registry.Register(class_name, "numberOfTrailingZeros", descriptor,
+                    wrap(CreateIntrinsicWithoutPoison(llvm::Intrinsic::cttz)));
+  registry.Register(class_name, "reverseBytes", "(" + type + ")" + type, CreateUnaryIntrinsic(llvm::Intrinsic::bswap));
+}
+
+/**
+ * Calls a runtime function with the same arguments as the method.
+ */
+IntrinsicEmitter CreateRuntimeCall(std::string function_name) {
+  return [function_name = std::move(function_name)](llvm::IRBuilder<> &builder,
+                                                    const std::vector<llvm::Value *> &args) -> llvm::Value * {
+    std::vector<llvm::Type *> param_types{};
+    param_types.reserve(args.size());
+    for (llvm::Value *arg : args) { param_types.push_back(arg->getType()); }
+    llvm::FunctionType *function_type = llvm::FunctionType::get(builder.getVoidTy(), param_types, false);
+    llvm::FunctionCallee function =
+        builder.GetInsertBlock()->getModule()->getOrInsertFunction(function_name, function_type);
+    builder.CreateCall(function, args);
+    return nullptr;
+  };
+}
+
+void RegisterThreadIntrinsics(IntrinsicRegistry &registry) {
+  // Java threads are native threads. start() runs the thread object's run() on a new thread (see the runtime's
+  // thread.h), which replaces the JDK's bookkeeping in Java plus the native start0().
+  registry.Register("java.lang.Thread", "start", "()V", CreateRuntimeCall("Magnetic_rt_thread_start"));
+  registry.Register("java.lang.Thread", "join", "()V", CreateRuntimeCall("Magnetic_rt_thread_join"));
+}
+}// namespace
+
+std::unique_ptr<IntrinsicRegistry> IntrinsicRegistry::CreateDefaultRegistry() {
+  auto registry = std::make_unique<IntrinsicRegistry>();
+  RegisterMathIntrinsics(*registry, "java.lang.Math");
+  // StrictMath only differs from Math in the transcendental functions, which aren't intrinsified.
+  RegisterMathIntrinsics(*registry, "java.lang.StrictMath");
+  RegisterBitIntrinsics(*registry, "java.lang.Integer", "I");
+  RegisterBitIntrinsics(*registry, "java.lang.Long", "J");
+  RegisterThreadIntrinsics(*registry);
+  return registry;
+}
+
+}// namespace magnetic
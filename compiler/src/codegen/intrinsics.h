@@ -0,0 +1,61 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Value.h>
+
+namespace magnetic {
+
+/**
+ * Emits IR that replaces a call to a library method.
+ *
+ * The arguments are passed in declaration order (including the receiver for instance methods).
+ * @return the result of the call, or nullptr if the method returns void
+ */
+using IntrinsicEmitter =
+    std::function<llvm::Value *(llvm::IRBuilder<> &builder, const std::vector<llvm::Value *> &args)>;
+
+/**
+ * Library methods that are compiled to inline IR instead of a call, keyed on (class, name, descriptor).
+ *
+ * The JDK implements most of these in Java or as natives, which either costs a call per use or hides the operation
+ * from LLVM; as LLVM intrinsics they can be constant folded, vectorized and lowered to single instructions.
+ *
+ * The intrinsic also replaces the body of the method itself, which is how library methods that need the runtime (such
+ * as Thread.start) are implemented.
+ */
+class IntrinsicRegistry {
+ public:
+  /**
+   * Creates a registry with the java.lang.Math, java.lang.StrictMath, java.lang.Integer, java.lang.Long and
+   * java.lang.Thread intrinsics.
+   */
+  static std::unique_ptr<IntrinsicRegistry> CreateDefaultRegistry();
+
+  IntrinsicRegistry() = default;
+  IntrinsicRegistry(const IntrinsicRegistry &) = delete;
+  IntrinsicRegistry &operator=(const IntrinsicRegistry &) = delete;
+
+  void Register(std::string class_name, std::string name, std::string descriptor, IntrinsicEmitter emitter);
+
+  /**
+   * @return the intrinsic for the method, or nullptr if the method has to be called normally
+   */
+  [[nodiscard]] const IntrinsicEmitter *Find(const std::string &class_name, const std::string &name,
+                                             const std::string &descriptor) const;
+
+ private:
+  std::map<std::tuple<std::string, std::string, std::string>, IntrinsicEmitter> intrinsics_;
+};
+
+}// namespace magnetic
@@ -7,8 +7,11 @@
 #include <functional>
 #include <map>
 
+#include <llvm/IR/MDBuilder.h>
+
 #include "class/mangle.h"
 #include "context/context.h"
+#include "optimize/safepoint-elimination.h"
 
 namespace magnetic {
 
@@ -27,9 +30,98 @@ class DefaultRuntimeABI : public RuntimeABI {
     return {string_literal, Type::kObject};
   }
 
+  void EmitThrowDivisionByZero(llvm::IRBuilder<> &builder) override {
+    static constexpr const char *kThrowDivisionByZeroName = "Magnetic_rt_throw_division_by_zero";
+    this->EmitThrow(builder, kThrowDivisionByZeroName);
+  }
+  void EmitThrowNullPointer(llvm::IRBuilder<> &builder) override {
+    static constexpr const char *kThrowNullPointerName = "Magnetic_rt_throw_null_pointer";
+    this->EmitThrow(builder, kThrowNullPointerName);
+  }
+  void EmitUnreachableMethod(llvm::IRBuilder<> &builder, const std::string &method_name) override {
+    static constexpr const char *kUnreachableMethodName = "Magnetic_rt_unreachable_method";
+    llvm::Module *module = builder.GetInsertBlock()->getModule();
+    llvm::Value *name_string = builder.CreateGlobalStringPtr(method_name, "method_name", 0, module);
+    this->EmitThrow(builder, kUnreachableMethodName, {name_string});
+  }
+
+  void EmitSafepointPoll(llvm::IRBuilder<> &builder) override {
+    static constexpr const char *kSafepointPageName = "Magnetic_rt_safepoint_page";
+
+    // The runtime protects the page to request a safepoint, and parks the thread in its fault handler. The load is
+    // volatile so that it is neither removed nor hoisted out of loops.
+    llvm::Module *module = builder.GetInsertBlock()->getModule();
+    llvm::Constant *page = module->getOrInsertGlobal(kSafepointPageName, this->ctx()->int8());
+    llvm::LoadInst *poll = builder.CreateLoad(this->ctx()->int8(), page, true, "safepoint_poll");
+    poll->setMetadata(kSafepointPollMetadata, llvm::MDNode::get(*this->ctx()->llvm_ctx(), llvm::None));
+  }
+
+  void EmitAllocationSample(llvm::IRBuilder<> &builder, const std::string &class_name, uint64_t size,
+                            llvm::Value *site_name) override {
+    static constexpr const char *kAllocationBudgetName = "Magnetic_rt_allocation_budget";
+    static constexpr const char *kSampleAllocationName = "Magnetic_rt_sample_allocation";
+
+    llvm::LLVMContext &llvm_ctx = *this->ctx()->llvm_ctx();
+    llvm::Module *module = builder.GetInsertBlock()->getModule();
+    llvm::Function *function = builder.GetInsertBlock()->getParent();
+    llvm::IntegerType *int64 = this->ctx()->int64();
+
+    // Fast path: count the bytes down in a thread-local budget, so that sampling costs a subtraction per allocation.
+    llvm::GlobalVariable *budget = module->getNamedGlobal(kAllocationBudgetName);
+    if (budget == nullptr) {
+      budget = new llvm::GlobalVariable(*module, int64, false, llvm::GlobalValue::ExternalLinkage, nullptr,
+                                        kAllocationBudgetName, nullptr, llvm::GlobalValue::InitialExecTLSModel);
+    }
+    llvm::Value *remaining = builder.CreateSub(builder.CreateLoad(int64, budget, "allocation_budget"),
+                                               llvm::ConstantInt::get(int64, size), "remaining_budget");
+    builder.CreateStore(remaining, budget);
+
+    llvm::BasicBlock *sample_block = llvm::BasicBlock::Create(llvm_ctx, "sample_allocation", function);
+    llvm::BasicBlock *done_block = llvm::BasicBlock::Create(llvm_ctx, "sample_allocation_done", function);
+    llvm::Value *exhausted = builder.CreateICmpSLT(remaining, llvm::ConstantInt::get(int64, 0), "budget_exhausted");
+    builder.CreateCondBr(exhausted, sample_block, done_block, llvm::MDBuilder(llvm_ctx).createBranchWeights(1, 2000));
+
+    // Slow path: the runtime records the class and the allocation site, and refills the budget.
+    builder.SetInsertPoint(sample_block);
+    llvm::FunctionType *sample_type = llvm::FunctionType::get(
+        this->ctx()->void_type(), {this->ctx()->ptr_type(), int64, this->ctx()->ptr_type()}, false);
+    llvm::FunctionCallee sample = module->getOrInsertFunction(kSampleAllocationName, sample_type);
+    if (auto *declaration = llvm::dyn_cast<llvm::Function>(sample.getCallee())) {
+      declaration->addFnAttr(llvm::Attribute::Cold);
+      declaration->addFnAttr(llvm::Attribute::NoUnwind);
+    }
+    llvm::Constant *name = builder.CreateGlobalStringPtr(class_name, "class_name", 0, module);
+    builder.CreateCall(sample, {name, llvm::ConstantInt::get(int64, size), site_name});
+    builder.CreateBr(done_block);
+
+    builder.SetInsertPoint(done_block);
+  }
+
  private:
   std::map<llvm::Module *, std::map<std::string, llvm::Function *, std::less<>>> string_literal_getters_;
 
+  /**
+   * Calls a runtime function that throws an exception (or otherwise never returns), and terminates the builder's
+   * current block.
+   */
+  void EmitThrow(llvm::IRBuilder<> &builder, const char *function_name,
+                 llvm::ArrayRef<llvm::Value *> args = llvm::None) const {
+    llvm::Module *module = builder.GetInsertBlock()->getModule();
+    std::vector<llvm::Type *> arg_types{};
+    arg_types.reserve(args.size());
+    for (llvm::Value *arg : args) { arg_types.push_back(arg->getType()); }
+    llvm::FunctionType *function_type = llvm::FunctionType::get(this->ctx()->void_type(), arg_types, false);
+    llvm::FunctionCallee function = module->getOrInsertFunction(function_name, function_type);
+    if (auto *declaration = llvm::dyn_cast<llvm::Function>(function.getCallee())) {
+      declaration->addFnAttr(llvm::Attribute::Cold);
+      declaration->addFnAttr(llvm::Attribute::NoReturn);
+    }
+
+    llvm::CallInst *call = builder.CreateCall(function, args);
+    call->setDoesNotReturn();
+    builder.CreateUnreachable();
+  }
+
   [[nodiscard]] llvm::FunctionType *getter_type() const {
     return llvm::FunctionType::get(this->ctx()->ptr_type(), llvm::None, false);
   }
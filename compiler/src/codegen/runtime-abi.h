@@ -34,6 +34,37 @@ class RuntimeABI {
    */
   virtual Value GetStringConstant(llvm::IRBuilder<> &builder, std::string_view value) = 0;
 
+  /**
+   * Emits IR to throw java.lang.ArithmeticException for an integer division by zero. The builder's current block is
+   * terminated, since the call never returns.
+   */
+  virtual void EmitThrowDivisionByZero(llvm::IRBuilder<> &builder) = 0;
+  /**
+   * Emits IR to throw java.lang.NullPointerException. The builder's current block is terminated, since the call never
+   * returns.
+   */
+  virtual void EmitThrowNullPointer(llvm::IRBuilder<> &builder) = 0;
+  /**
+   * Emits IR that aborts the program because a method that reachability analysis found unreachable was called, which
+   * means that the analysis missed a way to reach it. The builder's current block is terminated.
+   * @param method_name the Java name of the method, for the error message
+   */
+  virtual void EmitUnreachableMethod(llvm::IRBuilder<> &builder, const std::string &method_name) = 0;
+
+  /**
+   * Emits IR that stops the thread if the runtime has requested a safepoint.
+   */
+  virtual void EmitSafepointPoll(llvm::IRBuilder<> &builder) = 0;
+
+  /**
+   * Emits IR that charges an allocation of `size` bytes against the thread's allocation sampling budget, and reports
+   * the allocation to the runtime's allocation profiler once the budget runs out. Leaves the builder in a new block.
+   *
+   * @param site_name a pointer to the C string that names the allocation site
+   */
+  virtual void EmitAllocationSample(llvm::IRBuilder<> &builder, const std::string &class_name, uint64_t size,
+                                    llvm::Value *site_name) = 0;
+
  protected:
   RuntimeABI();
 
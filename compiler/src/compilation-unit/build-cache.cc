@@ -0,0 +1,161 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "build-cache.h"
+
+#include <fstream>
+#include <optional>
+#include <sstream>
+
+#include <cjbp/cjbp.h>
+#include <fmt/core.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Support/xxhash.h>
+
+#include "context/context.h"
+#include "types/class/class.h"
+#include "types/pool/pool.h"
+
+namespace magnetic {
+
+namespace {
+constexpr const char *kManifestHeader = "magnetic-build-cache 1";
+}// namespace
+
+std::unique_ptr<BuildCache> BuildCache::Open(Context *ctx, std::string directory, uint64_t options_hash) {
+  auto cache = std::make_unique<BuildCache>(ctx, std::move(directory), options_hash);
+  llvm::sys::fs::create_directories(cache->directory_);
+  cache->Load();
+  return cache;
+}
+BuildCache::BuildCache(Context *ctx, std::string directory, uint64_t options_hash)
+    : ctx_(ctx), directory_(std::move(directory)), options_hash_(options_hash), cached_entries_(),
+      cached_dependencies_(), entries_(), dependencies_(), interface_hashes_() {}
+
+void BuildCache::Load() {
+  std::ifstream manifest(this->GetManifestPath());
+  std::string line;
+  if (!std::getline(manifest, line) || line != kManifestHeader) return;
+  if (!std::getline(manifest, line) || line != fmt::format("options {:016x}", this->options_hash_)) return;
+
+  std::string class_name{};
+  DependencyGraph::Dependencies dependencies{};
+  while (std::getline(manifest, line)) {
+    std::istringstream fields(line);
+    std::string tag;
+    fields >> tag;
+    if (tag == "class") {
+      if (!class_name.empty()) this->cached_dependencies_.Set(class_name, std::move(dependencies));
+      dependencies = {};
+      Entry entry{};
+      fields >> class_name >> std::hex >> entry.content_hash >> entry.interface_hash;
+      this->cached_entries_[class_name] = entry;
+    } else if (tag == "dep") {
+      std::string kind_name, dependency;
+      fields >> kind_name >> dependency;
+      std::optional<DependencyKind> kind = ParseDependencyKind(kind_name);
+      // A manifest that can't be read means that everything is recompiled.
+      if (!kind.has_value() || class_name.empty()) {
+        this->cached_entries_.clear();
+        return;
+      }
+      dependencies.emplace(dependency, kind.value());
+    }
+  }
+  if (!class_name.empty()) this->cached_dependencies_.Set(class_name, std::move(dependencies));
+}
+
+bool BuildCache::IsUpToDate(ClassInfo *clazz) {
+  const auto &it = this->cached_entries_.find(clazz->name());
+  if (it == this->cached_entries_.end()) return false;
+  if (it->second.content_hash != clazz->content_hash()) return false;
+  if (!llvm::sys::fs::exists(this->GetObjectPath(clazz->name()))) return false;
+
+  for (const auto &[dependency_name, kind] : this->cached_dependencies_.GetDependencies(clazz->name())) {
+    const auto &dependency_it = this->cached_entries_.find(dependency_name);
+    if (dependency_it == this->cached_entries_.end()) return false;
+    ClassInfo *dependency = this->ctx_->pool()->Load(dependency_name);
+    if (dependency == nullptr) return false;
+    if (this->GetInterfaceHash(dependency) != dependency_it->second.interface_hash) return false;
+  }
+  return true;
+}
+
+void BuildCache::AddDependency(const std::string &from, const std::string &to, DependencyKind kind) {
+  this->dependencies_.Add(from, to, kind);
+}
+void BuildCache::AddClass(ClassInfo *clazz, bool was_compiled) {
+  this->entries_[clazz->name()] = {clazz->content_hash(), this->GetInterfaceHash(clazz)};
+  if (!was_compiled) {
+    this->dependencies_.Set(clazz->name(), this->cached_dependencies_.GetDependencies(clazz->name()));
+  }
+}
+
+const DependencyGraph::Dependencies &BuildCache::GetCachedDependencies(const std::string &class_name) const {
+  return this->cached_dependencies_.GetDependencies(class_name);
+}
+
+bool BuildCache::Save() const {
+  std::string path = this->GetManifestPath();
+  std::string temp_path = path + ".tmp";
+  {
+    std::error_code ec;
+    llvm::raw_fd_ostream ofs(temp_path, ec);
+    if (ec) {
+      llvm::errs() << "cannot open " << temp_path << ": " << ec.message() << "\n";
+      return false;
+    }
+    ofs << kManifestHeader << "\n";
+    ofs << fmt::format("options {:016x}\n", this->options_hash_);
+    for (const auto &[class_name, entry] : this->entries_) {
+      ofs << fmt::format("class {} {:016x} {:016x}\n", class_name, entry.content_hash, entry.interface_hash);
+      for (const auto &[dependency, kind] : this->dependencies_.GetDependencies(class_name)) {
+        ofs << "dep " << GetDependencyKindName(kind) << " " << dependency << "\n";
+      }
+    }
+  }
+  // Renamed into place, so that an interrupted build never leaves a manifest that is only partly written.
+  if (std::error_code ec = llvm::sys::fs::rename(temp_path, path)) {
+    llvm::errs() << "cannot write " << path << ": " << ec.message() << "\n";
+    return false;
+  }
+  return true;
+}
+
+std::string BuildCache::GetObjectPath(const std::string &class_name) const {
+  std::string file_name = class_name;
+  for (char &c : file_name) {
+    if (c == '/') c = '.';
+  }
+  return this->directory_ + "/" + file_name + ".o";
+}
+std::string BuildCache::GetManifestPath() const { return this->directory_ + "/manifest"; }
+
+uint64_t BuildCache::GetInterfaceHash(ClassInfo *clazz) {
+  const auto &it = this->interface_hashes_.find(clazz->name());
+  if (it != this->interface_hashes_.end()) return it->second;
+
+  // A sub class's layout and vtable start with its super class's, so its interface includes its super class's.
+  std::string interface{};
+  const std::string *super_class_name = clazz->bytecode()->super_class();
+  if (super_class_name != nullptr) {
+    ClassInfo *super_class = this->ctx_->pool()->Load(*super_class_name);
+    uint64_t super_hash = (super_class != nullptr) ? this->GetInterfaceHash(super_class) : 0;
+    interface += fmt::format("super {} {:016x}\n", *super_class_name, super_hash);
+  }
+  interface += fmt::format("flags {}\n", clazz->bytecode()->access_flags());
+  for (const auto &field : clazz->bytecode()->fields()) {
+    interface += fmt::format("field {} {} {}\n", field->access_flags(), field->name(), field->descriptor());
+  }
+  for (const auto &method : clazz->bytecode()->methods()) {
+    interface += fmt::format("method {} {} {}\n", method->access_flags(), method->name(), method->descriptor());
+  }
+
+  uint64_t hash = llvm::xxHash64(interface);
+  this->interface_hashes_.emplace(clazz->name(), hash);
+  return hash;
+}
+
+}// namespace magnetic
@@ -0,0 +1,92 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "context/dependency-graph.h"
+
+namespace magnetic {
+
+class ClassInfo;
+class Context;
+
+/**
+ * Object files of previously compiled classes, for incremental builds. Each class is compiled into its own compilation
+ * unit, and its object file is reused as long as nothing that its code depends on has changed.
+ *
+ * The cache directory holds one object file per class, and a manifest that records, for each class, a hash of its
+ * class file, a hash of its interface (super class, flags, fields and method signatures, including those of its super
+ * classes), and the classes that its code depends on (see DependencyGraph). A class has to be recompiled if:
+ *  - its class file changed,
+ *  - the interface of a class that it depends on changed, or
+ *  - the compiler's options changed.
+ */
+class BuildCache {
+ public:
+  /**
+   * Opens the cache in the directory, creating the directory if it doesn't exist. The cache is empty if it was written
+   * with other options.
+   *
+   * @param options_hash a hash of every compiler option that affects code generation
+   */
+  static std::unique_ptr<BuildCache> Open(Context *ctx, std::string directory, uint64_t options_hash);
+
+  BuildCache(Context *ctx, std::string directory, uint64_t options_hash);
+
+  /**
+   * @return true if the class's cached object file can be used instead of compiling it
+   */
+  [[nodiscard]] bool IsUpToDate(ClassInfo *clazz);
+
+  /**
+   * Records that code being compiled for one class depends on another class.
+   */
+  void AddDependency(const std::string &from, const std::string &to, DependencyKind kind);
+  /**
+   * Adds the class to the manifest that Save writes, along with the dependencies found while compiling it, or the
+   * cached dependencies if it wasn't recompiled.
+   */
+  void AddClass(ClassInfo *clazz, bool was_compiled);
+  /**
+   * @return the dependencies that were recorded the last time that the class was compiled
+   */
+  [[nodiscard]] const DependencyGraph::Dependencies &GetCachedDependencies(const std::string &class_name) const;
+  /**
+   * Writes the manifest.
+   * @return false if it couldn't be written (the error is printed)
+   */
+  [[nodiscard]] bool Save() const;
+
+  [[nodiscard]] std::string GetObjectPath(const std::string &class_name) const;
+
+ private:
+  struct Entry {
+    uint64_t content_hash;
+    uint64_t interface_hash;
+  };
+
+  Context *ctx_;
+  std::string directory_;
+  uint64_t options_hash_;
+
+  std::unordered_map<std::string, Entry> cached_entries_;
+  DependencyGraph cached_dependencies_;
+
+  std::map<std::string, Entry> entries_;
+  DependencyGraph dependencies_;
+
+  std::unordered_map<std::string, uint64_t> interface_hashes_;
+
+  void Load();
+  [[nodiscard]] uint64_t GetInterfaceHash(ClassInfo *clazz);
+  [[nodiscard]] std::string GetManifestPath() const;
+};
+
+}// namespace magnetic
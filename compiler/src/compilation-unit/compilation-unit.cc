@@ -6,39 +6,184 @@
 
 #include <llvm/Analysis/CGSCCPassManager.h>
 #include <llvm/Analysis/LoopAccessAnalysis.h>
+#include <llvm/IR/LegacyPassManager.h>
 #include <llvm/IR/Verifier.h>
+#include <llvm/MC/SubtargetFeature.h>
+#include <llvm/MC/TargetRegistry.h>
 #include <llvm/Passes/PassBuilder.h>
+#include <llvm/Passes/StandardInstrumentations.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/PGOOptions.h>
+#include <llvm/Transforms/IPO/HotColdSplitting.h>
+#include <llvm/Transforms/Scalar/InductiveRangeCheckElimination.h>
+#include <llvm/Transforms/Scalar/LICM.h>
+#include <llvm/Transforms/Scalar/SROA.h>
 
 #include "class/class.h"
+#include "codegen/call-profile.h"
+#include "codegen/debug-info.h"
 #include "context/context.h"
+#include "context/statistics.h"
+#include "optimize/escape-analysis.h"
+#include "optimize/function-layout.h"
+#include "optimize/safepoint-elimination.h"
 
 namespace magnetic {
 
 CompilationUnit::CompilationUnit(std::string module_name, Context *ctx)
-    : ctx_(ctx), module_name_(std::move(module_name)) {
+    : ctx_(ctx), module_name_(std::move(module_name)), debug_info_(nullptr), call_profile_(nullptr),
+      is_cached_(false) {
   this->module_ = new llvm::Module(this->module_name_, *this->ctx_->llvm_ctx());
+
+  // The data layout has to be set before any class is laid out, since struct sizes and alignments depend on it.
+  llvm::TargetMachine *target_machine = this->ctx_->target_machine();
+  if (target_machine != nullptr) {
+    this->module_->setTargetTriple(target_machine->getTargetTriple().str());
+    this->module_->setDataLayout(target_machine->createDataLayout());
+  }
+  if (this->ctx_->emit_debug_info()) this->debug_info_ = DebugInfoEmitter::Create(this->module_);
+  if (this->ctx_->count_calls()) this->call_profile_ = CallProfileEmitter::Create(this->module_);
+}
+CompilationUnit::~CompilationUnit() noexcept = default;
+
+std::unique_ptr<llvm::TargetMachine> CreateTargetMachine(const std::string &cpu) {
+  std::string triple = llvm::sys::getProcessTriple();
+  std::string error;
+  const llvm::Target *target = llvm::TargetRegistry::lookupTarget(triple, error);
+  if (target == nullptr) return nullptr;
+
+  std::string cpu_name = cpu.empty() ? "generic" : cpu;
+  llvm::SubtargetFeatures features;
+  if (cpu == "native") {
+    cpu_name = llvm::sys::getHostCPUName().str();
+    llvm::StringMap<bool> host_features;
+    if (llvm::sys::getHostCPUFeatures(host_features)) {
+      for (const auto &feature : host_features) { features.AddFeature(feature.first(), feature.second); }
+    }
+  }
+  return std::unique_ptr<llvm::TargetMachine>(
+      target->createTargetMachine(triple, cpu_name, features.getString(), llvm::TargetOptions(), llvm::Reloc::PIC_,
+                                  llvm::None, llvm::CodeGenOpt::Aggressive));
+}
+
+std::optional<llvm::OptimizationLevel> ParseOptimizationLevel(const std::string &name) {
+  if (name == "0") return llvm::OptimizationLevel::O0;
+  if (name == "1") return llvm::OptimizationLevel::O1;
+  if (name == "2") return llvm::OptimizationLevel::O2;
+  if (name == "3") return llvm::OptimizationLevel::O3;
+  if (name == "s") return llvm::OptimizationLevel::Os;
+  if (name == "z") return llvm::OptimizationLevel::Oz;
+  return std::nullopt;
+}
+
+namespace {
+llvm::Optional<llvm::PGOOptions> CreatePGOOptions(const ProfileOptions &options) {
+  switch (options.mode) {
+    case ProfileOptions::Mode::kInstrument: return llvm::PGOOptions(options.path, "", "", llvm::PGOOptions::IRInstr);
+    case ProfileOptions::Mode::kOptimize: return llvm::PGOOptions(options.path, "", "", llvm::PGOOptions::IRUse);
+    default: return llvm::None;
+  }
 }
+}// namespace
 
-void CompilationUnit::Verify() const { llvm::verifyModule(*this->module_, &llvm::errs()); }
+void CompilationUnit::FinalizeModule() const {
+  if (this->debug_info_ != nullptr) this->debug_info_->Finalize();
+  if (this->call_profile_ != nullptr) this->call_profile_->Finalize();
+  if (this->ctx_->emit_frame_pointers()) {
+    // The module flag covers functions that optimization creates later (e.g. outlined cold code).
+    this->module_->setFramePointer(llvm::FramePointerKind::All);
+    for (llvm::Function &function : *this->module_) {
+      if (!function.isDeclaration()) function.addFnAttr("frame-pointer", "all");
+    }
+  }
+}
+void CompilationUnit::Verify() const {
+  this->FinalizeModule();
+  llvm::verifyModule(*this->module_, &llvm::errs());
+}
 void CompilationUnit::Optimize(llvm::OptimizationLevel level) const {
+  this->FinalizeModule();
+  CompileStatistics::Scope scope(this->ctx_->statistics(), CompilePhase::kOptimization, this->module_name_);
+  const ProfileOptions &profile = this->ctx_->profile_options();
+
   llvm::LoopAnalysisManager loop_analysis;
   llvm::FunctionAnalysisManager function_analysis;
   llvm::CGSCCAnalysisManager call_graph_analysis;
   llvm::ModuleAnalysisManager module_analysis;
-  llvm::PassBuilder pass_builder;
+  // Standard instrumentations add every pass to the time trace, when one is being recorded.
+  llvm::PassInstrumentationCallbacks instrumentation_callbacks;
+  llvm::StandardInstrumentations instrumentations(false);
+  instrumentations.registerCallbacks(instrumentation_callbacks, &function_analysis);
+  llvm::PassBuilder pass_builder(this->ctx_->target_machine(), llvm::PipelineTuningOptions(),
+                                 CreatePGOOptions(profile), &instrumentation_callbacks);
   pass_builder.registerModuleAnalyses(module_analysis);
   pass_builder.registerCGSCCAnalyses(call_graph_analysis);
   pass_builder.registerFunctionAnalyses(function_analysis);
   pass_builder.registerLoopAnalyses(loop_analysis);
   pass_builder.crossRegisterProxies(loop_analysis, function_analysis, call_graph_analysis, module_analysis);
-  llvm::ModulePassManager pass_manager = pass_builder.buildPerModuleDefaultPipeline(level);
+  pass_builder.registerScalarOptimizerLateEPCallback(
+      [](llvm::FunctionPassManager &function_passes, llvm::OptimizationLevel) {
+        // Instantiators have been inlined by now, so non-escaping objects can be moved to the stack, then split into
+        // SSA values.
+        function_passes.addPass(StackAllocationPass());
+        function_passes.addPass(llvm::SROAPass());
+      });
+  pass_builder.registerVectorizerStartEPCallback(
+      [](llvm::FunctionPassManager &function_passes, llvm::OptimizationLevel) {
+        // IRCE removes range checks on the induction variable from the main loop, and LICM hoists invariant loads out
+        // of loops. Loops are not versioned on runtime alias checks: LoopVersioningLICM can crash LLVM 14's
+        // LoopAccessAnalysis on valid input.
+        //
+        // Safepoint polls are volatile loads, which neither LICM nor the vectorizer will touch, so they are removed
+        // from loops with a small trip count first.
+        function_passes.addPass(SafepointEliminationPass());
+        function_passes.addPass(llvm::IRCEPass());
+        function_passes.addPass(llvm::createFunctionToLoopPassAdaptor(llvm::LICMPass(), true));
+      });
+  pass_builder.registerOptimizerLastEPCallback([](llvm::ModulePassManager &module_passes, llvm::OptimizationLevel) {
+    // Blocks that are unlikely to run (error paths, one-time setup) are moved out of their functions, then functions
+    // are grouped by temperature and laid out next to their callees to keep the hot code on as few pages as possible.
+    // Temperatures come from profile counts when optimizing with a profile, and from hot/cold attributes otherwise.
+    module_passes.addPass(llvm::HotColdSplittingPass());
+    module_passes.addPass(FunctionLayoutPass());
+  });
+  // The default pipeline can't be built at O0, which only runs the passes that are needed for correctness.
+  llvm::ModulePassManager pass_manager = (level == llvm::OptimizationLevel::O0)
+                                             ? pass_builder.buildO0DefaultPipeline(level)
+                                             : pass_builder.buildPerModuleDefaultPipeline(level);
   pass_manager.run(*this->module_, module_analysis);
+  scope.set_instruction_count(this->module_->getInstructionCount());
 }
 void CompilationUnit::PrintModuleToFile(const std::string &path) const {
+  this->FinalizeModule();
   std::error_code ec;
   llvm::raw_fd_ostream ofs(path, ec);
   this->module_->print(ofs, nullptr);
   ofs.close();
 }
+bool CompilationUnit::EmitObjectFile(const std::string &path) const {
+  this->FinalizeModule();
+  llvm::TargetMachine *target_machine = this->ctx_->target_machine();
+  if (target_machine == nullptr) {
+    llvm::errs() << "cannot emit " << path << ": no target machine\n";
+    return false;
+  }
+
+  std::error_code ec;
+  llvm::raw_fd_ostream ofs(path, ec);
+  if (ec) {
+    llvm::errs() << "cannot open " << path << ": " << ec.message() << "\n";
+    return false;
+  }
+  // Code generation still runs on the legacy pass manager.
+  llvm::legacy::PassManager pass_manager;
+  if (target_machine->addPassesToEmitFile(pass_manager, ofs, nullptr, llvm::CGFT_ObjectFile)) {
+    llvm::errs() << "cannot emit " << path << ": the target can't emit object files\n";
+    return false;
+  }
+  pass_manager.run(*this->module_);
+  ofs.close();
+  return true;
+}
 
 }// namespace magnetic
@@ -5,30 +5,101 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 
 #include <llvm/IR/Module.h>
 #include <llvm/Passes/OptimizationLevel.h>
+#include <llvm/Target/TargetMachine.h>
 
 namespace magnetic {
 
+class CallProfileEmitter;
 class Context;
+class DebugInfoEmitter;
+
+/**
+ * Profile-guided optimization settings, shared by every compilation unit.
+ *
+ * An instrumented build records edge counts, function entry counts (which includes the allocation count of each
+ * class, since every allocation goes through the class's instantiator) and the targets of indirect calls (i.e. which
+ * implementations virtual calls dispatch to). Instrumented binaries have to be linked against LLVM's profile runtime,
+ * and the raw profiles they write have to be merged with llvm-profdata before being used by an optimized build.
+ *
+ * An optimized build turns the counts into branch weights, splits cold code out of hot functions, and promotes the
+ * most common targets of each indirect call into guarded direct calls.
+ */
+struct ProfileOptions {
+  enum class Mode { kNone, kInstrument, kOptimize };
+
+  Mode mode = Mode::kNone;
+  /**
+   * Where an instrumented build writes its raw profile, or the merged profile an optimized build reads.
+   */
+  std::string path;
+};
+
+/**
+ * Creates a target machine for the triple the compiler is running on. The optimizer uses it to pick vector widths and
+ * costs.
+ *
+ * LLVM's native target has to be initialized (llvm::InitializeNativeTarget) first.
+ * @param cpu the CPU to tune for and to use the extensions of, "native" for the CPU the compiler is running on
+ *            (including all of its vector extensions, so the output only runs on CPUs with the same features), or
+ *            empty for the triple's generic CPU, whose output runs anywhere
+ * @return the target machine, or nullptr if LLVM wasn't built with support for the host
+ */
+std::unique_ptr<llvm::TargetMachine> CreateTargetMachine(const std::string &cpu);
+
+/**
+ * @param name "0", "1", "2", "3", "s" or "z", as in -O2
+ */
+std::optional<llvm::OptimizationLevel> ParseOptimizationLevel(const std::string &name);
 
 class CompilationUnit {
  public:
   CompilationUnit(std::string module_name, Context *ctx);
+  ~CompilationUnit() noexcept;
 
   void Verify() const;
   void Optimize(llvm::OptimizationLevel level) const;
   void PrintModuleToFile(const std::string &path) const;
+  /**
+   * Compiles the module to a native object file for the context's target machine.
+   * @return false if there is no target machine or the file couldn't be written (the error is printed)
+   */
+  [[nodiscard]] bool EmitObjectFile(const std::string &path) const;
 
   [[nodiscard]] llvm::Module *module() const { return this->module_; }
+  /**
+   * @return nullptr if debug info isn't being emitted
+   */
+  [[nodiscard]] DebugInfoEmitter *debug_info() const { return this->debug_info_.get(); }
+  /**
+   * @return nullptr if calls aren't being counted
+   */
+  [[nodiscard]] CallProfileEmitter *call_profile() const { return this->call_profile_.get(); }
+  /**
+   * @return true if the unit's object file is reused from an earlier build (see BuildCache), so its methods aren't
+   *         compiled
+   */
+  [[nodiscard]] bool is_cached() const { return this->is_cached_; }
+  void set_cached(bool value) { this->is_cached_ = value; }
 
  private:
   Context *ctx_;
   llvm::Module *module_;
   std::string module_name_;
+  std::unique_ptr<DebugInfoEmitter> debug_info_;    // Can be nullptr.
+  std::unique_ptr<CallProfileEmitter> call_profile_;// Can be nullptr.
+  bool is_cached_;
+
+  /**
+   * Finishes the debug info and the call profile, and applies module-wide function attributes, which has to happen
+   * before the module is verified, optimized or written.
+   */
+  void FinalizeModule() const;
 };
 
 }// namespace magnetic
@@ -9,16 +9,26 @@
 #include <llvm/IR/DerivedTypes.h>
 #include <llvm/IR/LLVMContext.h>
 
+#include "analysis/reachability.h"
 #include "class/class.h"
+#include "class/descriptor.h"
 #include "class/mangle.h"
 #include "class/pool/pool.h"
+#include "codegen/intrinsics.h"
 #include "codegen/runtime-abi.h"
+#include "compilation-unit/build-cache.h"
 #include "compilation-unit/compilation-unit.h"
+#include "statistics.h"
 #include "types/type.h"
 
 namespace magnetic {
 
-Context::Context() : fields_(), methods_(), instantiators_(), single_unit_compilation_(false), global_unit_(nullptr) {
+Context::Context()
+    : symbols_(), fields_(), methods_(), method_allocator_(), instantiators_(), instantiator_allocator_(),
+      static_method_descriptors_(), instance_method_descriptors_(), single_unit_compilation_(false),
+      global_unit_(nullptr), preinitialize_statics_(false), emit_safepoint_polls_(false),
+      instrument_allocations_(false), count_calls_(false), emit_frame_pointers_(false), emit_debug_info_(false), lazy_method_bodies_(false),
+      profile_options_() {
   this->ctx_ = std::make_unique<llvm::LLVMContext>();
   this->ctx_->enableOpaquePointers();
 
@@ -40,38 +50,46 @@ void Context::set_pool(std::unique_ptr<ClassPool> pool) {
   this->pool_ = std::move(pool);
 }
 
-namespace {
-std::string GetFieldKey(const std::string &class_name, const std::string &name, const std::string &descriptor) {
-  return class_name + ' ' + name + ' ' + descriptor;
-}
-std::string GetMethodKey(const std::string &class_name, const std::string &name, const std::string &descriptor) {
-  return class_name + ' ' + name + ' ' + descriptor;
-}
-}// namespace
 FieldDeclaration *Context::GetField(const std::string &class_name, const std::string &name,
                                     const std::string &descriptor, bool is_static) {
-  std::string key = GetFieldKey(class_name, name, descriptor);
+  MemberKey key{this->symbols_.Intern(class_name), this->symbols_.Intern(name), this->symbols_.Intern(descriptor)};
   const auto &it = this->fields_.find(key);
   if (it != this->fields_.end()) return it->second.get();
 
-  this->fields_.emplace(key, FieldDeclaration::Create(this, is_static, class_name, name, descriptor));
-  return this->fields_.at(key).get();
+  auto field = FieldDeclaration::Create(this, is_static, std::get<0>(key), std::get<1>(key), std::get<2>(key));
+  return this->fields_.try_emplace(key, std::move(field)).first->second.get();
 }
 MethodDeclaration *Context::GetMethod(const std::string &class_name, const std::string &name,
                                       const std::string &descriptor, bool is_static) {
-  std::string key = GetMethodKey(class_name, name, descriptor);
+  MemberKey key{this->symbols_.Intern(class_name), this->symbols_.Intern(name), this->symbols_.Intern(descriptor)};
   const auto &it = this->methods_.find(key);
-  if (it != this->methods_.end()) return it->second.get();
+  if (it != this->methods_.end()) return it->second;
 
-  this->methods_.emplace(key, MethodDeclaration::Create(this, is_static, class_name, name, descriptor));
-  return this->methods_.at(key).get();
+  auto method = new (this->method_allocator_.Allocate())
+      MethodDeclaration(this, is_static, std::get<0>(key), std::get<1>(key), std::get<2>(key));
+  this->methods_.try_emplace(key, method);
+  return method;
 }
 ClassInstantiator *Context::GetInstantiator(const std::string &class_name) {
-  const auto &it = this->instantiators_.find(class_name);
-  if (it != this->instantiators_.end()) return it->second.get();
+  const std::string *class_symbol = this->symbols_.Intern(class_name);
+  const auto &it = this->instantiators_.find(class_symbol);
+  if (it != this->instantiators_.end()) return it->second;
+
+  auto instantiator = new (this->instantiator_allocator_.Allocate()) ClassInstantiator(this, class_symbol);
+  this->instantiators_.try_emplace(class_symbol, instantiator);
+  return instantiator;
+}
+MethodDescriptor *Context::GetMethodDescriptor(bool is_static, const std::string *descriptor) {
+  auto &descriptors = is_static ? this->static_method_descriptors_ : this->instance_method_descriptors_;
+  const auto &it = descriptors.find(descriptor);
+  if (it != descriptors.end()) return it->second.get();
+
+  auto method_descriptor = ParseMethodDescriptor(this, is_static, *descriptor, false);
+  return descriptors.try_emplace(descriptor, std::move(method_descriptor)).first->second.get();
+}
 
-  this->instantiators_.emplace(class_name, ClassInstantiator::Create(this, class_name));
-  return this->instantiators_.at(class_name).get();
+void Context::set_target_machine(std::unique_ptr<llvm::TargetMachine> target_machine) {
+  this->target_machine_ = std::move(target_machine);
 }
 
 void Context::set_name_mangler(std::unique_ptr<NameMangler> name_mangler) {
@@ -83,6 +101,22 @@ void Context::set_runtime_abi(std::unique_ptr<RuntimeABI> runtime_abi) {
   this->runtime_abi_ = std::move(runtime_abi);
 }
 
+void Context::set_intrinsics(std::unique_ptr<IntrinsicRegistry> intrinsics) {
+  this->intrinsics_ = std::move(intrinsics);
+}
+void Context::set_reachability(std::unique_ptr<ReachabilityAnalysis> reachability) {
+  this->reachability_ = std::move(reachability);
+}
+void Context::set_build_cache(std::unique_ptr<BuildCache> build_cache) {
+  this->build_cache_ = std::move(build_cache);
+}
+void Context::RecordDependency(const std::string &from, const std::string &to, DependencyKind kind) {
+  if (this->build_cache_ != nullptr) this->build_cache_->AddDependency(from, to, kind);
+}
+void Context::set_statistics(std::unique_ptr<CompileStatistics> statistics) {
+  this->statistics_ = std::move(statistics);
+}
+
 std::shared_ptr<CompilationUnit> Context::CreateCompilationUnitForClass(const std::string &class_name) {
   if (this->single_unit_compilation_) {
     if (this->global_unit_ == nullptr) { this->global_unit_ = std::make_shared<CompilationUnit>("global_unit", this); }
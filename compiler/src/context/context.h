@@ -5,12 +5,19 @@
 #pragma once
 
 #include <memory>
+#include <tuple>
 
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/IR/LLVMContext.h>
+#include <llvm/Support/Allocator.h>
+#include <llvm/Target/TargetMachine.h>
 
 #include "class/field.h"
 #include "class/instantiate.h"
 #include "class/method.h"
+#include "compilation-unit/compilation-unit.h"
+#include "dependency-graph.h"
+#include "symbol-table.h"
 #include "types/type.h"
 
 namespace magnetic {
@@ -18,8 +25,12 @@ namespace magnetic {
 class Type;
 class ClassPool;
 class CompilationUnit;
+class IntrinsicRegistry;
 class NameMangler;
 class RuntimeABI;
+class CompileStatistics;
+class BuildCache;
+class ReachabilityAnalysis;
 
 class Context {
  public:
@@ -30,6 +41,12 @@ class Context {
   [[nodiscard]] ClassPool *pool() const { return this->pool_.get(); }
   void set_pool(std::unique_ptr<ClassPool> pool);
 
+  /**
+   * Must be set before any compilation unit is created.
+   */
+  void set_target_machine(std::unique_ptr<llvm::TargetMachine> target_machine);
+  [[nodiscard]] llvm::TargetMachine *target_machine() const { return this->target_machine_.get(); }
+
   [[nodiscard]] llvm::IntegerType *int1() const { return this->i1_; }
   [[nodiscard]] llvm::IntegerType *int8() const { return this->i8_; }
   [[nodiscard]] llvm::IntegerType *int16() const { return this->i16_; }
@@ -46,6 +63,12 @@ class Context {
   [[nodiscard]] MethodDeclaration *GetMethod(const std::string &class_name, const std::string &name,
                                              const std::string &descriptor, bool is_static);
   [[nodiscard]] ClassInstantiator *GetInstantiator(const std::string &class_name);
+  /**
+   * Methods with the same descriptor share one parsed MethodDescriptor.
+   */
+  [[nodiscard]] MethodDescriptor *GetMethodDescriptor(bool is_static, const std::string *descriptor);
+
+  [[nodiscard]] SymbolTable &symbols() { return this->symbols_; }
 
   void set_name_mangler(std::unique_ptr<NameMangler> name_mangler);
   [[nodiscard]] NameMangler *name_mangler() const { return this->name_mangler_.get(); }
@@ -53,13 +76,61 @@ class Context {
   void set_runtime_abi(std::unique_ptr<RuntimeABI> runtime_abi);
   [[nodiscard]] RuntimeABI *runtime_abi() const { return this->runtime_abi_.get(); }
 
+  void set_intrinsics(std::unique_ptr<IntrinsicRegistry> intrinsics);
+  [[nodiscard]] IntrinsicRegistry *intrinsics() const { return this->intrinsics_.get(); }
+
+  void set_statistics(std::unique_ptr<CompileStatistics> statistics);
+  [[nodiscard]] CompileStatistics *statistics() const { return this->statistics_.get(); }
+
+  /**
+   * Must be set before the first class is emitted.
+   */
+  void set_reachability(std::unique_ptr<ReachabilityAnalysis> reachability);
+  [[nodiscard]] const ReachabilityAnalysis *reachability() const { return this->reachability_.get(); }
+
+  /**
+   * Must be set before the first class is defined. Requires per-class compilation units.
+   */
+  void set_build_cache(std::unique_ptr<BuildCache> build_cache);
+  [[nodiscard]] BuildCache *build_cache() const { return this->build_cache_.get(); }
+  /**
+   * Records that the code compiled for one class depends on another class, so that incremental builds know to
+   * recompile it when the other class changes. Does nothing if there's no build cache.
+   */
+  void RecordDependency(const std::string &from, const std::string &to, DependencyKind kind);
+
   void set_use_single_unit(bool value) { this->single_unit_compilation_ = value; }
   [[nodiscard]] CompilationUnit *global_unit() const { return this->global_unit_.get(); }
   [[nodiscard]] std::shared_ptr<CompilationUnit> CreateCompilationUnitForClass(const std::string &class_name);
 
+  void set_preinitialize_statics(bool value) { this->preinitialize_statics_ = value; }
+  [[nodiscard]] bool preinitialize_statics() const { return this->preinitialize_statics_; }
+
+  void set_emit_safepoint_polls(bool value) { this->emit_safepoint_polls_ = value; }
+  [[nodiscard]] bool emit_safepoint_polls() const { return this->emit_safepoint_polls_; }
+
+  void set_instrument_allocations(bool value) { this->instrument_allocations_ = value; }
+  [[nodiscard]] bool instrument_allocations() const { return this->instrument_allocations_; }
+
+  void set_count_calls(bool value) { this->count_calls_ = value; }
+  [[nodiscard]] bool count_calls() const { return this->count_calls_; }
+
+  void set_emit_frame_pointers(bool value) { this->emit_frame_pointers_ = value; }
+  [[nodiscard]] bool emit_frame_pointers() const { return this->emit_frame_pointers_; }
+
+  void set_emit_debug_info(bool value) { this->emit_debug_info_ = value; }
+  [[nodiscard]] bool emit_debug_info() const { return this->emit_debug_info_; }
+
+  void set_lazy_method_bodies(bool value) { this->lazy_method_bodies_ = value; }
+  [[nodiscard]] bool lazy_method_bodies() const { return this->lazy_method_bodies_; }
+
+  void set_profile_options(ProfileOptions options) { this->profile_options_ = std::move(options); }
+  [[nodiscard]] const ProfileOptions &profile_options() const { return this->profile_options_; }
+
  private:
   std::unique_ptr<llvm::LLVMContext> ctx_;
   std::unique_ptr<ClassPool> pool_;
+  std::unique_ptr<llvm::TargetMachine> target_machine_;// Can be nullptr.
 
   llvm::IntegerType *i1_;
   llvm::IntegerType *i8_;
@@ -72,12 +143,24 @@ class Context {
   llvm::PointerType *ptr_type_;
   llvm::ConstantPointerNull *pointer_null_;
 
-  std::unordered_map<std::string, std::unique_ptr<FieldDeclaration>> fields_;
-  std::unordered_map<std::string, std::unique_ptr<MethodDeclaration>> methods_;
-  std::unordered_map<std::string, std::unique_ptr<ClassInstantiator>> instantiators_;
+  // Declarations are keyed by their interned class name, name and descriptor. Methods and instantiators, of which there
+  // are many more than anything else, are allocated in arenas, which keeps them together in memory.
+  using MemberKey = std::tuple<const std::string *, const std::string *, const std::string *>;
+  SymbolTable symbols_;
+  llvm::DenseMap<MemberKey, std::unique_ptr<FieldDeclaration>> fields_;
+  llvm::DenseMap<MemberKey, MethodDeclaration *> methods_;
+  llvm::SpecificBumpPtrAllocator<MethodDeclaration> method_allocator_;
+  llvm::DenseMap<const std::string *, ClassInstantiator *> instantiators_;
+  llvm::SpecificBumpPtrAllocator<ClassInstantiator> instantiator_allocator_;
+  llvm::DenseMap<const std::string *, std::unique_ptr<MethodDescriptor>> static_method_descriptors_;
+  llvm::DenseMap<const std::string *, std::unique_ptr<MethodDescriptor>> instance_method_descriptors_;
 
   std::unique_ptr<NameMangler> name_mangler_;
   std::unique_ptr<RuntimeABI> runtime_abi_;
+  std::unique_ptr<IntrinsicRegistry> intrinsics_;// Can be nullptr.
+  std::unique_ptr<CompileStatistics> statistics_;// Can be nullptr.
+  std::unique_ptr<ReachabilityAnalysis> reachability_;// nullptr if every method is compiled.
+  std::unique_ptr<BuildCache> build_cache_;// Can be nullptr.
 
   /**
    * All classes are compiled into the same compilation unit. The default behavior (i.e. if this is false) is to give
@@ -85,6 +168,49 @@ class Context {
    */
   bool single_unit_compilation_;
   std::shared_ptr<CompilationUnit> global_unit_;
+
+  /**
+   * Static initializers that are free of side effects are run at compile time, and their results are emitted as the
+   * initial values of the static fields instead of running at startup.
+   */
+  bool preinitialize_statics_;
+
+  /**
+   * Compiled code polls for safepoints at method entries and loop back edges, so that the runtime can stop every
+   * thread (for GC or thread suspension). Polls in loops with a small trip count are removed again by
+   * optimization.
+   */
+  bool emit_safepoint_polls_;
+
+  /**
+   * Instantiators report a sample of allocations (one every N bytes allocated by a thread) to the runtime's allocation
+   * profiler.
+   */
+  bool instrument_allocations_;
+
+  /**
+   * Methods count their entries, and virtual call sites record which classes their receivers have, in per-thread
+   * counters that the runtime's call profiler reads. Must be set before the first class is loaded.
+   */
+  bool count_calls_;
+
+  /**
+   * Every function keeps a frame pointer, so that the runtime's sampling profiler can walk stacks.
+   */
+  bool emit_frame_pointers_;
+
+  /**
+   * Compiled methods carry DWARF line info (from the class files' LineNumberTables) and are listed with their Java
+   * names in a method table that the runtime symbolizes addresses with. Must be set before the first class is loaded.
+   */
+  bool emit_debug_info_;
+
+  /**
+   * Method bodies are split off of class files when they are loaded, and only decoded when the method is compiled.
+   */
+  bool lazy_method_bodies_;
+
+  ProfileOptions profile_options_;
 };
 
 }// namespace magnetic
@@ -0,0 +1,41 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "dependency-graph.h"
+
+namespace magnetic {
+
+const char *GetDependencyKindName(DependencyKind kind) {
+  switch (kind) {
+    case DependencyKind::kSuperClass: return "super";
+    case DependencyKind::kLayout: return "layout";
+    case DependencyKind::kVTable: return "vtable";
+    case DependencyKind::kSymbol: return "symbol";
+  }
+  return "unknown";
+}
+std::optional<DependencyKind> ParseDependencyKind(const std::string &name) {
+  for (DependencyKind kind : {DependencyKind::kSuperClass, DependencyKind::kLayout, DependencyKind::kVTable,
+                              DependencyKind::kSymbol}) {
+    if (name == GetDependencyKindName(kind)) return kind;
+  }
+  return std::nullopt;
+}
+
+void DependencyGraph::Add(const std::string &from, const std::string &to, DependencyKind kind) {
+  if (from == to) return;
+  this->edges_[from].emplace(to, kind);
+}
+void DependencyGraph::Set(const std::string &from, Dependencies dependencies) {
+  this->edges_[from] = std::move(dependencies);
+}
+
+const DependencyGraph::Dependencies &DependencyGraph::GetDependencies(const std::string &class_name) const {
+  static const Dependencies kNoDependencies{};
+  const auto &it = this->edges_.find(class_name);
+  if (it == this->edges_.end()) return kNoDependencies;
+  return it->second;
+}
+
+}// namespace magnetic
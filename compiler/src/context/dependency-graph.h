@@ -0,0 +1,58 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace magnetic {
+
+/**
+ * What a class's compiled code relies on from another class.
+ */
+enum class DependencyKind {
+  /**
+   * The class's struct type and vtable start with the other class's.
+   */
+  kSuperClass,
+  /**
+   * Field offsets in the other class's struct type.
+   */
+  kLayout,
+  /**
+   * Vtable slots of the other class, and whether its methods can be overridden (which decides between direct and
+   * virtual calls).
+   */
+  kVTable,
+  /**
+   * The other class's symbols (methods, static fields and its instantiator) and their types.
+   */
+  kSymbol,
+};
+
+const char *GetDependencyKindName(DependencyKind kind);
+std::optional<DependencyKind> ParseDependencyKind(const std::string &name);
+
+/**
+ * Edges from each class to the classes that its compiled code depends on. Compilation units don't inline across each
+ * other, so these are the only ways that one class's code can change when another class does.
+ */
+class DependencyGraph {
+ public:
+  using Dependencies = std::set<std::pair<std::string, DependencyKind>>;
+
+  void Add(const std::string &from, const std::string &to, DependencyKind kind);
+  void Set(const std::string &from, Dependencies dependencies);
+
+  [[nodiscard]] const Dependencies &GetDependencies(const std::string &class_name) const;
+
+ private:
+  std::unordered_map<std::string, Dependencies> edges_;
+};
+
+}// namespace magnetic
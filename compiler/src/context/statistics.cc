@@ -0,0 +1,106 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "statistics.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include <fmt/core.h>
+
+namespace magnetic {
+
+const char *GetCompilePhaseName(CompilePhase phase) {
+  switch (phase) {
+    case CompilePhase::kClassPathLookup: return "ClassPathLookup";
+    case CompilePhase::kClassParsing: return "ClassParsing";
+    case CompilePhase::kReachability: return "Reachability";
+    case CompilePhase::kClassEmission: return "ClassEmission";
+    case CompilePhase::kMethodCodegen: return "MethodCodegen";
+    case CompilePhase::kOptimization: return "Optimization";
+  }
+  return "Unknown";
+}
+
+namespace {
+double ToMilliseconds(std::chrono::steady_clock::duration duration) {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+}// namespace
+
+CompileStatistics::Scope::Scope(CompileStatistics *statistics, CompilePhase phase, const std::string &class_name,
+                                const std::string &method_name)
+    : statistics_(statistics), phase_(phase), class_name_(class_name), method_name_(method_name),
+      start_(std::chrono::steady_clock::now()), nested_time_(), instruction_count_(0) {
+  if (llvm::timeTraceProfilerEnabled()) {
+    std::string detail = method_name.empty() ? class_name : class_name + "." + method_name;
+    this->trace_.emplace(GetCompilePhaseName(phase), detail);
+  }
+  if (this->statistics_ != nullptr) this->statistics_->Enter(this);
+}
+CompileStatistics::Scope::~Scope() noexcept {
+  if (this->statistics_ != nullptr) this->statistics_->Exit(this);
+}
+
+void CompileStatistics::Enter(Scope *scope) { this->active_scopes_.push_back(scope); }
+void CompileStatistics::Exit(Scope *scope) {
+  assert(!this->active_scopes_.empty() && this->active_scopes_.back() == scope);
+  this->active_scopes_.pop_back();
+
+  std::chrono::steady_clock::duration time = std::chrono::steady_clock::now() - scope->start_;
+  std::chrono::steady_clock::duration self_time = time - scope->nested_time_;
+  if (!this->active_scopes_.empty()) this->active_scopes_.back()->nested_time_ += time;
+
+  Totals &phase = this->phases_[static_cast<size_t>(scope->phase_)];
+  phase.time += self_time;
+  phase.instruction_count += scope->instruction_count_;
+  ++phase.count;
+  if (!scope->class_name_.empty()) {
+    Totals &clazz = this->classes_[scope->class_name_];
+    clazz.time += self_time;
+    clazz.instruction_count += scope->instruction_count_;
+    ++clazz.count;
+  }
+  if (!scope->method_name_.empty()) {
+    Totals &method = this->methods_[scope->class_name_ + "." + scope->method_name_];
+    method.time += self_time;
+    method.instruction_count += scope->instruction_count_;
+    ++method.count;
+  }
+}
+
+namespace {
+template<typename Entries>
+void PrintSlowest(llvm::raw_ostream &os, const char *title, const Entries &entries, size_t count) {
+  std::vector<const typename Entries::value_type *> sorted{};
+  sorted.reserve(entries.size());
+  for (const auto &entry : entries) { sorted.push_back(&entry); }
+  std::sort(sorted.begin(), sorted.end(), [](const auto *a, const auto *b) { return a->second.time > b->second.time; });
+  if (sorted.size() > count) sorted.resize(count);
+
+  os << fmt::format("\n{:>12} {:>12}  {}\n", "Time (ms)", "IR insts", title);
+  for (const auto *entry : sorted) {
+    os << fmt::format("{:>12.3f} {:>12}  {}\n", ToMilliseconds(entry->second.time), entry->second.instruction_count,
+                      entry->first);
+  }
+}
+}// namespace
+
+void CompileStatistics::PrintSummary(llvm::raw_ostream &os, size_t count) const {
+  std::chrono::steady_clock::duration total{};
+  for (const Totals &phase : this->phases_) { total += phase.time; }
+
+  os << fmt::format("===== Compile statistics ({:.3f} ms) =====\n", ToMilliseconds(total));
+  os << fmt::format("{:>12} {:>12}  {}\n", "Time (ms)", "IR insts", "Phase");
+  for (size_t i = 0; i < kPhaseCount; ++i) {
+    const Totals &phase = this->phases_[i];
+    os << fmt::format("{:>12.3f} {:>12}  {}\n", ToMilliseconds(phase.time), phase.instruction_count,
+                      GetCompilePhaseName(static_cast<CompilePhase>(i)));
+  }
+  PrintSlowest(os, "Class", this->classes_, count);
+  PrintSlowest(os, "Method", this->methods_, count);
+  os.flush();
+}
+
+}// namespace magnetic
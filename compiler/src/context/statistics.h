@@ -0,0 +1,109 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <llvm/Support/TimeProfiler.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace magnetic {
+
+enum class CompilePhase {
+  kClassPathLookup,
+  kClassParsing,
+  kReachability,
+  kClassEmission,
+  kMethodCodegen,
+  kOptimization,
+};
+
+const char *GetCompilePhaseName(CompilePhase phase);
+
+/**
+ * Compile time and IR size, broken down by phase, class and method.
+ *
+ * Phases nest (loading a class emits its super class, which looks up and parses another class file), so every phase
+ * is charged only for its self time: the time spent in it minus the time spent in the phases nested inside of it. The
+ * self times of all phases add up to the total time spent compiling.
+ */
+class CompileStatistics {
+ public:
+  /**
+   * Times a phase, and also adds it to LLVM's time trace (see llvm::timeTraceProfilerInitialize) if one is being
+   * recorded.
+   */
+  class Scope {
+   public:
+    /**
+     * @param statistics can be nullptr, in which case only the time trace is recorded
+     * @param class_name the class the phase is working on, or an empty string
+     * @param method_name the method the phase is working on, or an empty string
+     */
+    Scope(CompileStatistics *statistics, CompilePhase phase, const std::string &class_name,
+          const std::string &method_name = "");
+    ~Scope() noexcept;
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+    /**
+     * Records the number of IR instructions the phase emitted (for optimization, the size of the optimized module).
+     */
+    void set_instruction_count(uint64_t count) { this->instruction_count_ = count; }
+
+   private:
+    CompileStatistics *statistics_;// Can be nullptr.
+    CompilePhase phase_;
+    std::string class_name_, method_name_;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::steady_clock::duration nested_time_;
+    uint64_t instruction_count_;
+    std::optional<llvm::TimeTraceScope> trace_;
+
+    friend class CompileStatistics;
+  };
+
+  struct Totals {
+    std::chrono::steady_clock::duration time{};
+    uint64_t instruction_count = 0;
+    /**
+     * Number of times the phase ran (e.g. the number of methods compiled, for method codegen).
+     */
+    uint64_t count = 0;
+  };
+
+  CompileStatistics() = default;
+  CompileStatistics(const CompileStatistics &) = delete;
+  CompileStatistics &operator=(const CompileStatistics &) = delete;
+
+  [[nodiscard]] const Totals &phase_totals(CompilePhase phase) const {
+    return this->phases_[static_cast<size_t>(phase)];
+  }
+
+  /**
+   * Prints the time spent in each phase, then the classes and methods that took the longest to compile.
+   * @param count how many classes and methods to list
+   */
+  void PrintSummary(llvm::raw_ostream &os, size_t count) const;
+
+ private:
+  static constexpr size_t kPhaseCount = static_cast<size_t>(CompilePhase::kOptimization) + 1;
+
+  std::array<Totals, kPhaseCount> phases_;
+  std::map<std::string, Totals> classes_;
+  std::map<std::string, Totals> methods_;
+  std::vector<Scope *> active_scopes_;
+
+  void Enter(Scope *scope);
+  void Exit(Scope *scope);
+};
+
+}// namespace magnetic
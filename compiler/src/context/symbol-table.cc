@@ -0,0 +1,23 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "symbol-table.h"
+
+namespace magnetic {
+
+const std::string *SymbolTable::Intern(std::string_view value) {
+  const std::string *symbol = this->Find(value);
+  if (symbol != nullptr) return symbol;
+
+  const std::string &interned = this->strings_.emplace_back(value);
+  this->index_.try_emplace(interned, &interned);
+  return &interned;
+}
+const std::string *SymbolTable::Find(std::string_view value) const {
+  const auto &it = this->index_.find(llvm::StringRef(value.data(), value.size()));
+  if (it == this->index_.end()) return nullptr;
+  return it->second;
+}
+
+}// namespace magnetic
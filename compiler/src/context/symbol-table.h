@@ -0,0 +1,38 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <deque>
+#include <string>
+#include <string_view>
+
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/StringRef.h>
+
+namespace magnetic {
+
+/**
+ * Interns the names and descriptors of classes, fields and methods. Declarations point to the interned copy of a
+ * string instead of keeping their own, so each distinct name is stored once however many declarations share it (every
+ * method of a class shares the class's name, and "<init>" and "()V" are shared by most classes). Interned strings are
+ * equal if and only if their addresses are, so they can be used as keys without hashing their characters.
+ */
+class SymbolTable {
+ public:
+  /**
+   * @return the interned copy of the string, which lives as long as the table
+   */
+  [[nodiscard]] const std::string *Intern(std::string_view value);
+  /**
+   * @return the interned copy of the string, or nullptr if it hasn't been interned
+   */
+  [[nodiscard]] const std::string *Find(std::string_view value) const;
+
+ private:
+  std::deque<std::string> strings_;// A deque never moves its elements, so the index's keys stay valid.
+  llvm::DenseMap<llvm::StringRef, const std::string *> index_;
+};
+
+}// namespace magnetic
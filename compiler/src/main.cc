@@ -1,27 +1,268 @@
 #include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/TimeProfiler.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Support/xxhash.h>
+
+#include "analysis/reachability.h"
 #include "class/class.h"
 #include "class/mangle.h"
 #include "class/pool/path.h"
 #include "class/pool/pool.h"
+#include "codegen/benchmark-table.h"
+#include "codegen/intrinsics.h"
 #include "codegen/runtime-abi.h"
+#include "compilation-unit/build-cache.h"
 #include "compilation-unit/compilation-unit.h"
 #include "context/context.h"
+#include "context/statistics.h"
+
+namespace {
+enum class OutputFormat { kAssembly, kObject };
+
+llvm::cl::list<std::string> class_path("cp", llvm::cl::desc("Jars to load classes from"), llvm::cl::CommaSeparated,
+                                       llvm::cl::value_desc("jar"));
+llvm::cl::list<std::string> root_classes("class", llvm::cl::desc("Classes to compile, along with everything they use"),
+                                         llvm::cl::CommaSeparated, llvm::cl::value_desc("name"));
+llvm::cl::opt<std::string> optimization_level("O", llvm::cl::desc("Optimization level (0, 1, 2, 3, s or z)"),
+                                              llvm::cl::Prefix, llvm::cl::init("2"));
+llvm::cl::opt<std::string> target_cpu("mcpu",
+                                      llvm::cl::desc("CPU to tune the output for and use the extensions of (default: "
+                                                     "the generic CPU, which runs anywhere)"),
+                                      llvm::cl::value_desc("cpu"));
+llvm::cl::opt<bool> native("native", llvm::cl::desc("Same as -mcpu=native: use every extension of this machine's CPU"));
+llvm::cl::opt<std::string> output_path("o", llvm::cl::desc("Output file"), llvm::cl::value_desc("path"),
+                                       llvm::cl::init("resources/Test.ll"));
+llvm::cl::opt<OutputFormat> output_format(
+    "filetype", llvm::cl::desc("Kind of output file"), llvm::cl::init(OutputFormat::kAssembly),
+    llvm::cl::values(clEnumValN(OutputFormat::kAssembly, "ll", "Textual LLVM IR"),
+                     clEnumValN(OutputFormat::kObject, "obj", "Native object file")));
+llvm::cl::opt<bool> benchmark_table(
+    "benchmark-table",
+    llvm::cl::desc("Emit a table of the root classes' static bench* methods for the runtime benchmark harness"));
+llvm::cl::opt<bool> allocation_profiling(
+    "allocation-profiling", llvm::cl::desc("Report sampled allocations to the runtime's allocation profiler"));
+llvm::cl::opt<bool> call_profiling(
+    "call-profiling", llvm::cl::desc("Count method entries and the receiver classes of virtual calls"));
+llvm::cl::opt<bool> frame_pointers(
+    "frame-pointers", llvm::cl::desc("Keep frame pointers, so that the runtime's sampling profiler can walk stacks"));
+llvm::cl::opt<bool> debug_info(
+    "g", llvm::cl::desc("Emit DWARF line info, and a method table that the runtime symbolizes Java frames with"));
+llvm::cl::opt<bool> tree_shake(
+    "tree-shake",
+    llvm::cl::desc("Only compile the methods that are reachable from the root classes' main (and benchmark) methods"),
+    llvm::cl::init(true));
+llvm::cl::opt<bool> lazy_method_bodies("lazy-method-bodies",
+                                        llvm::cl::desc("Only decode the bodies of methods that are compiled"),
+                                        llvm::cl::init(true));
+llvm::cl::opt<std::string> incremental_cache(
+    "incremental-cache",
+    llvm::cl::desc("Compile each class into its own object file in <dir>, only recompiling the classes affected by "
+                   "what changed since the last build, and write the list of object files to the output file"),
+    llvm::cl::value_desc("dir"));
+llvm::cl::opt<unsigned> prefetch_threads(
+    "prefetch-threads",
+    llvm::cl::desc("Number of threads that read and parse the root classes, and the classes they refer to, ahead of "
+                   "the compiler (0 loads classes only when they are needed)"),
+    llvm::cl::init(2));
+llvm::cl::opt<std::string> profile_generate("profile-generate",
+                                            llvm::cl::desc("Instrument the output to write a profile to <path>"),
+                                            llvm::cl::value_desc("path"));
+llvm::cl::opt<std::string> profile_use("profile-use",
+                                       llvm::cl::desc("Optimize the output using the merged profile at <path>"),
+                                       llvm::cl::value_desc("path"));
+llvm::cl::opt<bool> safepoint_polls("safepoint-polls",
+                                     llvm::cl::desc("Poll for safepoints at method entries and loop back edges"),
+                                     llvm::cl::init(true));
+llvm::cl::opt<std::string> time_trace("time-trace", llvm::cl::desc("Write a Chrome trace of the compilation to <path>"),
+                                      llvm::cl::value_desc("path"));
+llvm::cl::opt<unsigned> time_trace_granularity(
+    "time-trace-granularity", llvm::cl::desc("Minimum duration (in microseconds) of an event in the time trace"),
+    llvm::cl::init(500));
+llvm::cl::opt<bool> print_stats("print-stats",
+                                llvm::cl::desc("Print where compile time went, and the slowest classes and methods"));
+llvm::cl::opt<unsigned> print_stats_count("print-stats-count",
+                                          llvm::cl::desc("Number of classes and methods listed by -print-stats"),
+                                          llvm::cl::init(20));
+
+/**
+ * Finds the methods reachable from the root classes' main methods, and their benchmarks if a benchmark table is being
+ * emitted.
+ *
+ * @return false if a root class doesn't exist
+ */
+bool AnalyzeReachability(magnetic::Context &ctx) {
+  auto reachability = std::make_unique<magnetic::ReachabilityAnalysis>(&ctx);
+  for (const std::string &class_name : root_classes) {
+    magnetic::ClassInfo *class_info = ctx.pool()->Load(class_name);
+    if (class_info == nullptr) {
+      llvm::errs() << "class " << class_name << " not found\n";
+      return false;
+    }
+    for (const auto &method : class_info->bytecode()->methods()) {
+      bool is_main = (method->name() == "main") && (method->descriptor() == "([Ljava/lang/String;)V");
+      if (is_main || (benchmark_table && magnetic::IsBenchmarkMethod(*method))) {
+        reachability->AddRoot(class_info, method.get());
+      }
+    }
+  }
+  reachability->Run();
+  ctx.set_reachability(std::move(reachability));
+  return true;
+}
+
+/**
+ * Every option can change the generated code, so a build cache is only reused with the exact same command line. The
+ * target CPU is included too, since -native means a different CPU on each machine.
+ */
+uint64_t GetOptionsHash(const magnetic::Context &ctx, int argc, char **argv) {
+  std::string command_line{};
+  for (int i = 1; i < argc; ++i) {
+    command_line += argv[i];
+    command_line += '\0';
+  }
+  llvm::TargetMachine *target_machine = ctx.target_machine();
+  if (target_machine != nullptr) {
+    command_line += target_machine->getTargetCPU();
+    command_line += '\0';
+    command_line += target_machine->getTargetFeatureString();
+  }
+  return llvm::xxHash64(command_line);
+}
+
+/**
+ * Emits the object files of the classes that aren't up to date in the build cache, and writes every class's object
+ * file to the output file, one per line, as a response file for the linker.
+ *
+ * @return false if a file couldn't be written (the error is printed)
+ */
+bool EmitIncrementalBuild(magnetic::Context &ctx, llvm::OptimizationLevel level) {
+  magnetic::BuildCache *build_cache = ctx.build_cache();
+  std::error_code ec;
+  llvm::raw_fd_ostream response_file(output_path, ec);
+  if (ec) {
+    llvm::errs() << "cannot open " << output_path << ": " << ec.message() << "\n";
+    return false;
+  }
+
+  for (magnetic::ClassInfo *class_info : ctx.pool()->GetLoadedClasses()) {
+    // Classes that were only loaded to check the cache aren't part of the program.
+    if (!class_info->is_defined()) continue;
+    magnetic::CompilationUnit *unit = class_info->compilation_unit();
+    std::string object_path = build_cache->GetObjectPath(class_info->name());
+    if (!unit->is_cached()) {
+      unit->Verify();
+      unit->Optimize(level);
+      if (!unit->EmitObjectFile(object_path)) return false;
+    }
+    build_cache->AddClass(class_info, !unit->is_cached());
+    response_file << object_path << "\n";
+  }
+  return build_cache->Save();
+}
+
+magnetic::ProfileOptions GetProfileOptions() {
+  magnetic::ProfileOptions options{};
+  if (!profile_generate.empty()) {
+    options.mode = magnetic::ProfileOptions::Mode::kInstrument;
+    options.path = profile_generate;
+  } else if (!profile_use.empty()) {
+    options.mode = magnetic::ProfileOptions::Mode::kOptimize;
+    options.path = profile_use;
+  }
+  return options;
+}
+}// namespace
+
+int main(int argc, char **argv) {
+  llvm::cl::ParseCommandLineOptions(argc, argv, "magnetic-vm ahead-of-time compiler\n");
+  std::optional<llvm::OptimizationLevel> level = magnetic::ParseOptimizationLevel(optimization_level);
+  if (!level.has_value()) {
+    llvm::errs() << "unknown optimization level -O" << optimization_level << "\n";
+    return 1;
+  }
+  if (class_path.empty()) class_path.push_back("resources/test.jar");
+  if (root_classes.empty()) root_classes.push_back("io.github.lunbun.Main");
+  bool is_incremental = !incremental_cache.empty();
+  if (is_incremental && benchmark_table) {
+    llvm::errs() << "-benchmark-table cannot be used with -incremental-cache\n";
+    return 1;
+  }
+
+  llvm::InitializeNativeTarget();
+  if (!time_trace.empty()) llvm::timeTraceProfilerInitialize(time_trace_granularity, argv[0]);
 
-int main() {
   magnetic::Context ctx{};
+  ctx.set_target_machine(magnetic::CreateTargetMachine(native ? std::string("native") : target_cpu.getValue()));
   std::vector<std::unique_ptr<magnetic::ClassPath>> class_paths{};
-  class_paths.push_back(magnetic::ClassPath::CreateJarClassPath("resources/test.jar"));
-  //  class_paths.push_back(magnetic::ClassPath::CreateJarClassPath("resources/rt.jar"));
+  for (const std::string &jar : class_path) { class_paths.push_back(magnetic::ClassPath::CreateJarClassPath(jar)); }
   ctx.set_pool(
       std::make_unique<magnetic::ClassPool>(magnetic::ClassPath::CreateCompositeClassPath(std::move(class_paths))));
 
   ctx.set_name_mangler(magnetic::NameMangler::CreateJNIMangler());
   ctx.set_runtime_abi(magnetic::RuntimeABI::CreateDefaultABI());
-  ctx.set_use_single_unit(true);
-  ctx.pool()->Get("io.github.lunbun.Main");
+  ctx.set_intrinsics(magnetic::IntrinsicRegistry::CreateDefaultRegistry());
+  // Incremental builds need a compilation unit, and so an object file, per class.
+  ctx.set_use_single_unit(!is_incremental);
+  ctx.set_preinitialize_statics(true);
+  ctx.set_emit_safepoint_polls(safepoint_polls);
+  ctx.set_instrument_allocations(allocation_profiling);
+  ctx.set_count_calls(call_profiling);
+  ctx.set_emit_frame_pointers(frame_pointers);
+  ctx.set_emit_debug_info(debug_info);
+  ctx.set_lazy_method_bodies(lazy_method_bodies);
+  ctx.set_profile_options(GetProfileOptions());
+  if (prefetch_threads > 0) {
+    std::vector<std::string> first_classes(root_classes.begin(), root_classes.end());
+    ctx.pool()->StartPrefetching(first_classes, prefetch_threads);
+  }
+  if (print_stats) ctx.set_statistics(std::make_unique<magnetic::CompileStatistics>());
+  if (is_incremental) {
+    ctx.set_build_cache(magnetic::BuildCache::Open(&ctx, incremental_cache, GetOptionsHash(ctx, argc, argv)));
+  }
+  // Tree shaking is a whole-program analysis: a change to one class can change what is compiled in every other class,
+  // which would leave nothing to reuse.
+  if (tree_shake && !is_incremental) {
+    if (!AnalyzeReachability(ctx)) return 1;
+    // Reachable methods can be in any class, not just the root classes and their super classes.
+    for (magnetic::ClassInfo *class_info : ctx.reachability()->used_classes()) { class_info->EmitDefinition(); }
+  }
+  std::vector<magnetic::ClassInfo *> classes{};
+  for (const std::string &class_name : root_classes) {
+    magnetic::ClassInfo *class_info = ctx.pool()->Get(class_name);
+    if (class_info == nullptr) {
+      llvm::errs() << "class " << class_name << " not found\n";
+      return 1;
+    }
+    classes.push_back(class_info);
+  }
+  if (benchmark_table) {
+    size_t count = magnetic::EmitBenchmarkTable(ctx.global_unit()->module(), classes, "O" + optimization_level);
+    if (count == 0) llvm::errs() << "warning: no benchmarks found in the root classes\n";
+  }
+
+  if (is_incremental) {
+    if (!EmitIncrementalBuild(ctx, *level)) return 1;
+  } else {
+    ctx.global_unit()->Verify();
+    ctx.global_unit()->Optimize(*level);
+    if (output_format == OutputFormat::kObject) {
+      if (!ctx.global_unit()->EmitObjectFile(output_path)) return 1;
+    } else {
+      ctx.global_unit()->PrintModuleToFile(output_path);
+    }
+  }
 
-  ctx.global_unit()->Verify();
-  ctx.global_unit()->Optimize(llvm::OptimizationLevel::O2);
-  ctx.global_unit()->PrintModuleToFile("resources/Test.ll");
+  if (ctx.statistics() != nullptr) ctx.statistics()->PrintSummary(llvm::errs(), print_stats_count);
+  if (llvm::timeTraceProfilerEnabled()) {
+    if (llvm::Error error = llvm::timeTraceProfilerWrite(time_trace, "")) {
+      llvm::errs() << "could not write time trace: " << llvm::toString(std::move(error)) << "\n";
+    }
+    llvm::timeTraceProfilerCleanup();
+  }
 }
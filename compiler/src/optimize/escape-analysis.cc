@@ -0,0 +1,119 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "escape-analysis.h"
+
+#include <unordered_set>
+#include <vector>
+
+#include <llvm/Analysis/LoopInfo.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/IntrinsicInst.h>
+#include <llvm/IR/Metadata.h>
+
+namespace magnetic {
+
+namespace {
+// Larger objects stay on the heap so that deep recursion can't overflow the native stack.
+constexpr uint64_t kMaxStackAllocationSize = 1024;
+
+bool CallCapturesArgument(const llvm::CallBase *call, const llvm::Use &use) {
+  if (llvm::isa<llvm::MemSetInst>(call) || llvm::isa<llvm::MemTransferInst>(call)) return false;
+  if (const auto *intrinsic = llvm::dyn_cast<llvm::IntrinsicInst>(call)) {
+    if (intrinsic->isLifetimeStartOrEnd()) return false;
+  }
+  if (call->isCallee(&use)) return true;
+  return !call->doesNotCapture(call->getArgOperandNo(&use));
+}
+
+/**
+ * An object escapes if a pointer to it can outlive the current invocation of its allocating function (it is stored
+ * somewhere, returned, or passed to a call that might keep it).
+ *
+ * Allocations inside of loops reuse the same stack slot on every iteration, so there a pointer must also not flow into
+ * a phi or select, where it could meet the object allocated by an earlier iteration.
+ */
+bool DoesObjectEscape(llvm::Instruction *allocation, bool is_in_loop) {
+  std::vector<llvm::Value *> worklist{allocation};
+  std::unordered_set<llvm::Value *> visited{allocation};
+  while (!worklist.empty()) {
+    llvm::Value *ptr = worklist.back();
+    worklist.pop_back();
+
+    for (const llvm::Use &use : ptr->uses()) {
+      auto *user = llvm::cast<llvm::Instruction>(use.getUser());
+      bool follow_result = false;
+      if (llvm::isa<llvm::LoadInst>(user) || llvm::isa<llvm::ICmpInst>(user)) {
+        // Reading from the object or comparing its address doesn't leak the pointer.
+      } else if (auto *store = llvm::dyn_cast<llvm::StoreInst>(user)) {
+        if (store->getValueOperand() == ptr) return true;
+      } else if (llvm::isa<llvm::GetElementPtrInst>(user) || llvm::isa<llvm::BitCastInst>(user)) {
+        follow_result = true;
+      } else if (llvm::isa<llvm::PHINode>(user) || llvm::isa<llvm::SelectInst>(user)) {
+        if (is_in_loop) return true;
+        follow_result = true;
+      } else if (auto *call = llvm::dyn_cast<llvm::CallBase>(user)) {
+        if (CallCapturesArgument(call, use)) return true;
+      } else {
+        return true;
+      }
+
+      if (follow_result && visited.insert(user).second) worklist.push_back(user);
+    }
+  }
+  return false;
+}
+
+llvm::StructType *GetAllocatedStructType(llvm::CallBase *call) {
+  llvm::MDNode *node = call->getMetadata(kObjectAllocationMetadata);
+  if (node == nullptr || node->getNumOperands() != 1) return nullptr;
+  auto *type_marker = llvm::dyn_cast<llvm::ConstantAsMetadata>(node->getOperand(0));
+  if (type_marker == nullptr) return nullptr;
+  return llvm::dyn_cast<llvm::StructType>(type_marker->getValue()->getType());
+}
+}// namespace
+
+llvm::PreservedAnalyses StackAllocationPass::run(llvm::Function &function, llvm::FunctionAnalysisManager &analysis) {
+  const llvm::DataLayout &data_layout = function.getParent()->getDataLayout();
+  llvm::LoopInfo &loops = analysis.getResult<llvm::LoopAnalysis>(function);
+
+  std::vector<std::pair<llvm::CallBase *, llvm::StructType *>> candidates{};
+  for (llvm::BasicBlock &block : function) {
+    for (llvm::Instruction &inst : block) {
+      auto *call = llvm::dyn_cast<llvm::CallBase>(&inst);
+      if (call == nullptr) continue;
+      llvm::StructType *struct_type = GetAllocatedStructType(call);
+      if (struct_type == nullptr || !struct_type->isSized()) continue;
+      if (data_layout.getTypeAllocSize(struct_type) > kMaxStackAllocationSize) continue;
+      candidates.emplace_back(call, struct_type);
+    }
+  }
+
+  bool changed = false;
+  llvm::IRBuilder<> builder(function.getContext());
+  for (const auto &[call, struct_type] : candidates) {
+    if (DoesObjectEscape(call, loops.getLoopFor(call->getParent()) != nullptr)) continue;
+
+    // Allocas go in the entry block so that they are static allocations, which SROA and mem2reg can promote.
+    builder.SetInsertPoint(&function.getEntryBlock(), function.getEntryBlock().getFirstInsertionPt());
+    llvm::AllocaInst *object = builder.CreateAlloca(struct_type, nullptr, "stack_object");
+    object->setAlignment(data_layout.getABITypeAlign(struct_type));
+
+    // The heap allocation returned zeroed memory; the stack slot has to be cleared every time the allocation runs.
+    builder.SetInsertPoint(call);
+    builder.CreateMemSet(object, builder.getInt8(0), data_layout.getTypeAllocSize(struct_type), object->getAlign());
+    call->replaceAllUsesWith(object);
+    call->eraseFromParent();
+    changed = true;
+  }
+
+  if (!changed) return llvm::PreservedAnalyses::all();
+  llvm::PreservedAnalyses preserved;
+  preserved.preserveSet<llvm::CFGAnalyses>();
+  return preserved;
+}
+
+}// namespace magnetic
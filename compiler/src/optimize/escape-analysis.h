@@ -0,0 +1,29 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <llvm/IR/Function.h>
+#include <llvm/IR/PassManager.h>
+
+namespace magnetic {
+
+/**
+ * Metadata attached to the allocation call inside of each class instantiator. The operand is an undef value of the
+ * class's struct type, so that the allocation's layout is still known after the instantiator has been inlined.
+ */
+constexpr const char *kObjectAllocationMetadata = "magnetic.new";
+
+/**
+ * Replaces heap allocations of objects that never escape the function they are allocated in with stack allocations.
+ *
+ * Runs after instantiators have been inlined into their callers. The stack allocations are then broken up into SSA
+ * values by SROA wherever every access to the object is at a known field.
+ */
+class StackAllocationPass : public llvm::PassInfoMixin<StackAllocationPass> {
+ public:
+  llvm::PreservedAnalyses run(llvm::Function &function, llvm::FunctionAnalysisManager &analysis);
+};
+
+}// namespace magnetic
@@ -0,0 +1,102 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "function-layout.h"
+
+#include <array>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <llvm/Analysis/ProfileSummaryInfo.h>
+#include <llvm/IR/Instructions.h>
+
+namespace magnetic {
+
+namespace {
+enum Temperature { kHot, kWarm, kCold, kTemperatureCount };
+
+Temperature GetTemperature(const llvm::Function &function, const llvm::ProfileSummaryInfo &profile) {
+  // Without a profile summary, ProfileSummaryInfo only looks at the cold attribute, so check the hot attribute here.
+  if (profile.isFunctionEntryCold(&function)) return kCold;
+  if (profile.isFunctionEntryHot(&function) || function.hasFnAttribute(llvm::Attribute::Hot)) return kHot;
+  return kWarm;
+}
+
+std::vector<llvm::Function *> GetDirectCallees(llvm::Function *function) {
+  std::vector<llvm::Function *> callees{};
+  for (llvm::BasicBlock &block : *function) {
+    for (llvm::Instruction &inst : block) {
+      auto *call = llvm::dyn_cast<llvm::CallBase>(&inst);
+      if (call == nullptr || call->getCalledFunction() == nullptr) continue;
+      if (call->getCalledFunction()->isDeclaration()) continue;
+      callees.push_back(call->getCalledFunction());
+    }
+  }
+  return callees;
+}
+
+class FunctionOrder {
+ public:
+  explicit FunctionOrder(const std::unordered_map<llvm::Function *, Temperature> &temperatures)
+      : temperatures_(temperatures), visited_() {}
+
+  /**
+   * Appends the function, then (depth first) every function of the same temperature that it calls directly.
+   */
+  void Visit(llvm::Function *root, std::vector<llvm::Function *> &order) {
+    Temperature temperature = this->temperatures_.at(root);
+    std::vector<llvm::Function *> stack{root};
+    while (!stack.empty()) {
+      llvm::Function *function = stack.back();
+      stack.pop_back();
+      if (!this->visited_.insert(function).second) continue;
+      order.push_back(function);
+
+      // Push in reverse so that callees are laid out in the order that they are called.
+      std::vector<llvm::Function *> callees = GetDirectCallees(function);
+      for (auto it = callees.rbegin(); it != callees.rend(); ++it) {
+        if (this->visited_.count(*it) != 0 || this->temperatures_.at(*it) != temperature) continue;
+        stack.push_back(*it);
+      }
+    }
+  }
+
+ private:
+  const std::unordered_map<llvm::Function *, Temperature> &temperatures_;
+  std::unordered_set<llvm::Function *> visited_;
+};
+}// namespace
+
+llvm::PreservedAnalyses FunctionLayoutPass::run(llvm::Module &module, llvm::ModuleAnalysisManager &analysis) {
+  const llvm::ProfileSummaryInfo &profile = analysis.getResult<llvm::ProfileSummaryAnalysis>(module);
+
+  std::unordered_map<llvm::Function *, Temperature> temperatures{};
+  std::array<std::vector<llvm::Function *>, kTemperatureCount> roots{};
+  for (llvm::Function &function : module) {
+    if (function.isDeclaration()) continue;
+    Temperature temperature = GetTemperature(function, profile);
+    temperatures.emplace(&function, temperature);
+    roots[temperature].push_back(&function);
+
+    if (temperature == kHot) function.setSectionPrefix("hot");
+    if (temperature == kCold) function.setSectionPrefix("unlikely");
+  }
+
+  std::vector<llvm::Function *> order{};
+  order.reserve(temperatures.size());
+  FunctionOrder function_order(temperatures);
+  for (const auto &group : roots) {
+    for (llvm::Function *root : group) { function_order.Visit(root, order); }
+  }
+
+  // Functions are emitted in the order they appear in the module.
+  for (llvm::Function *function : order) {
+    function->removeFromParent();
+    module.getFunctionList().push_back(function);
+  }
+  return llvm::PreservedAnalyses::all();
+}
+
+}// namespace magnetic
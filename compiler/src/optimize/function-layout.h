@@ -0,0 +1,25 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <llvm/IR/Module.h>
+#include <llvm/IR/PassManager.h>
+
+namespace magnetic {
+
+/**
+ * Orders the functions of a module so that code that runs together is placed together.
+ *
+ * Functions are split into hot, warm and cold groups, using profile counts when the module has them and function
+ * attributes otherwise (virtual dispatch thunks and instantiators are hot, static initializers and outlined cold
+ * blocks are cold). Hot functions are put in .text.hot and cold functions in .text.unlikely. Within a group, every
+ * function is followed by the callees it calls directly, so that call chains share pages.
+ */
+class FunctionLayoutPass : public llvm::PassInfoMixin<FunctionLayoutPass> {
+ public:
+  llvm::PreservedAnalyses run(llvm::Module &module, llvm::ModuleAnalysisManager &analysis);
+};
+
+}// namespace magnetic
@@ -0,0 +1,93 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "safepoint-elimination.h"
+
+#include <cstdint>
+#include <vector>
+
+#include <llvm/Analysis/LoopInfo.h>
+#include <llvm/Analysis/ScalarEvolution.h>
+#include <llvm/Analysis/ScalarEvolutionExpressions.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/IntrinsicInst.h>
+
+namespace magnetic {
+
+namespace {
+/**
+ * Loops that may run more iterations than this keep their polls, so that a long loop can't hold up a safepoint. The
+ * same bound as HotSpot's loop strip mining.
+ */
+constexpr uint64_t kMaxUnpolledTripCount = 1000;
+
+bool IsSafepointPoll(const llvm::Instruction &inst) {
+  return llvm::isa<llvm::LoadInst>(inst) && inst.getMetadata(kSafepointPollMetadata) != nullptr;
+}
+
+/**
+ * A call may run for an unbounded amount of time, but the callee polls on entry and in its own loops.
+ */
+bool MayRunIndefinitely(const llvm::Instruction &inst) {
+  const auto *call = llvm::dyn_cast<llvm::CallBase>(&inst);
+  if (call == nullptr) return false;
+  return !llvm::isa<llvm::IntrinsicInst>(call);
+}
+
+void CollectPollsInShortLoops(llvm::LoopInfo &loops, llvm::ScalarEvolution &scalar_evolution,
+                                std::vector<llvm::Instruction *> &polls) {
+  for (llvm::Loop *loop : loops.getLoopsInPreorder()) {
+    if (!loop->isInnermost()) continue;
+    // The maximum is known even when the exact trip count depends on the loop's inputs, but for a loop like
+    // "for (int i = 0; i < n; i++)" it is only bounded by the range of the induction variable, which is far too many
+    // iterations to go without polling.
+    const auto *max_backedge_count =
+        llvm::dyn_cast<llvm::SCEVConstant>(scalar_evolution.getConstantMaxBackedgeTakenCount(loop));
+    if (max_backedge_count == nullptr || max_backedge_count->getAPInt().uge(kMaxUnpolledTripCount)) continue;
+
+    for (llvm::BasicBlock *block : loop->blocks()) {
+      for (llvm::Instruction &inst : *block) {
+        if (IsSafepointPoll(inst)) polls.push_back(&inst);
+      }
+    }
+  }
+}
+
+void CollectRedundantPolls(llvm::Function &function, std::vector<llvm::Instruction *> &polls) {
+  for (llvm::BasicBlock &block : function) {
+    bool has_polled = false;
+    for (llvm::Instruction &inst : block) {
+      if (MayRunIndefinitely(inst)) {
+        has_polled = false;
+      } else if (IsSafepointPoll(inst)) {
+        if (has_polled) polls.push_back(&inst);
+        has_polled = true;
+      }
+    }
+  }
+}
+}// namespace
+
+llvm::PreservedAnalyses SafepointEliminationPass::run(llvm::Function &function,
+                                                      llvm::FunctionAnalysisManager &analysis) {
+  llvm::LoopInfo &loops = analysis.getResult<llvm::LoopAnalysis>(function);
+  llvm::ScalarEvolution &scalar_evolution = analysis.getResult<llvm::ScalarEvolutionAnalysis>(function);
+
+  // Polls in short loops are erased before looking for redundant polls, so that no poll is erased twice.
+  std::vector<llvm::Instruction *> polls{};
+  CollectPollsInShortLoops(loops, scalar_evolution, polls);
+  for (llvm::Instruction *poll : polls) { poll->eraseFromParent(); }
+  bool changed = !polls.empty();
+  polls.clear();
+  CollectRedundantPolls(function, polls);
+  for (llvm::Instruction *poll : polls) { poll->eraseFromParent(); }
+  changed |= !polls.empty();
+
+  if (!changed) return llvm::PreservedAnalyses::all();
+  llvm::PreservedAnalyses preserved;
+  preserved.preserveSet<llvm::CFGAnalyses>();
+  return preserved;
+}
+
+}// namespace magnetic
@@ -0,0 +1,31 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <llvm/IR/Function.h>
+#include <llvm/IR/PassManager.h>
+
+namespace magnetic {
+
+/**
+ * Metadata attached to every safepoint poll (a volatile load from the runtime's safepoint page), so that optimizations
+ * can recognize them.
+ */
+constexpr const char *kSafepointPollMetadata = "magnetic.safepoint";
+
+/**
+ * Removes safepoint polls where they aren't needed to bound the time between polls:
+ *  - in innermost loops that are known to run only a few iterations (the poll after the loop, or in the enclosing loop,
+ *    is reached soon enough);
+ *  - after another poll in the same block, with no call in between.
+ *
+ * Must run before the loop vectorizer, which can't vectorize loops containing volatile loads.
+ */
+class SafepointEliminationPass : public llvm::PassInfoMixin<SafepointEliminationPass> {
+ public:
+  llvm::PreservedAnalyses run(llvm::Function &function, llvm::FunctionAnalysisManager &analysis);
+};
+
+}// namespace magnetic
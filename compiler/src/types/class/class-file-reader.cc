@@ -0,0 +1,81 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "class-file-reader.h"
+
+#include <fmt/core.h>
+
+#include "context/exception.h"
+
+namespace magnetic {
+
+void ClassFileReader::ReadConstPool() {
+  uint16_t count = this->ReadU2();
+  for (uint16_t i = 1; i < count; ++i) {
+    uint8_t tag = this->ReadU1();
+    switch (tag) {
+      case 1: {// Utf8
+        uint16_t length = this->ReadU2();
+        this->Require(length);
+        const char *begin = reinterpret_cast<const char *>(this->data_.data() + this->position_);
+        this->utf8_constants_.emplace(i, std::string(begin, length));
+        this->position_ += length;
+        break;
+      }
+      case 3:// Integer
+      case 4:// Float
+      case 9:// Fieldref
+      case 10:// Methodref
+      case 11:// InterfaceMethodref
+      case 12:// NameAndType
+      case 17:// Dynamic
+      case 18:// InvokeDynamic
+        this->Skip(4);
+        break;
+      case 5:// Long
+      case 6:// Double
+        // 8-byte constants take up two entries.
+        this->Skip(8);
+        ++i;
+        break;
+      case 7:// Class
+      case 8:// String
+      case 16:// MethodType
+      case 19:// Module
+      case 20:// Package
+        this->Skip(2);
+        break;
+      case 15:// MethodHandle
+        this->Skip(3);
+        break;
+      default: throw BadBytecode(fmt::format("unknown constant pool tag {}", tag));
+    }
+  }
+}
+
+void ClassFileReader::SkipFields() {
+  uint16_t field_count = this->ReadU2();
+  for (uint16_t i = 0; i < field_count; ++i) {
+    this->Skip(6);// access_flags, name_index, descriptor_index
+    uint16_t attribute_count = this->ReadU2();
+    for (uint16_t j = 0; j < attribute_count; ++j) {
+      this->Skip(2);
+      this->Skip(this->ReadU4());
+    }
+  }
+}
+
+const std::string &ClassFileReader::GetUtf8(uint16_t index) const {
+  const auto &it = this->utf8_constants_.find(index);
+  if (it == this->utf8_constants_.end()) {
+    throw BadBytecode(fmt::format("constant pool entry {} is not a UTF-8 constant", index));
+  }
+  return it->second;
+}
+
+void ClassFileReader::Require(size_t count) const {
+  if (this->data_.size() - this->position_ < count) throw BadBytecode("truncated class file");
+}
+
+}// namespace magnetic
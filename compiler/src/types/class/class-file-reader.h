@@ -0,0 +1,66 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace magnetic {
+
+/**
+ * Reads the raw structure of a class file, for the parts of it that cjbp doesn't expose. Only the UTF-8 constants are
+ * kept from the constant pool (attribute names, method names and descriptors refer to them).
+ *
+ * Every read throws BadBytecode if the class file is truncated.
+ */
+class ClassFileReader {
+ public:
+  explicit ClassFileReader(const std::vector<uint8_t> &data) : data_(data), position_(0), utf8_constants_() {}
+
+  uint8_t ReadU1() {
+    this->Require(1);
+    return this->data_[this->position_++];
+  }
+  uint16_t ReadU2() {
+    this->Require(2);
+    uint16_t value = (this->data_[this->position_] << 8) | this->data_[this->position_ + 1];
+    this->position_ += 2;
+    return value;
+  }
+  uint32_t ReadU4() {
+    uint32_t high = this->ReadU2();
+    return (high << 16) | this->ReadU2();
+  }
+  void Skip(size_t count) {
+    this->Require(count);
+    this->position_ += count;
+  }
+
+  /**
+   * Reads the constant pool count and the constant pool.
+   */
+  void ReadConstPool();
+  /**
+   * Skips the fields count and the fields.
+   */
+  void SkipFields();
+
+  [[nodiscard]] const std::string &GetUtf8(uint16_t index) const;
+
+  [[nodiscard]] const std::vector<uint8_t> &data() const { return this->data_; }
+  [[nodiscard]] size_t position() const { return this->position_; }
+
+ private:
+  const std::vector<uint8_t> &data_;
+  size_t position_;
+  std::unordered_map<uint16_t, std::string> utf8_constants_;
+
+  void Require(size_t count) const;
+};
+
+}// namespace magnetic
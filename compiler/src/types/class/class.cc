@@ -13,12 +13,18 @@
 #include <fmt/core.h>
 #include <llvm/IR/Module.h>
 
+#include "codegen/call-profile.h"
+#include "compilation-unit/build-cache.h"
 #include "compilation-unit/compilation-unit.h"
 #include "context/context.h"
 #include "context/exception.h"
+#include "context/statistics.h"
+#include "debug-attributes.h"
 #include "field.h"
 #include "instantiate.h"
 #include "method.h"
+#include "method-bodies.h"
+#include "static-init.h"
 #include "types/mangle.h"
 #include "types/pool/pool.h"
 
@@ -27,39 +33,68 @@ namespace magnetic {
 ClassInfo::ClassInfo(Context *ctx, std::unique_ptr<cjbp::Class> bytecode,
                      std::shared_ptr<CompilationUnit> compilation_unit)
     : ctx_(ctx), bytecode_(std::move(bytecode)), struct_type_(nullptr), super_class_(nullptr), vtable_(std::nullopt),
-      super_class_layout_(std::nullopt) {
+      monitor_(std::nullopt), super_class_layout_(std::nullopt), is_defined_(false),
+      content_hash_(0), is_preinitialized_(false), debug_attributes_(nullptr), method_bodies_(nullptr) {
   this->struct_type_ = llvm::StructType::create(*this->ctx_->llvm_ctx(), this->name());
   this->compilation_unit_ = std::move(compilation_unit);
 }
 ClassInfo::~ClassInfo() noexcept = default;
+void ClassInfo::set_debug_attributes(std::unique_ptr<ClassDebugAttributes> debug_attributes) {
+  this->debug_attributes_ = std::move(debug_attributes);
+}
+void ClassInfo::set_method_bodies(std::unique_ptr<LazyMethodBodies> method_bodies) {
+  this->method_bodies_ = std::move(method_bodies);
+}
+cjbp::Method *ClassInfo::GetMethodBody(cjbp::Method *method) {
+  if (this->method_bodies_ == nullptr) return method;
+
+  CompileStatistics::Scope scope(this->ctx_->statistics(), CompilePhase::kClassParsing, this->name());
+  cjbp::Method *body = this->method_bodies_->Decode(method->name(), method->descriptor());
+  return (body != nullptr) ? body : method;
+}
 const std::string &ClassInfo::name() const { return this->bytecode_->name(); }
 const VTable &ClassInfo::vtable() const {
   assert(this->vtable_.has_value());
   return this->vtable_.value();
 }
+const Monitor &ClassInfo::monitor() const {
+  assert(this->monitor_.has_value());
+  return this->monitor_.value();
+}
 bool ClassInfo::is_final() const { return (this->bytecode_->access_flags() & cjbp::AccessFlags::kFinal); }
 
 void ClassInfo::EmitDefinition() {
+  if (this->is_defined_) return;
+  this->is_defined_ = true;
+  BuildCache *build_cache = this->ctx_->build_cache();
+  if (build_cache != nullptr) this->compilation_unit_->set_cached(build_cache->IsUpToDate(this));
+  CompileStatistics::Scope scope(this->ctx_->statistics(), CompilePhase::kClassEmission, this->name());
+
   std::vector<StructElementLayoutSpecifier *> element_layout{};
   std::vector<FieldDeclaration *> owned_fields{};
   owned_fields.reserve(this->bytecode_->fields().size());
   std::vector<MethodDeclaration *> owned_methods{};
   owned_methods.reserve(this->bytecode_->methods().size());
+  MethodDeclaration *static_initializer = nullptr;
 
   if (this->bytecode_->super_class() == nullptr) {
     // java.lang.Object doesn't have a super class.
     this->super_class_ = nullptr;
     this->super_class_layout_ = std::nullopt;
     this->vtable_ = VTable::CreateVTableForBaseClass(this->ctx_, this->name());
+    this->monitor_ = Monitor::CreateMonitorForBaseClass(this->ctx_);
     element_layout.push_back(&this->vtable_->layout());
+    element_layout.push_back(&this->monitor_->layout());
   } else {
     this->super_class_ = this->ctx_->pool()->Get(*this->bytecode_->super_class());
     if (this->super_class_ == nullptr) {
       throw BadBytecode(
           fmt::format("could not find {}'s super class {}", this->name(), *this->bytecode_->super_class()));
     }
+    this->ctx_->RecordDependency(this->name(), this->super_class_->name(), DependencyKind::kSuperClass);
     this->super_class_layout_ = StructElementLayoutSpecifier(this->super_class_->struct_type_);
     this->vtable_ = VTable::CreateVTableForSubClass(this->super_class_->vtable_.value(), this->name());
+    this->monitor_ = Monitor::CreateMonitorForSubClass(this->super_class_->monitor_.value());
     element_layout.push_back(&this->super_class_layout_.value());
   }
 
@@ -81,16 +116,60 @@ void ClassInfo::EmitDefinition() {
     method->set_owner(this);
     owned_methods.push_back(method);
     this->vtable_->MaybeAddVirtualMethod(method);
+    if (method_bytecode->name() == "<clinit>") {
+      static_initializer = method;
+      if (this->ctx_->preinitialize_statics() && !this->compilation_unit_->is_cached()) {
+        this->is_preinitialized_ = this->PreinitializeStaticFields(this->GetMethodBody(method_bytecode.get()));
+      }
+    }
   }
 
   llvm::Module *module = this->compilation_unit_->module();
   this->vtable_->EmitDefinition(module);
+  CallProfileEmitter *call_profile = this->compilation_unit_->call_profile();
+  // A class that shares its super class's vtable is profiled as its super class.
+  if (call_profile != nullptr && !this->vtable_->is_shared()) {
+    call_profile->AddVTable(this->vtable_->global(), this->name());
+  }
   for (FieldDeclaration *field : owned_fields) { field->EmitDefinition(module); }
-  for (MethodDeclaration *method : owned_methods) { method->EmitDefinition(module); }
+  for (MethodDeclaration *method : owned_methods) {
+    // A pre-executed static initializer's effects are already baked into the static fields.
+    if (this->is_preinitialized_ && method == static_initializer) continue;
+    if (!method->IsReachable()) continue;
+    // The class's cached object file already has the method's code.
+    if (this->compilation_unit_->is_cached()) continue;
+    method->EmitDefinition(module);
+  }
 
   ClassInstantiator *instantiator = this->ctx_->GetInstantiator(this->name());
   instantiator->set_owner(this);
   instantiator->EmitDefinition(module);
+
+  // The classes that only a cached class's code uses are never found by compiling it, so they are found through the
+  // dependencies that were recorded when it was compiled.
+  if (this->compilation_unit_->is_cached()) {
+    for (const auto &[dependency, kind] : build_cache->GetCachedDependencies(this->name())) {
+      this->ctx_->pool()->Get(dependency);
+    }
+  }
+}
+
+bool ClassInfo::PreinitializeStaticFields(cjbp::Method *initializer) {
+  std::optional<StaticFieldImage> image = EvaluateStaticInitializer(this, initializer);
+  if (!image.has_value()) return false;
+
+  for (const auto &field_bytecode : this->bytecode_->fields()) {
+    if (!(field_bytecode->access_flags() & cjbp::AccessFlags::kStatic)) continue;
+    FieldDeclaration *field =
+        this->ctx_->GetField(this->name(), field_bytecode->name(), field_bytecode->descriptor(), true);
+    const auto &it = image->find(field);
+    if (it == image->end()) continue;
+
+    // Static final fields can only be assigned by the initializer, so they are never written to again.
+    bool is_read_only = (field_bytecode->access_flags() & cjbp::AccessFlags::kFinal);
+    field->set_initial_value(it->second, is_read_only);
+  }
+  return true;
 }
 
 bool ClassInfo::IsSubClassOf(const ClassInfo *other) const {
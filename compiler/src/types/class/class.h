@@ -14,12 +14,15 @@
 #include <llvm/IR/Value.h>
 
 #include "layout.h"
+#include "monitor.h"
 #include "vtable.h"
 
 namespace magnetic {
 
+class ClassDebugAttributes;
 class CompilationUnit;
 class FieldDeclaration;
+class LazyMethodBodies;
 class MethodDeclaration;
 
 class ClassInfo {
@@ -31,6 +34,10 @@ class ClassInfo {
   ClassInfo &operator=(ClassInfo &&) = default;
   ~ClassInfo() noexcept;
 
+  /**
+   * Emits the class's struct type, vtable, fields, methods and instantiator. Does nothing if they have already been
+   * emitted.
+   */
   void EmitDefinition();
 
   [[nodiscard]] bool IsSubClassOf(const ClassInfo *other) const;
@@ -45,7 +52,33 @@ class ClassInfo {
   [[nodiscard]] llvm::StructType *struct_type() const { return this->struct_type_; }
   [[nodiscard]] ClassInfo *super_class() const { return this->super_class_; }
   [[nodiscard]] const VTable &vtable() const;
+  [[nodiscard]] const Monitor &monitor() const;
   [[nodiscard]] bool is_final() const;
+  /**
+   * @return true if the static initializer was run at compile time, so it must not be run again at startup.
+   */
+  [[nodiscard]] bool is_preinitialized() const { return this->is_preinitialized_; }
+  /**
+   * @return true once EmitDefinition has been called
+   */
+  [[nodiscard]] bool is_defined() const { return this->is_defined_; }
+  /**
+   * @return a hash of the class file that the class was loaded from
+   */
+  [[nodiscard]] uint64_t content_hash() const { return this->content_hash_; }
+  void set_content_hash(uint64_t content_hash) { this->content_hash_ = content_hash; }
+  /**
+   * @return the class file's line numbers and source file, or nullptr if debug info isn't being emitted
+   */
+  [[nodiscard]] const ClassDebugAttributes *debug_attributes() const { return this->debug_attributes_.get(); }
+  void set_debug_attributes(std::unique_ptr<ClassDebugAttributes> debug_attributes);
+  void set_method_bodies(std::unique_ptr<LazyMethodBodies> method_bodies);
+
+  /**
+   * @return the method, with its code. If the class's method bodies are decoded lazily, the methods in bytecode() have
+   *         no code, and the method's body is decoded here the first time that it is asked for.
+   */
+  [[nodiscard]] cjbp::Method *GetMethodBody(cjbp::Method *method);
 
  private:
   Context *ctx_;
@@ -55,9 +88,16 @@ class ClassInfo {
 
   ClassInfo *super_class_;// Can be nullptr.
   std::optional<VTable> vtable_;
+  std::optional<Monitor> monitor_;
   std::optional<StructElementLayoutSpecifier> super_class_layout_;
+  bool is_defined_;
+  uint64_t content_hash_;
+  bool is_preinitialized_;
+  std::unique_ptr<ClassDebugAttributes> debug_attributes_;// Can be nullptr.
+  std::unique_ptr<LazyMethodBodies> method_bodies_;       // nullptr unless method bodies are decoded lazily.
 
   [[nodiscard]] std::optional<ssize_t> GetCastOffset(const ClassInfo *dest) const;
+  [[nodiscard]] bool PreinitializeStaticFields(cjbp::Method *initializer);
 };
 
 }// namespace magnetic
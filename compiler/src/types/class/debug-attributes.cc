@@ -0,0 +1,103 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "debug-attributes.h"
+
+#include <algorithm>
+
+#include "class-file-reader.h"
+#include "context/exception.h"
+
+namespace magnetic {
+
+LineNumberTable::LineNumberTable(std::vector<Entry> entries) : entries_(std::move(entries)) {
+  std::stable_sort(this->entries_.begin(), this->entries_.end(),
+                   [](const Entry &lhs, const Entry &rhs) { return lhs.start_pc < rhs.start_pc; });
+}
+
+uint32_t LineNumberTable::GetLine(uint32_t pc) const {
+  auto it = std::upper_bound(this->entries_.begin(), this->entries_.end(), pc,
+                             [](uint32_t pc, const Entry &entry) { return pc < entry.start_pc; });
+  if (it == this->entries_.begin()) return 0;
+  return std::prev(it)->line;
+}
+uint32_t LineNumberTable::first_line() const { return this->entries_.empty() ? 0 : this->entries_.front().line; }
+
+namespace {
+std::vector<LineNumberTable::Entry> ReadCodeLineNumbers(ClassFileReader &reader) {
+  reader.Skip(4);// max_stack, max_locals
+  reader.Skip(reader.ReadU4());// code
+  reader.Skip(reader.ReadU2() * 8);// exception_table
+
+  std::vector<LineNumberTable::Entry> entries{};
+  uint16_t attribute_count = reader.ReadU2();
+  for (uint16_t i = 0; i < attribute_count; ++i) {
+    const std::string &name = reader.GetUtf8(reader.ReadU2());
+    uint32_t length = reader.ReadU4();
+    if (name != "LineNumberTable") {
+      reader.Skip(length);
+      continue;
+    }
+    // A method can have several LineNumberTables; together they make up the method's table.
+    uint16_t entry_count = reader.ReadU2();
+    for (uint16_t j = 0; j < entry_count; ++j) {
+      uint16_t start_pc = reader.ReadU2();
+      entries.push_back({start_pc, reader.ReadU2()});
+    }
+  }
+  return entries;
+}
+}// namespace
+
+ClassDebugAttributes ClassDebugAttributes::Read(const std::vector<uint8_t> &class_file) {
+  ClassDebugAttributes attributes{};
+  ClassFileReader reader(class_file);
+  if (reader.ReadU4() != 0xCAFEBABE) throw BadBytecode("bad class file magic");
+  reader.Skip(4);// minor_version, major_version
+  reader.ReadConstPool();
+  reader.Skip(6);// access_flags, this_class, super_class
+  reader.Skip(reader.ReadU2() * 2);// interfaces
+  reader.SkipFields();
+
+  uint16_t method_count = reader.ReadU2();
+  for (uint16_t i = 0; i < method_count; ++i) {
+    reader.Skip(2);// access_flags
+    const std::string &name = reader.GetUtf8(reader.ReadU2());
+    const std::string &descriptor = reader.GetUtf8(reader.ReadU2());
+    uint16_t attribute_count = reader.ReadU2();
+    for (uint16_t j = 0; j < attribute_count; ++j) {
+      const std::string &attribute_name = reader.GetUtf8(reader.ReadU2());
+      uint32_t length = reader.ReadU4();
+      if (attribute_name != "Code") {
+        reader.Skip(length);
+        continue;
+      }
+      std::vector<LineNumberTable::Entry> entries = ReadCodeLineNumbers(reader);
+      if (!entries.empty()) {
+        attributes.line_numbers_.emplace(std::make_pair(name, descriptor), LineNumberTable(std::move(entries)));
+      }
+    }
+  }
+
+  uint16_t attribute_count = reader.ReadU2();
+  for (uint16_t i = 0; i < attribute_count; ++i) {
+    const std::string &name = reader.GetUtf8(reader.ReadU2());
+    uint32_t length = reader.ReadU4();
+    if (name == "SourceFile") {
+      attributes.source_file_ = reader.GetUtf8(reader.ReadU2());
+    } else {
+      reader.Skip(length);
+    }
+  }
+  return attributes;
+}
+
+const LineNumberTable *ClassDebugAttributes::FindLineNumbers(const std::string &name,
+                                                             const std::string &descriptor) const {
+  const auto &it = this->line_numbers_.find(std::make_pair(name, descriptor));
+  if (it == this->line_numbers_.end()) return nullptr;
+  return &it->second;
+}
+
+}// namespace magnetic
@@ -0,0 +1,66 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace magnetic {
+
+/**
+ * Maps bytecode offsets of a method to source lines.
+ */
+class LineNumberTable {
+ public:
+  struct Entry {
+    uint16_t start_pc;
+    uint16_t line;
+  };
+
+  explicit LineNumberTable(std::vector<Entry> entries);
+
+  /**
+   * @return the line of the instruction at the bytecode offset, or 0 if the offset comes before the first entry
+   */
+  [[nodiscard]] uint32_t GetLine(uint32_t pc) const;
+  /**
+   * @return the line of the method's first instruction, or 0 if the table is empty
+   */
+  [[nodiscard]] uint32_t first_line() const;
+
+ private:
+  std::vector<Entry> entries_;// Sorted by start_pc.
+};
+
+/**
+ * The debugging attributes of a class file (SourceFile and LineNumberTable), which cjbp doesn't expose.
+ */
+class ClassDebugAttributes {
+ public:
+  /**
+   * Reads the debugging attributes from a class file.
+   * @throws BadBytecode if the class file is truncated or malformed
+   */
+  static ClassDebugAttributes Read(const std::vector<uint8_t> &class_file);
+
+  /**
+   * @return nullptr if the method doesn't exist, or was compiled without line numbers (javac -g:none)
+   */
+  [[nodiscard]] const LineNumberTable *FindLineNumbers(const std::string &name, const std::string &descriptor) const;
+
+  /**
+   * @return the source file name without its directory (e.g. "Main.java"), or an empty string if it is unknown
+   */
+  [[nodiscard]] const std::string &source_file() const { return this->source_file_; }
+
+ private:
+  std::string source_file_;
+  std::map<std::pair<std::string, std::string>, LineNumberTable> line_numbers_;
+};
+
+}// namespace magnetic
@@ -18,23 +18,29 @@
 
 namespace magnetic {
 
-FieldDeclaration::FieldDeclaration(Context *ctx, const std::string &descriptor) : ctx_(ctx) {
-  this->descriptor_ = ParseTypeDescriptor(ctx, descriptor, false);
+FieldDeclaration::FieldDeclaration(Context *ctx, const std::string *class_name, const std::string *name,
+                                   const std::string *descriptor)
+    : ctx_(ctx), class_name_(class_name), name_(name), raw_descriptor_(descriptor), initial_value_(nullptr),
+      is_read_only_(false) {
+  this->descriptor_ = ParseTypeDescriptor(ctx, *descriptor, false);
 }
 
 namespace {
 class StaticFieldDeclaration : public FieldDeclaration {
  public:
-  StaticFieldDeclaration(Context *ctx, const std::string_view class_name, const std::string_view name,
-                         const std::string &descriptor)
-      : FieldDeclaration(ctx, descriptor), globals_() {
-    this->mangled_name_ = ctx->name_mangler()->MangleStaticFieldName(class_name, name, descriptor);
-  }
+  StaticFieldDeclaration(Context *ctx, const std::string *class_name, const std::string *name,
+                         const std::string *descriptor)
+      : FieldDeclaration(ctx, class_name, name, descriptor), globals_() {}
   ~StaticFieldDeclaration() noexcept override = default;
 
   void EmitDefinition(llvm::Module *module) override {
     llvm::GlobalVariable *global = this->GetGlobalInModule(module);
-    global->setLinkage(llvm::GlobalVariable::CommonLinkage);
+    if (this->initial_value() != nullptr) {
+      global->setInitializer(this->initial_value());
+      global->setConstant(this->is_read_only());
+    } else {
+      global->setLinkage(llvm::GlobalVariable::CommonLinkage);
+    }
   }
 
   Value EmitLoad(llvm::IRBuilder<> &builder, std::optional<Value> object_ref, const std::string &name) override {
@@ -52,29 +58,27 @@ class StaticFieldDeclaration : public FieldDeclaration {
   [[nodiscard]] StructElementLayoutSpecifier *element_layout() override { return nullptr; }
 
  private:
-  std::string mangled_name_;
-  std::map<llvm::Module *, llvm::GlobalVariable *> globals_;
+  llvm::SmallDenseMap<llvm::Module *, llvm::GlobalVariable *, 2> globals_;
 
   llvm::GlobalVariable *GetGlobalInModule(llvm::Module *module) {
     const auto &it = this->globals_.find(module);
     if (it != this->globals_.end()) return it->second;
 
+    std::string mangled_name =
+        this->ctx()->name_mangler()->MangleStaticFieldName(this->class_name(), this->name(), this->raw_descriptor());
     auto global = new llvm::GlobalVariable(*module, this->descriptor().llvm_type(this->ctx()), false,
-                                           llvm::GlobalValue::ExternalLinkage, nullptr, this->mangled_name_);
-    this->globals_.emplace(module, global);
+                                           llvm::GlobalValue::ExternalLinkage, nullptr, mangled_name);
+    this->globals_.try_emplace(module, global);
     return global;
   }
 };
 
 class InstanceFieldDeclaration : public FieldDeclaration, public StructElementLayoutSpecifier {
  public:
-  InstanceFieldDeclaration(Context *ctx, const std::string_view class_name, const std::string_view name,
-                           const std::string &descriptor)
-      : FieldDeclaration(ctx, descriptor), StructElementLayoutSpecifier(this->descriptor().llvm_type(this->ctx())),
-        getters_(), setters_() {
-    this->getter_mangled_name_ = ctx->name_mangler()->MangleInstanceFieldGetter(class_name, name, descriptor);
-    this->setter_mangled_name_ = ctx->name_mangler()->MangleInstanceFieldSetter(class_name, name, descriptor);
-  }
+  InstanceFieldDeclaration(Context *ctx, const std::string *class_name, const std::string *name,
+                           const std::string *descriptor)
+      : FieldDeclaration(ctx, class_name, name, descriptor),
+        StructElementLayoutSpecifier(this->descriptor().llvm_type(this->ctx())), getters_(), setters_() {}
   ~InstanceFieldDeclaration() noexcept override = default;
 
   void EmitDefinition(llvm::Module *module) override {
@@ -118,10 +122,8 @@ class InstanceFieldDeclaration : public FieldDeclaration, public StructElementLa
   [[nodiscard]] StructElementLayoutSpecifier *element_layout() override { return this; }
 
  private:
-  std::string getter_mangled_name_;
-  std::string setter_mangled_name_;
-  std::map<llvm::Module *, llvm::Function *> getters_;
-  std::map<llvm::Module *, llvm::Function *> setters_;
+  llvm::SmallDenseMap<llvm::Module *, llvm::Function *, 2> getters_;
+  llvm::SmallDenseMap<llvm::Module *, llvm::Function *, 2> setters_;
 
   llvm::Function *GetGetterInModule(llvm::Module *module) {
     const auto &it = this->getters_.find(module);
@@ -129,8 +131,11 @@ class InstanceFieldDeclaration : public FieldDeclaration, public StructElementLa
 
     std::vector<llvm::Type *> params = {this->ctx()->ptr_type()};
     llvm::FunctionType *func_type = llvm::FunctionType::get(this->descriptor().llvm_type(this->ctx()), params, false);
+    const NameMangler *mangler = this->ctx()->name_mangler();
+    std::string mangled_name =
+        mangler->MangleInstanceFieldGetter(this->class_name(), this->name(), this->raw_descriptor());
     llvm::Function *getter =
-        llvm::Function::Create(func_type, llvm::GlobalValue::ExternalLinkage, this->getter_mangled_name_, *module);
+        llvm::Function::Create(func_type, llvm::GlobalValue::ExternalLinkage, mangled_name, *module);
     getter->getArg(0)->setName("this");
     getter->addRetAttr(llvm::Attribute::NoUndef);
     getter->addParamAttr(0, llvm::Attribute::NoAlias);
@@ -148,7 +153,7 @@ class InstanceFieldDeclaration : public FieldDeclaration, public StructElementLa
     getter->addFnAttr(llvm::Attribute::WillReturn);
     getter->addFnAttr(llvm::Attribute::ReadOnly);
 
-    this->getters_.emplace(module, getter);
+    this->getters_.try_emplace(module, getter);
     return getter;
   }
 
@@ -158,8 +163,11 @@ class InstanceFieldDeclaration : public FieldDeclaration, public StructElementLa
 
     std::vector<llvm::Type *> params = {this->ctx()->ptr_type(), this->descriptor().llvm_type(this->ctx())};
     llvm::FunctionType *func_type = llvm::FunctionType::get(this->ctx()->void_type(), params, false);
+    const NameMangler *mangler = this->ctx()->name_mangler();
+    std::string mangled_name =
+        mangler->MangleInstanceFieldSetter(this->class_name(), this->name(), this->raw_descriptor());
     llvm::Function *setter =
-        llvm::Function::Create(func_type, llvm::GlobalValue::ExternalLinkage, this->setter_mangled_name_, module);
+        llvm::Function::Create(func_type, llvm::GlobalValue::ExternalLinkage, mangled_name, module);
     setter->getArg(0)->setName("this");
     setter->getArg(1)->setName("value");
     setter->addParamAttr(0, llvm::Attribute::NoCapture);
@@ -177,14 +185,14 @@ class InstanceFieldDeclaration : public FieldDeclaration, public StructElementLa
     setter->addFnAttr(llvm::Attribute::WillReturn);
     setter->addFnAttr(llvm::Attribute::WriteOnly);
 
-    this->setters_.emplace(module, setter);
+    this->setters_.try_emplace(module, setter);
     return setter;
   }
 };
 }// namespace
 
-std::unique_ptr<FieldDeclaration> FieldDeclaration::Create(Context *ctx, bool is_static, std::string_view class_name,
-                                                           std::string_view name, const std::string &descriptor) {
+std::unique_ptr<FieldDeclaration> FieldDeclaration::Create(Context *ctx, bool is_static, const std::string *class_name,
+                                                           const std::string *name, const std::string *descriptor) {
   if (is_static) {
     return std::make_unique<StaticFieldDeclaration>(ctx, class_name, name, descriptor);
   } else {
@@ -4,12 +4,12 @@
 
 #pragma once
 
-#include <map>
 #include <memory>
 #include <optional>
 #include <string>
 
 #include <cjbp/cjbp.h>
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/Value.h>
 
@@ -22,10 +22,13 @@ class ClassInfo;
 class CompilationUnit;
 class StructElementLayoutSpecifier;
 
+/**
+ * The names are interned in the context's SymbolTable.
+ */
 class FieldDeclaration {
  public:
-  static std::unique_ptr<FieldDeclaration> Create(Context *ctx, bool is_static, std::string_view class_name,
-                                                  std::string_view name, const std::string &descriptor);
+  static std::unique_ptr<FieldDeclaration> Create(Context *ctx, bool is_static, const std::string *class_name,
+                                                  const std::string *name, const std::string *descriptor);
 
   FieldDeclaration(const FieldDeclaration &) = delete;
   FieldDeclaration &operator=(const FieldDeclaration &) = delete;
@@ -42,13 +45,30 @@ class FieldDeclaration {
 
   [[nodiscard]] Context *ctx() const { return this->ctx_; }
   [[nodiscard]] Type descriptor() const { return this->descriptor_; }
+  [[nodiscard]] const std::string &class_name() const { return *this->class_name_; }
+  [[nodiscard]] const std::string &name() const { return *this->name_; }
+  [[nodiscard]] const std::string &raw_descriptor() const { return *this->raw_descriptor_; }
+
+  /**
+   * Bakes a compile-time computed value into a static field's definition. Read-only fields are placed in constant data,
+   * everything else in (copy-on-write) writable data.
+   */
+  void set_initial_value(llvm::Constant *value, bool is_read_only) {
+    this->initial_value_ = value;
+    this->is_read_only_ = is_read_only;
+  }
+  [[nodiscard]] llvm::Constant *initial_value() const { return this->initial_value_; }
+  [[nodiscard]] bool is_read_only() const { return this->is_read_only_; }
 
  protected:
-  FieldDeclaration(Context *ctx, const std::string &descriptor);
+  FieldDeclaration(Context *ctx, const std::string *class_name, const std::string *name, const std::string *descriptor);
 
  private:
   Context *ctx_;
+  const std::string *class_name_, *name_, *raw_descriptor_;
   Type descriptor_;
+  llvm::Constant *initial_value_;// Can be nullptr.
+  bool is_read_only_;
 };
 
 }// namespace magnetic
@@ -4,19 +4,18 @@
 
 #include "instantiate.h"
 
+#include <vector>
+
 #include "class.h"
+#include "codegen/runtime-abi.h"
 #include "context/context.h"
+#include "optimize/escape-analysis.h"
 #include "types/mangle.h"
 
 namespace magnetic {
 
-std::unique_ptr<ClassInstantiator> ClassInstantiator::Create(Context *ctx, std::string class_name) {
-  return std::make_unique<ClassInstantiator>(ctx, std::move(class_name));
-}
-ClassInstantiator::ClassInstantiator(Context *ctx, std::string class_name)
-    : ctx_(ctx), class_name_(std::move(class_name)), owner_(nullptr), instantiators_() {
-  this->mangled_name_ = ctx->name_mangler()->MangleInstantiatorName(this->class_name_);
-}
+ClassInstantiator::ClassInstantiator(Context *ctx, const std::string *class_name)
+    : ctx_(ctx), class_name_(class_name), owner_(nullptr), instantiators_() {}
 
 void ClassInstantiator::EmitDefinition(llvm::Module *module) {
   assert(this->owner_ != nullptr);
@@ -26,23 +25,38 @@ void ClassInstantiator::EmitDefinition(llvm::Module *module) {
   llvm::IRBuilder<> builder(*this->ctx_->llvm_ctx());
   builder.SetInsertPoint(block);
 
-  llvm::IntegerType *int_type = builder.getInt32Ty();
+  // Objects are allocated with calloc rather than malloc + memset. Besides being cheaper for large objects, it keeps the
+  // allocation a single instruction that InstCombine won't rewrite, so the layout tag below survives until the
+  // instantiator has been inlined.
+  llvm::IntegerType *size_type = builder.getInt64Ty();
   llvm::Type *type = this->owner_->struct_type();
-  llvm::Constant *malloc_size = llvm::ConstantInt::get(int_type, module->getDataLayout().getTypeAllocSize(type), true);
-  llvm::Value *ptr =
-      llvm::CallInst::CreateMalloc(builder.GetInsertBlock(), int_type, type, malloc_size, nullptr, nullptr, "");
-  builder.Insert(ptr);
-
-  llvm::Align align = module->getDataLayout().getABITypeAlign(type);
-  builder.CreateMemSet(ptr, llvm::ConstantInt::get(builder.getInt8Ty(), 0, true), malloc_size, align);
+  llvm::FunctionCallee calloc = module->getOrInsertFunction(
+      "calloc", llvm::FunctionType::get(this->ctx_->ptr_type(), {size_type, size_type}, false));
+  llvm::Constant *alloc_size = llvm::ConstantInt::get(size_type, module->getDataLayout().getTypeAllocSize(type));
+  llvm::CallInst *ptr = builder.CreateCall(calloc, {llvm::ConstantInt::get(size_type, 1), alloc_size}, "");
+  // Tag the allocation with the class's layout so that it can be moved to the stack if it doesn't escape its caller.
+  llvm::Metadata *layout_marker = llvm::ConstantAsMetadata::get(llvm::UndefValue::get(type));
+  ptr->setMetadata(kObjectAllocationMetadata, llvm::MDNode::get(*this->ctx_->llvm_ctx(), layout_marker));
 
   this->owner_->vtable().EmitStoreVTablePointer(builder, {ptr, Type::kObject});
 
+  if (this->ctx_->instrument_allocations()) {
+    uint64_t size = module->getDataLayout().getTypeAllocSize(type);
+    this->ctx_->runtime_abi()->EmitAllocationSample(builder, *this->class_name_, size, function->getArg(0));
+  }
   builder.CreateRet(ptr);
 }
-Value ClassInstantiator::EmitInstantiation(llvm::IRBuilder<> &builder, const std::string &name) {
-  llvm::Function *function = this->GetInstantiatorInModule(builder.GetInsertBlock()->getModule());
-  llvm::CallInst *instance = builder.CreateCall(function, llvm::None, name);
+Value ClassInstantiator::EmitInstantiation(llvm::IRBuilder<> &builder, const std::string &site_name,
+                                            const std::string &name) {
+  llvm::Module *module = builder.GetInsertBlock()->getModule();
+  llvm::Function *function = this->GetInstantiatorInModule(module);
+  // The allocation site is passed in, rather than taken from a return address in the runtime, because the instantiator
+  // is only inlined into callers in its own compilation unit.
+  std::vector<llvm::Value *> args{};
+  if (this->ctx_->instrument_allocations()) {
+    args.push_back(builder.CreateGlobalStringPtr(site_name, "allocation_site", 0, module));
+  }
+  llvm::CallInst *instance = builder.CreateCall(function, args, name);
   return {instance, Type::kObject};
 }
 
@@ -50,21 +64,29 @@ llvm::Function *ClassInstantiator::GetInstantiatorInModule(llvm::Module *module)
   const auto &it = this->instantiators_.find(module);
   if (it != this->instantiators_.end()) return it->second;
 
-  llvm::FunctionType *function_type = llvm::FunctionType::get(this->ctx_->ptr_type(), llvm::None, false);
+  // Instantiators that sample allocations take the name of the allocation site.
+  std::vector<llvm::Type *> param_types{};
+  if (this->ctx_->instrument_allocations()) param_types.push_back(this->ctx_->ptr_type());
+  llvm::FunctionType *function_type = llvm::FunctionType::get(this->ctx_->ptr_type(), param_types, false);
+  std::string mangled_name = this->ctx_->name_mangler()->MangleInstantiatorName(*this->class_name_);
   llvm::Function *function =
-      llvm::Function::Create(function_type, llvm::GlobalValue::ExternalLinkage, this->mangled_name_, *module);
+      llvm::Function::Create(function_type, llvm::GlobalValue::ExternalLinkage, mangled_name, *module);
   function->addRetAttr(llvm::Attribute::NoAlias);
   function->addRetAttr(llvm::Attribute::NoUndef);
   function->addFnAttr(llvm::Attribute::AlwaysInline);
-  function->addFnAttr(llvm::Attribute::InaccessibleMemOnly);
+  function->addFnAttr(llvm::Attribute::Hot);
   function->addFnAttr(llvm::Attribute::MustProgress);
-  function->addFnAttr(llvm::Attribute::NoFree);
   function->addFnAttr(llvm::Attribute::NoRecurse);
-  function->addFnAttr(llvm::Attribute::NoSync);
   function->addFnAttr(llvm::Attribute::NoUnwind);
+  // Allocation sampling updates a thread-local counter and calls into the runtime, which takes locks.
+  if (!this->ctx_->instrument_allocations()) {
+    function->addFnAttr(llvm::Attribute::InaccessibleMemOnly);
+    function->addFnAttr(llvm::Attribute::NoFree);
+    function->addFnAttr(llvm::Attribute::NoSync);
+  }
   function->addFnAttr(llvm::Attribute::WillReturn);
 
-  this->instantiators_.emplace(module, function);
+  this->instantiators_.try_emplace(module, function);
   return function;
 }
 
@@ -4,10 +4,10 @@
 
 #pragma once
 
-#include <map>
 #include <memory>
 #include <string>
 
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/Module.h>
 
@@ -18,27 +18,31 @@ namespace magnetic {
 class Context;
 class ClassInfo;
 
+/**
+ * Instantiators are created by Context::GetInstantiator, which allocates them in an arena. The class name is interned
+ * in the context's SymbolTable.
+ */
 class ClassInstantiator {
  public:
-  static std::unique_ptr<ClassInstantiator> Create(Context *ctx, std::string class_name);
-
   ClassInstantiator() = delete;
   ClassInstantiator(const ClassInstantiator &) = delete;
   ClassInstantiator &operator=(const ClassInstantiator &) = delete;
-  ClassInstantiator(Context *ctx, std::string class_name);
+  ClassInstantiator(Context *ctx, const std::string *class_name);
 
   void EmitDefinition(llvm::Module *module);
-  Value EmitInstantiation(llvm::IRBuilder<> &builder, const std::string &name);
+  /**
+   * @param site_name the allocating method and bytecode index, which allocation profiles attribute the object to
+   */
+  Value EmitInstantiation(llvm::IRBuilder<> &builder, const std::string &site_name, const std::string &name);
 
   void set_owner(ClassInfo *owner) { this->owner_ = owner; }
 
  private:
   Context *ctx_;
-  std::string class_name_;
-  std::string mangled_name_;
+  const std::string *class_name_;
   ClassInfo *owner_;// Can be nullptr.
 
-  std::map<llvm::Module *, llvm::Function *> instantiators_;
+  llvm::SmallDenseMap<llvm::Module *, llvm::Function *, 2> instantiators_;
 
   llvm::Function *GetInstantiatorInModule(llvm::Module *module);
 };
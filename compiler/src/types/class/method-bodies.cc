@@ -0,0 +1,151 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "method-bodies.h"
+
+#include "class-file-reader.h"
+#include "context/exception.h"
+
+namespace magnetic {
+
+namespace {
+void AppendU2(std::vector<uint8_t> &out, uint16_t value) {
+  out.push_back(value >> 8);
+  out.push_back(value & 0xFF);
+}
+void AppendU4(std::vector<uint8_t> &out, uint32_t value) {
+  AppendU2(out, value >> 16);
+  AppendU2(out, value & 0xFFFF);
+}
+void AppendUtf8Constant(std::vector<uint8_t> &out, const std::string &value) {
+  out.push_back(1);// CONSTANT_Utf8
+  AppendU2(out, value.size());
+  out.insert(out.end(), value.begin(), value.end());
+}
+void PatchU2(std::vector<uint8_t> &out, size_t offset, uint16_t value) {
+  out[offset] = value >> 8;
+  out[offset + 1] = value & 0xFF;
+}
+void CopyRange(std::vector<uint8_t> &out, const std::vector<uint8_t> &in, size_t begin, size_t end) {
+  out.insert(out.end(), in.begin() + static_cast<std::ptrdiff_t>(begin), in.begin() + static_cast<std::ptrdiff_t>(end));
+}
+}// namespace
+
+std::unique_ptr<LazyMethodBodies> LazyMethodBodies::Extract(std::vector<uint8_t> &class_file) {
+  ClassFileReader reader(class_file);
+  if (reader.ReadU4() != 0xCAFEBABE) throw BadBytecode("bad class file magic");
+  uint16_t minor_version = reader.ReadU2();
+  uint16_t major_version = reader.ReadU2();
+  auto bodies = std::make_unique<LazyMethodBodies>(minor_version, major_version);
+  reader.ReadConstPool();
+  reader.Skip(6);// access_flags, this_class, super_class
+  reader.Skip(reader.ReadU2() * 2);// interfaces
+  reader.SkipFields();
+
+  // Everything up to the methods is copied as is.
+  std::vector<uint8_t> stripped{};
+  stripped.reserve(class_file.size());
+  CopyRange(stripped, class_file, 0, reader.position());
+
+  uint16_t method_count = reader.ReadU2();
+  AppendU2(stripped, method_count);
+  for (uint16_t i = 0; i < method_count; ++i) {
+    size_t method_start = reader.position();
+    uint16_t access_flags = reader.ReadU2();
+    const std::string &name = reader.GetUtf8(reader.ReadU2());
+    const std::string &descriptor = reader.GetUtf8(reader.ReadU2());
+    CopyRange(stripped, class_file, method_start, reader.position());
+
+    uint16_t attribute_count = reader.ReadU2();
+    size_t attribute_count_offset = stripped.size();
+    AppendU2(stripped, attribute_count);
+    uint16_t kept_count = 0;
+    for (uint16_t j = 0; j < attribute_count; ++j) {
+      size_t attribute_start = reader.position();
+      const std::string &attribute_name = reader.GetUtf8(reader.ReadU2());
+      uint32_t length = reader.ReadU4();
+      size_t contents_start = reader.position();
+      reader.Skip(length);
+      if (attribute_name == "Code") {
+        std::vector<uint8_t> code_attribute(class_file.begin() + static_cast<std::ptrdiff_t>(contents_start),
+                                            class_file.begin() + static_cast<std::ptrdiff_t>(reader.position()));
+        Body body{access_flags, std::move(code_attribute), nullptr};
+        bodies->bodies_.emplace(std::make_pair(name, descriptor), std::move(body));
+      } else {
+        CopyRange(stripped, class_file, attribute_start, reader.position());
+        ++kept_count;
+      }
+    }
+    PatchU2(stripped, attribute_count_offset, kept_count);
+  }
+
+  // The class's own attributes follow the methods, and are also copied as is.
+  CopyRange(stripped, class_file, reader.position(), class_file.size());
+  class_file = std::move(stripped);
+  return bodies;
+}
+
+LazyMethodBodies::LazyMethodBodies(uint16_t minor_version, uint16_t major_version)
+    : minor_version_(minor_version), major_version_(major_version), bodies_() {}
+
+cjbp::Method *LazyMethodBodies::Decode(const std::string &name, const std::string &descriptor) {
+  const auto &it = this->bodies_.find(std::make_pair(name, descriptor));
+  if (it == this->bodies_.end()) return nullptr;
+
+  Body &body = it->second;
+  if (body.decoded == nullptr) {
+    cjbp::ByteInputStream stream(this->CreateMethodClassFile(name, descriptor, body));
+    body.decoded = std::make_unique<cjbp::Class>(stream);
+  }
+  return body.decoded->methods().front().get();
+}
+
+std::vector<uint8_t> LazyMethodBodies::CreateMethodClassFile(const std::string &name, const std::string &descriptor,
+                                                             const Body &body) const {
+  static constexpr uint16_t kCodeNameIndex = 1;
+  static constexpr uint16_t kMethodNameIndex = 2;
+  static constexpr uint16_t kDescriptorIndex = 3;
+  static constexpr uint16_t kClassIndex = 5;
+
+  ClassFileReader reader(body.code_attribute);
+  reader.Skip(4);// max_stack, max_locals
+  reader.Skip(reader.ReadU4());// code
+  size_t code_end = reader.position();
+
+  std::vector<uint8_t> class_file{};
+  class_file.reserve(code_end + name.size() + descriptor.size() + 64);
+  AppendU4(class_file, 0xCAFEBABE);
+  AppendU2(class_file, this->minor_version_);
+  AppendU2(class_file, this->major_version_);
+
+  AppendU2(class_file, 6);// constant_pool_count
+  AppendUtf8Constant(class_file, "Code");
+  AppendUtf8Constant(class_file, name);
+  AppendUtf8Constant(class_file, descriptor);
+  AppendUtf8Constant(class_file, "magnetic/MethodBody");
+  class_file.push_back(7);// CONSTANT_Class
+  AppendU2(class_file, 4);
+
+  AppendU2(class_file, 0);// access_flags
+  AppendU2(class_file, kClassIndex);
+  AppendU2(class_file, 0);// super_class
+  AppendU2(class_file, 0);// interfaces_count
+  AppendU2(class_file, 0);// fields_count
+
+  AppendU2(class_file, 1);// methods_count
+  AppendU2(class_file, body.access_flags);
+  AppendU2(class_file, kMethodNameIndex);
+  AppendU2(class_file, kDescriptorIndex);
+  AppendU2(class_file, 1);// attributes_count
+  AppendU2(class_file, kCodeNameIndex);
+  AppendU4(class_file, code_end + 4);
+  CopyRange(class_file, body.code_attribute, 0, code_end);
+  AppendU2(class_file, 0);// exception_table_length
+  AppendU2(class_file, 0);// attributes_count
+
+  AppendU2(class_file, 0);// attributes_count
+  return class_file;
+}
+
+}// namespace magnetic
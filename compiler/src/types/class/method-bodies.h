@@ -0,0 +1,62 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <cjbp/cjbp.h>
+
+namespace magnetic {
+
+/**
+ * The Code attributes of a class's methods, split off of the class file so that cjbp only parses a method's body when
+ * the method is compiled. Most loaded methods are never compiled (natives, intrinsics, methods that aren't reachable),
+ * and their bodies are usually most of a class file.
+ *
+ * A body is decoded as a class file of its own that holds just the one method. The method's instructions still refer to
+ * the constant pool of the class that they came from, which is left in the stripped class file.
+ *
+ * Only max_stack, max_locals and the instructions are kept. The exception table and the Code attribute's own
+ * attributes are dropped: the compiler doesn't read them, and line numbers come from ClassDebugAttributes, which is
+ * read before the class file is split.
+ */
+class LazyMethodBodies {
+ public:
+  /**
+   * Removes the Code attributes from the methods in the class file and keeps them, undecoded, in the returned object.
+   */
+  [[nodiscard]] static std::unique_ptr<LazyMethodBodies> Extract(std::vector<uint8_t> &class_file);
+
+  LazyMethodBodies(uint16_t minor_version, uint16_t major_version);
+
+  /**
+   * Decodes the body of a method on first use. The returned method has the same access flags, name and descriptor as
+   * the method in the stripped class.
+   *
+   * @return the decoded method, or nullptr if the method has no body (it is abstract or native)
+   */
+  [[nodiscard]] cjbp::Method *Decode(const std::string &name, const std::string &descriptor);
+
+ private:
+  struct Body {
+    uint16_t access_flags;
+    std::vector<uint8_t> code_attribute;// The Code attribute's contents, without its name and length.
+    std::unique_ptr<cjbp::Class> decoded;// nullptr until the body is decoded.
+  };
+
+  uint16_t minor_version_;
+  uint16_t major_version_;
+  std::map<std::pair<std::string, std::string>, Body> bodies_;
+
+  [[nodiscard]] std::vector<uint8_t> CreateMethodClassFile(const std::string &name, const std::string &descriptor,
+                                                           const Body &body) const;
+};
+
+}// namespace magnetic
@@ -8,46 +8,56 @@
 
 #include <cjbp/cjbp.h>
 #include <llvm/IR/Function.h>
+#include <llvm/IR/MDBuilder.h>
 
+#include "analysis/reachability.h"
 #include "class/descriptor.h"
 #include "codegen/codegen-method.h"
+#include "codegen/intrinsics.h"
 #include "compilation-unit/compilation-unit.h"
 #include "context/context.h"
+#include "context/statistics.h"
 #include "types/mangle.h"
 
 namespace magnetic {
 
-std::unique_ptr<MethodDeclaration> MethodDeclaration::Create(Context *ctx, bool is_static, std::string class_name,
-                                                             std::string name, std::string descriptor) {
-  return std::make_unique<MethodDeclaration>(ctx, is_static, std::move(class_name), std::move(name),
-                                             std::move(descriptor));
-}
-MethodDeclaration::MethodDeclaration(Context *ctx, bool is_static, std::string class_name, std::string name,
-                                     std::string descriptor)
-    : ctx_(ctx), functions_(), class_name_(std::move(class_name)), name_(std::move(name)),
-      raw_descriptor_(std::move(descriptor)), owner_(nullptr), bytecode_(nullptr) {
-  this->mangled_name_ = ctx->name_mangler()->MangleMethodName(this->class_name_, this->name_, this->raw_descriptor_);
-  this->virtual_mangled_name_ =
-      ctx->name_mangler()->MangleVirtualDispatchName(this->class_name_, this->name_, this->raw_descriptor_);
-  this->descriptor_ = ParseMethodDescriptor(ctx, is_static, this->raw_descriptor_, false);
+MethodDeclaration::MethodDeclaration(Context *ctx, bool is_static, const std::string *class_name,
+                                     const std::string *name, const std::string *descriptor)
+    : ctx_(ctx), class_name_(class_name), name_(name), raw_descriptor_(descriptor),
+      descriptor_(ctx->GetMethodDescriptor(is_static, descriptor)), owner_(nullptr), bytecode_(nullptr), functions_(),
+      virtual_dispatches_() {
   this->function_type_ = this->descriptor_->CreateFunctionType(ctx);
 }
 bool MethodDeclaration::is_static() const { return this->descriptor_->is_static(); }
+bool MethodDeclaration::is_synchronized() const {
+  assert(this->bytecode_ != nullptr);
+  return (this->bytecode_->access_flags() & cjbp::AccessFlags::kSynchronized);
+}
 bool MethodDeclaration::is_final() const {
   assert(this->bytecode_ != nullptr);
   return (this->bytecode_->access_flags() & cjbp::AccessFlags::kFinal);
 }
-bool MethodDeclaration::is_constructor() const { return (this->name_ == "<init>") && (this->raw_descriptor_ == "()V"); }
+bool MethodDeclaration::is_constructor() const {
+  return (this->name() == "<init>") && (this->raw_descriptor() == "()V");
+}
 bool MethodDeclaration::CanBeOverridden() const {
   if (this->is_static()) return false;
   if (this->is_constructor()) return false;
 
-  // Assume it can be overridden if there's not enough information.
+  // Assume it can be overridden if there's not enough information. This includes methods that the class inherits
+  // rather than declares, which have no function of their own to call directly.
   if (this->bytecode_ == nullptr) return true;
   if (this->owner_ == nullptr) return true;
 
   if (this->is_final()) return false;
   if (this->owner_->is_final()) return false;
+
+  // The reachability analysis has seen every class that the program instantiates, so if none of them overrides the
+  // method, every call to it runs this method.
+  const ReachabilityAnalysis *reachability = this->ctx_->reachability();
+  if (reachability != nullptr) {
+    return reachability->IsOverridden(this->class_name(), this->name(), this->raw_descriptor());
+  }
   return true;
 }
 bool MethodDeclaration::IsVirtual() const {
@@ -61,11 +71,17 @@ bool MethodDeclaration::IsVirtual() const {
   // no super class).
   if (!this->CanBeOverridden()) {
     if (this->owner_->super_class() == nullptr) return false;
-    if (!this->owner_->super_class()->vtable().HasMethod(this->name_, this->raw_descriptor_)) return false;
+    if (!this->owner_->super_class()->vtable().HasMethod(this->name(), this->raw_descriptor())) return false;
   }
   return true;
 }
 
+bool MethodDeclaration::IsReachable() const {
+  const ReachabilityAnalysis *reachability = this->ctx_->reachability();
+  if (reachability == nullptr) return true;
+  return reachability->IsReachable(this->class_name(), this->name(), this->raw_descriptor());
+}
+
 llvm::Function *MethodDeclaration::CreateFunctionInModule(llvm::Module *module, const std::string &mangled_name) const {
   llvm::Function *function =
       llvm::Function::Create(this->function_type_, llvm::GlobalValue::ExternalLinkage, mangled_name, module);
@@ -87,8 +103,12 @@ llvm::Function *MethodDeclaration::GetFunctionInModule(llvm::Module *module) {
   const auto &it = this->functions_.find(module);
   if (it != this->functions_.end()) return it->second;
 
-  llvm::Function *function = this->CreateFunctionInModule(module, this->mangled_name_);
-  this->functions_.emplace(module, function);
+  std::string mangled_name =
+      this->ctx_->name_mangler()->MangleMethodName(this->class_name(), this->name(), this->raw_descriptor());
+  llvm::Function *function = this->CreateFunctionInModule(module, mangled_name);
+  // Static initializers run once per program, so keep them out of the way of code that runs often.
+  if (this->name() == "<clinit>") function->addFnAttr(llvm::Attribute::Cold);
+  this->functions_.try_emplace(module, function);
   return function;
 }
 llvm::Function *MethodDeclaration::GetVirtualDispatchInModule(llvm::Module *module) {
@@ -96,20 +116,55 @@ llvm::Function *MethodDeclaration::GetVirtualDispatchInModule(llvm::Module *modu
   const auto &it = this->virtual_dispatches_.find(module);
   if (it != this->virtual_dispatches_.end()) return it->second;
 
-  llvm::Function *function = this->CreateFunctionInModule(module, this->virtual_mangled_name_);
-  this->virtual_dispatches_.emplace(module, function);
+  std::string mangled_name =
+      this->ctx_->name_mangler()->MangleVirtualDispatchName(this->class_name(), this->name(), this->raw_descriptor());
+  llvm::Function *function = this->CreateFunctionInModule(module, mangled_name);
+  this->virtual_dispatches_.try_emplace(module, function);
   return function;
 }
 
+namespace {
+/**
+ * Replaces the method's body with its intrinsic, so that calls that aren't intrinsified at the call site (such as
+ * virtual calls) still get the intrinsic's implementation.
+ */
+void EmitIntrinsicDefinition(llvm::LLVMContext &llvm_ctx, llvm::Function *function, const IntrinsicEmitter &intrinsic) {
+  llvm::BasicBlock *block = llvm::BasicBlock::Create(llvm_ctx, "", function);
+  llvm::IRBuilder<> builder(llvm_ctx);
+  builder.SetInsertPoint(block);
+
+  std::vector<llvm::Value *> args{};
+  args.reserve(function->arg_size());
+  for (size_t i = 0; i < function->arg_size(); ++i) { args.push_back(function->getArg(i)); }
+  llvm::Value *result = intrinsic(builder, args);
+  if (function->getReturnType()->isVoidTy()) {
+    builder.CreateRetVoid();
+  } else {
+    builder.CreateRet(result);
+  }
+}
+}// namespace
 void MethodDeclaration::EmitDefinition(llvm::Module *module) {
   assert(this->bytecode_ != nullptr);
   assert(this->owner_ != nullptr);
 
+  const IntrinsicEmitter *intrinsic = nullptr;
+  if (this->ctx_->intrinsics() != nullptr) {
+    intrinsic = this->ctx_->intrinsics()->Find(this->class_name(), this->name(), this->raw_descriptor());
+  }
+
   // TODO: Implement natives
-  if (this->bytecode_->access_flags() & cjbp::AccessFlags::kNative) return;
+  if (intrinsic == nullptr && (this->bytecode_->access_flags() & cjbp::AccessFlags::kNative)) return;
 
+  CompileStatistics::Scope scope(this->ctx_->statistics(), CompilePhase::kMethodCodegen, this->class_name(),
+                                 this->name() + this->raw_descriptor());
   llvm::Function *function = this->GetFunctionInModule(module);
-  codegen::EmitMethod(this->owner_, this, this->bytecode_, function, module);
+  if (intrinsic != nullptr) {
+    EmitIntrinsicDefinition(*this->ctx_->llvm_ctx(), function, *intrinsic);
+  } else {
+    codegen::EmitMethod(this->owner_, this, this->owner_->GetMethodBody(this->bytecode_), function, module);
+  }
+  scope.set_instruction_count(function->getInstructionCount());
 
   if (this->IsVirtual()) { this->EmitVirtualDispatchThunkDefinition(module); }
 }
@@ -133,10 +188,40 @@ Value MethodDeclaration::EmitCall(llvm::IRBuilder<> &builder, std::optional<Valu
 }
 Value MethodDeclaration::EmitVirtualCall(llvm::IRBuilder<> &builder, Value object_ref, const std::vector<Value> &params,
                                          const std::string &name) {
-  llvm::Function *function = this->GetVirtualDispatchInModule(builder.GetInsertBlock()->getModule());
-  llvm::Value *call_result = EmitMethodCall(builder, this->function_type_, function, object_ref, params, name);
+  llvm::Module *module = builder.GetInsertBlock()->getModule();
+  // The vtable isn't complete until the owner has added its methods, so calls made while the owner is being emitted
+  // (and calls to methods of classes that aren't loaded) go through the dispatch thunk.
+  if (this->owner_ == nullptr || !this->owner_->vtable().HasMethod(this->name(), this->raw_descriptor())) {
+    llvm::Function *function = this->GetVirtualDispatchInModule(module);
+    llvm::Value *call_result = EmitMethodCall(builder, this->function_type_, function, object_ref, params, name);
+    return {call_result, this->descriptor_->return_type()};
+  }
+
+  // Each call site gets its own vtable load and indirect call, which the branch predictor tracks separately.
+  const VTable &vtable = this->owner_->vtable();
+  llvm::Value *method = vtable.EmitVirtualLookup(builder, object_ref, this->name(), this->raw_descriptor());
+  llvm::Value *call_result = EmitMethodCall(builder, this->function_type_, method, object_ref, params, name);
+  llvm::MDNode *callees = this->CreateCalleesMetadata(module);
+  if (callees != nullptr) llvm::cast<llvm::CallInst>(call_result)->setMetadata(llvm::LLVMContext::MD_callees, callees);
   return {call_result, this->descriptor_->return_type()};
 }
+llvm::MDNode *MethodDeclaration::CreateCalleesMetadata(llvm::Module *module) const {
+  // !callees promises that the call runs one of the listed functions and nothing else, so the set of implementations
+  // has to be complete. It isn't if native code may have created an instance of a class that the analysis didn't see
+  // instantiated.
+  const ReachabilityAnalysis *reachability = this->ctx_->reachability();
+  if (reachability == nullptr || !reachability->sees_all_instantiations()) return nullptr;
+
+  std::vector<llvm::Function *> callees{};
+  for (const auto &implementation :
+       reachability->FindImplementations(this->class_name(), this->name(), this->raw_descriptor())) {
+    const std::string &owner_name = implementation.first->name();
+    MethodDeclaration *method = this->ctx_->GetMethod(owner_name, this->name(), this->raw_descriptor(), false);
+    callees.push_back(method->GetFunctionInModule(module));
+  }
+  if (callees.empty()) return nullptr;
+  return llvm::MDBuilder(module->getContext()).createCallees(callees);
+}
 void MethodDeclaration::EmitVirtualDispatchThunkDefinition(llvm::Module *module) {
   assert(this->IsVirtual());
   assert(this->owner_ != nullptr);
@@ -147,7 +232,7 @@ void MethodDeclaration::EmitVirtualDispatchThunkDefinition(llvm::Module *module)
   builder.SetInsertPoint(block);
 
   llvm::Value *method = this->owner_->vtable().EmitVirtualLookup(builder, {function->getArg(0), Type::kObject},
-                                                                 this->name_, this->raw_descriptor_);
+                                                                 this->name(), this->raw_descriptor());
   std::vector<llvm::Value *> args{};
   args.reserve(function->arg_size());
   for (size_t i = 0; i < function->arg_size(); ++i) { args.push_back(function->getArg(i)); }
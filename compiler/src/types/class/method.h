@@ -4,13 +4,13 @@
 
 #pragma once
 
-#include <map>
 #include <memory>
 #include <optional>
 #include <string>
 #include <vector>
 
 #include <cjbp/cjbp.h>
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/IR/Function.h>
 
 #include "descriptor.h"
@@ -22,15 +22,17 @@ class Context;
 class ClassInfo;
 class CompilationUnit;
 
+/**
+ * Declarations are created by Context::GetMethod, which allocates them in an arena. The names are interned in the
+ * context's SymbolTable.
+ */
 class MethodDeclaration {
  public:
-  static std::unique_ptr<MethodDeclaration> Create(Context *ctx, bool is_static, std::string class_name,
-                                                   std::string name, std::string descriptor);
-
   MethodDeclaration() = delete;
   MethodDeclaration(const MethodDeclaration &) = delete;
   MethodDeclaration &operator=(const MethodDeclaration &) = delete;
-  MethodDeclaration(Context *ctx, bool is_static, std::string class_name, std::string name, std::string descriptor);
+  MethodDeclaration(Context *ctx, bool is_static, const std::string *class_name, const std::string *name,
+                    const std::string *descriptor);
 
   void EmitDefinition(llvm::Module *module);
 
@@ -40,29 +42,34 @@ class MethodDeclaration {
                                       const std::string &name);
 
   [[nodiscard]] bool is_static() const;
+  [[nodiscard]] bool is_synchronized() const;
   [[nodiscard]] bool CanBeOverridden() const;
   [[nodiscard]] bool IsVirtual() const;
+  /**
+   * @return false if reachability analysis found that the method never runs, in which case it isn't compiled
+   */
+  [[nodiscard]] bool IsReachable() const;
 
   [[nodiscard]] llvm::Function *GetFunctionInModule(llvm::Module *module);
 
-  [[nodiscard]] MethodDescriptor *descriptor() const { return this->descriptor_.get(); }
-  [[nodiscard]] const std::string &class_name() const { return this->class_name_; }
-  [[nodiscard]] const std::string &name() const { return this->name_; }
-  [[nodiscard]] const std::string &raw_descriptor() const { return this->raw_descriptor_; }
+  [[nodiscard]] MethodDescriptor *descriptor() const { return this->descriptor_; }
+  [[nodiscard]] const std::string &class_name() const { return *this->class_name_; }
+  [[nodiscard]] const std::string &name() const { return *this->name_; }
+  [[nodiscard]] const std::string &raw_descriptor() const { return *this->raw_descriptor_; }
   void set_owner(ClassInfo *owner) { this->owner_ = owner; }
   void set_bytecode(cjbp::Method *bytecode) { this->bytecode_ = bytecode; }
 
  private:
   Context *ctx_;
-  std::string mangled_name_, virtual_mangled_name_;
-  std::string class_name_, name_, raw_descriptor_;
-  std::unique_ptr<MethodDescriptor> descriptor_;
+  const std::string *class_name_, *name_, *raw_descriptor_;
+  MethodDescriptor *descriptor_;// Shared with the other methods that have the same descriptor.
   llvm::FunctionType *function_type_;
   ClassInfo *owner_;      // Can be nullptr.
   cjbp::Method *bytecode_;// Can be nullptr.
 
-  std::map<llvm::Module *, llvm::Function *> functions_;
-  std::map<llvm::Module *, llvm::Function *> virtual_dispatches_;
+  // A method is usually only declared in one or two modules, so these are kept inline rather than allocated.
+  llvm::SmallDenseMap<llvm::Module *, llvm::Function *, 2> functions_;
+  llvm::SmallDenseMap<llvm::Module *, llvm::Function *, 1> virtual_dispatches_;
 
   [[nodiscard]] bool is_final() const;
   [[nodiscard]] bool is_constructor() const;
@@ -71,6 +78,11 @@ class MethodDeclaration {
 
   llvm::Function *CreateFunctionInModule(llvm::Module *module, const std::string &mangled_name) const;
   [[nodiscard]] llvm::Function *GetVirtualDispatchInModule(llvm::Module *module);
+  /**
+   * @return the methods that a virtual call to this method can run, as !callees metadata, or nullptr if they aren't
+   *         known
+   */
+  [[nodiscard]] llvm::MDNode *CreateCalleesMetadata(llvm::Module *module) const;
 };
 
 }// namespace magnetic
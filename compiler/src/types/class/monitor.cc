@@ -0,0 +1,96 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "monitor.h"
+
+#include <llvm/IR/MDBuilder.h>
+
+#include "context/context.h"
+#include "types/mangle.h"
+
+namespace magnetic {
+
+namespace {
+constexpr const char *kThreadLockTagName = "Magnetic_rt_thread_lock_tag";
+constexpr const char *kMonitorEnterName = "Magnetic_rt_monitor_enter";
+constexpr const char *kMonitorExitName = "Magnetic_rt_monitor_exit";
+}// namespace
+
+Monitor Monitor::CreateMonitorForBaseClass(Context *ctx) { return Monitor(ctx); }
+Monitor::Monitor(Context *ctx) : ctx_(ctx), layout_(ctx->int32()) {}
+
+Monitor Monitor::CreateMonitorForSubClass(const Monitor &base_monitor) {
+  // The base class is always at the start of its subclasses, so the lock word is at the same offset in every object.
+  return {base_monitor.ctx_, base_monitor.layout_};
+}
+Monitor::Monitor(Context *ctx, StructElementLayoutSpecifier layout) : ctx_(ctx), layout_(layout) {}
+
+llvm::Value *Monitor::EmitLockWordPointer(llvm::IRBuilder<> &builder, Value object_ref) const {
+  assert(object_ref.type == Type::kObject);
+  assert(object_ref.value != nullptr);
+  return this->layout_.EmitGEP(builder, object_ref.value, "lock_word");
+}
+llvm::Value *Monitor::GetClassLockWordInModule(llvm::Module *module, const std::string &class_name) const {
+  std::string mangled_name = this->ctx_->name_mangler()->MangleClassLockName(class_name);
+  llvm::GlobalVariable *lock_word = module->getNamedGlobal(mangled_name);
+  if (lock_word != nullptr) return lock_word;
+
+  // Like static fields, the class lock may be defined by the module of every class that uses it.
+  return new llvm::GlobalVariable(*module, this->ctx_->int32(), false, llvm::GlobalValue::CommonLinkage,
+                                  llvm::ConstantInt::get(this->ctx_->int32(), 0), mangled_name);
+}
+
+llvm::Value *Monitor::EmitLoadThreadTag(llvm::IRBuilder<> &builder) const {
+  // The tag is the thread's id shifted into the owner bits of the lock word. It is 0 until the runtime assigns the
+  // thread an id, which it does the first time the thread takes the slow path.
+  llvm::Module *module = builder.GetInsertBlock()->getModule();
+  llvm::GlobalVariable *tag = module->getNamedGlobal(kThreadLockTagName);
+  if (tag == nullptr) {
+    tag = new llvm::GlobalVariable(*module, this->ctx_->int32(), false, llvm::GlobalValue::ExternalLinkage, nullptr,
+                                   kThreadLockTagName, nullptr, llvm::GlobalValue::InitialExecTLSModel);
+  }
+  return builder.CreateLoad(this->ctx_->int32(), tag, "thread_tag");
+}
+
+void Monitor::EmitSlowPath(llvm::IRBuilder<> &builder, llvm::Value *fast_path_succeeded, llvm::Value *lock_word,
+                           const char *runtime_function, const std::string &name) const {
+  llvm::LLVMContext &llvm_ctx = *this->ctx_->llvm_ctx();
+  llvm::Function *function = builder.GetInsertBlock()->getParent();
+  llvm::BasicBlock *slow_block = llvm::BasicBlock::Create(llvm_ctx, name + "_slow", function);
+  llvm::BasicBlock *done_block = llvm::BasicBlock::Create(llvm_ctx, name + "_done", function);
+  builder.CreateCondBr(fast_path_succeeded, done_block, slow_block,
+                       llvm::MDBuilder(llvm_ctx).createBranchWeights(2000, 1));
+
+  builder.SetInsertPoint(slow_block);
+  llvm::FunctionType *function_type = llvm::FunctionType::get(this->ctx_->void_type(), {this->ctx_->ptr_type()}, false);
+  llvm::FunctionCallee callee = builder.GetInsertBlock()->getModule()->getOrInsertFunction(runtime_function,
+                                                                                           function_type);
+  builder.CreateCall(callee, {lock_word});
+  builder.CreateBr(done_block);
+
+  builder.SetInsertPoint(done_block);
+}
+
+void Monitor::EmitEnter(llvm::IRBuilder<> &builder, llvm::Value *lock_word) const {
+  // Fast path: the monitor is unlocked, so take it by swapping in our tag. A tag of 0 would "succeed" without taking
+  // ownership, so a thread without an id always goes to the runtime.
+  llvm::Value *tag = this->EmitLoadThreadTag(builder);
+  llvm::AtomicCmpXchgInst *cmpxchg =
+      builder.CreateAtomicCmpXchg(lock_word, llvm::ConstantInt::get(this->ctx_->int32(), 0), tag, llvm::MaybeAlign(4),
+                                  llvm::AtomicOrdering::Acquire, llvm::AtomicOrdering::Monotonic);
+  llvm::Value *swapped = builder.CreateExtractValue(cmpxchg, 1, "swapped");
+  llvm::Value *has_tag = builder.CreateICmpNE(tag, llvm::ConstantInt::get(this->ctx_->int32(), 0), "has_tag");
+  this->EmitSlowPath(builder, builder.CreateAnd(swapped, has_tag), lock_word, kMonitorEnterName, "monitor_enter");
+}
+void Monitor::EmitExit(llvm::IRBuilder<> &builder, llvm::Value *lock_word) const {
+  // Fast path: we entered the monitor once and nobody is waiting, so the lock word is exactly our tag.
+  llvm::Value *tag = this->EmitLoadThreadTag(builder);
+  llvm::AtomicCmpXchgInst *cmpxchg =
+      builder.CreateAtomicCmpXchg(lock_word, tag, llvm::ConstantInt::get(this->ctx_->int32(), 0), llvm::MaybeAlign(4),
+                                  llvm::AtomicOrdering::Release, llvm::AtomicOrdering::Monotonic);
+  llvm::Value *swapped = builder.CreateExtractValue(cmpxchg, 1, "swapped");
+  this->EmitSlowPath(builder, swapped, lock_word, kMonitorExitName, "monitor_exit");
+}
+
+}// namespace magnetic
@@ -0,0 +1,69 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <string>
+
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Value.h>
+
+#include "layout.h"
+#include "types/type.h"
+
+namespace magnetic {
+
+class Context;
+
+/**
+ * The lock word in every object's header, which implements Java monitors (synchronized blocks and methods) as thin
+ * locks.
+ *
+ * The lock word is a 32-bit integer:
+ *  - bits 31:8 hold the id of the thread that owns the monitor (0 if it is unlocked),
+ *  - bits 7:2 count how many times the owner re-entered the monitor,
+ *  - bit 1 is set when other threads are waiting for the monitor,
+ *  - bit 0 is reserved.
+ *
+ * Entering an unlocked monitor and leaving a monitor that was entered once are a single compare-and-swap, emitted
+ * inline. Everything else (recursion, contention, and a thread's first lock) goes to the runtime, which uses the lock
+ * word as a futex to park and wake waiting threads.
+ */
+class Monitor {
+ public:
+  static Monitor CreateMonitorForBaseClass(Context *ctx);
+  static Monitor CreateMonitorForSubClass(const Monitor &base_monitor);
+
+  Monitor() = delete;
+  Monitor(const Monitor &) = delete;
+  Monitor &operator=(const Monitor &) = delete;
+  Monitor(Monitor &&) = default;
+  Monitor &operator=(Monitor &&) = default;
+  explicit Monitor(Context *ctx);
+  Monitor(Context *ctx, StructElementLayoutSpecifier layout);
+
+  [[nodiscard]] StructElementLayoutSpecifier &layout() { return this->layout_; }
+
+  /**
+   * @return a pointer to the lock word of the object
+   */
+  [[nodiscard]] llvm::Value *EmitLockWordPointer(llvm::IRBuilder<> &builder, Value object_ref) const;
+  /**
+   * @return a pointer to the lock word used by the class's static synchronized methods
+   */
+  [[nodiscard]] llvm::Value *GetClassLockWordInModule(llvm::Module *module, const std::string &class_name) const;
+
+  void EmitEnter(llvm::IRBuilder<> &builder, llvm::Value *lock_word) const;
+  void EmitExit(llvm::IRBuilder<> &builder, llvm::Value *lock_word) const;
+
+ private:
+  Context *ctx_;
+  StructElementLayoutSpecifier layout_;
+
+  [[nodiscard]] llvm::Value *EmitLoadThreadTag(llvm::IRBuilder<> &builder) const;
+  void EmitSlowPath(llvm::IRBuilder<> &builder, llvm::Value *fast_path_succeeded, llvm::Value *lock_word,
+                    const char *runtime_function, const std::string &name) const;
+};
+
+}// namespace magnetic
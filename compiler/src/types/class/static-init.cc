@@ -0,0 +1,384 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "static-init.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <cjbp/cjbp.h>
+#include <llvm/ADT/APSInt.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/InstrTypes.h>
+
+#include "class.h"
+#include "context/context.h"
+#include "context/exception.h"
+#include "field.h"
+
+using namespace cjbp::Opcode;
+
+namespace magnetic {
+
+namespace {
+// Upper bound on the number of instructions interpreted, so that a long-running or non-terminating initializer falls
+// back to running at startup instead of hanging the compiler.
+constexpr int32_t kMaxInterpretedInstructions = 1 << 16;
+
+class StaticInitializerInterpreter {
+ public:
+  enum class Result { kContinue, kReturn, kUnsupported };
+
+  StaticInitializerInterpreter(ClassInfo *owner, cjbp::Method *initializer)
+      : owner_(owner), ctx_(owner->ctx()), iterator_(*initializer->code_attribute()), stack_(), locals_(), fields_() {}
+
+  std::optional<StaticFieldImage> Run() {
+    for (int32_t steps = 0; steps < kMaxInterpretedInstructions && this->iterator_.HasNext(); ++steps) {
+      size_t index = this->iterator_.Next();
+      Result result = this->Step(index);
+      if (result == Result::kReturn) return this->fields_;
+      if (result == Result::kUnsupported) return std::nullopt;
+    }
+    return std::nullopt;
+  }
+
+ private:
+  ClassInfo *owner_;
+  Context *ctx_;
+  cjbp::CodeIterator iterator_;
+  std::vector<llvm::Constant *> stack_;
+  std::map<int32_t, llvm::Constant *> locals_;
+  StaticFieldImage fields_;
+
+  void Push(llvm::Constant *value) { this->stack_.push_back(value); }
+  llvm::Constant *Pop() {
+    if (this->stack_.empty()) throw BadBytecode("stack underflow in static initializer of " + this->owner_->name());
+    llvm::Constant *top = this->stack_.back();
+    this->stack_.pop_back();
+    return top;
+  }
+  llvm::ConstantInt *PopInt() { return llvm::cast<llvm::ConstantInt>(this->Pop()); }
+  llvm::ConstantFP *PopFP() { return llvm::cast<llvm::ConstantFP>(this->Pop()); }
+
+  Result PushInt(int32_t value) {
+    this->Push(llvm::ConstantInt::get(this->ctx_->int32(), value, true));
+    return Result::kContinue;
+  }
+  Result PushLong(int64_t value) {
+    this->Push(llvm::ConstantInt::get(this->ctx_->int64(), value, true));
+    return Result::kContinue;
+  }
+  Result PushFP(llvm::Type *type, double value) {
+    this->Push(llvm::ConstantFP::get(type, value));
+    return Result::kContinue;
+  }
+
+  Result Ldc(uint16_t pool_index) {
+    const cjbp::ConstPool &pool = this->owner_->bytecode()->const_pool();
+    std::optional<cjbp::ConstTag> tag = pool.GetTag(pool_index);
+    if (tag == cjbp::ConstTag::kInteger) return this->PushInt(pool.GetInteger(pool_index).value());
+    if (tag == cjbp::ConstTag::kLong) return this->PushLong(pool.GetLong(pool_index).value());
+    if (tag == cjbp::ConstTag::kFloat) {
+      this->Push(llvm::ConstantFP::get(this->ctx_->float32(), pool.GetFloat(pool_index).value()));
+      return Result::kContinue;
+    }
+    if (tag == cjbp::ConstTag::kDouble) return this->PushFP(this->ctx_->float64(), pool.GetDouble(pool_index).value());
+    // String literals live in the runtime string pool, so they can't be baked into the image.
+    return Result::kUnsupported;
+  }
+
+  Result Load(int32_t index) {
+    const auto &it = this->locals_.find(index);
+    if (it == this->locals_.end()) throw BadBytecode("read of uninitialized local in static initializer");
+    this->Push(it->second);
+    return Result::kContinue;
+  }
+  Result Store(int32_t index) {
+    this->locals_[index] = this->Pop();
+    return Result::kContinue;
+  }
+
+  Result BinaryOp(llvm::Instruction::BinaryOps op) {
+    llvm::Constant *rhs = this->Pop();
+    llvm::Constant *lhs = this->Pop();
+    this->Push(llvm::ConstantExpr::get(op, lhs, rhs));
+    return Result::kContinue;
+  }
+  Result Shift(llvm::Instruction::BinaryOps op) {
+    // Java only uses the low 5 (int) or 6 (long) bits of the shift amount.
+    llvm::ConstantInt *amount = this->PopInt();
+    llvm::Constant *value = this->Pop();
+    uint64_t mask = value->getType()->getIntegerBitWidth() - 1;
+    this->Push(llvm::ConstantExpr::get(op, value, llvm::ConstantInt::get(value->getType(), amount->getZExtValue() & mask)));
+    return Result::kContinue;
+  }
+  Result Division(bool is_remainder) {
+    llvm::ConstantInt *rhs = this->PopInt();
+    llvm::Constant *lhs = this->Pop();
+    // Division by zero throws ArithmeticException, which has to happen at runtime.
+    if (rhs->isZero()) return Result::kUnsupported;
+    if (rhs->isMinusOne()) {
+      // MIN_VALUE / -1 overflows to MIN_VALUE in Java, but is undefined for LLVM's sdiv.
+      this->Push(is_remainder ? llvm::Constant::getNullValue(lhs->getType()) : llvm::ConstantExpr::getNeg(lhs));
+    } else {
+      this->Push(llvm::ConstantExpr::get(is_remainder ? llvm::Instruction::SRem : llvm::Instruction::SDiv, lhs, rhs));
+    }
+    return Result::kContinue;
+  }
+  Result Cast(llvm::Instruction::CastOps op, llvm::Type *dest) {
+    this->Push(llvm::ConstantExpr::getCast(op, this->Pop(), dest));
+    return Result::kContinue;
+  }
+  Result NarrowInt(llvm::Type *narrow_type, bool is_signed) {
+    llvm::Constant *narrowed = llvm::ConstantExpr::getTrunc(this->Pop(), narrow_type);
+    this->Push(is_signed ? llvm::ConstantExpr::getSExt(narrowed, this->ctx_->int32())
+                         : llvm::ConstantExpr::getZExt(narrowed, this->ctx_->int32()));
+    return Result::kContinue;
+  }
+  Result FloatToInt(llvm::IntegerType *dest) {
+    // APFloat's conversion saturates and maps NaN to zero, which is exactly Java's f2i/d2i semantics.
+    const llvm::APFloat &value = this->PopFP()->getValueAPF();
+    llvm::APSInt result(dest->getBitWidth(), false);
+    bool is_exact;
+    value.convertToInteger(result, llvm::APFloat::rmTowardZero, &is_exact);
+    this->Push(llvm::ConstantInt::get(dest, result));
+    return Result::kContinue;
+  }
+  Result LongCompare() {
+    const llvm::APInt &rhs = this->PopInt()->getValue();
+    const llvm::APInt &lhs = this->PopInt()->getValue();
+    return this->PushInt(lhs.slt(rhs) ? -1 : (lhs == rhs ? 0 : 1));
+  }
+  Result FloatCompare(int32_t nan_result) {
+    const llvm::APFloat &rhs = this->PopFP()->getValueAPF();
+    const llvm::APFloat &lhs = this->PopFP()->getValueAPF();
+    switch (lhs.compare(rhs)) {
+      case llvm::APFloat::cmpLessThan: return this->PushInt(-1);
+      case llvm::APFloat::cmpEqual: return this->PushInt(0);
+      case llvm::APFloat::cmpGreaterThan: return this->PushInt(1);
+      default: return this->PushInt(nan_result);
+    }
+  }
+
+  Result Branch(size_t inst_offset, bool condition) {
+    if (condition) this->iterator_.MoveTo(inst_offset + this->iterator_.ReadInt16(inst_offset + 1));
+    return Result::kContinue;
+  }
+  Result ZeroComparisonBranch(size_t inst_offset, llvm::CmpInst::Predicate op) {
+    llvm::ConstantInt *lhs = this->PopInt();
+    llvm::Constant *result = llvm::ConstantExpr::getICmp(op, lhs, llvm::ConstantInt::get(lhs->getType(), 0));
+    return this->Branch(inst_offset, result->isOneValue());
+  }
+  Result ComparisonBranch(size_t inst_offset, llvm::CmpInst::Predicate op) {
+    llvm::Constant *rhs = this->Pop();
+    llvm::Constant *lhs = this->Pop();
+    return this->Branch(inst_offset, llvm::ConstantExpr::getICmp(op, lhs, rhs)->isOneValue());
+  }
+
+  FieldDeclaration *GetOwnStaticField(uint16_t pool_index) const {
+    const cjbp::ConstPool &pool = this->owner_->bytecode()->const_pool();
+    if (*pool.GetFieldRefClass(pool_index) != this->owner_->name()) return nullptr;
+    const std::string &name = *pool.GetFieldRefName(pool_index);
+    const std::string &descriptor = *pool.GetFieldRefType(pool_index);
+    for (const auto &field_bytecode : this->owner_->bytecode()->fields()) {
+      if (!(field_bytecode->access_flags() & cjbp::AccessFlags::kStatic)) continue;
+      if (field_bytecode->name() != name || field_bytecode->descriptor() != descriptor) continue;
+      return this->ctx_->GetField(this->owner_->name(), name, descriptor, true);
+    }
+    return nullptr;
+  }
+  Result GetStatic(uint16_t pool_index) {
+    FieldDeclaration *field = this->GetOwnStaticField(pool_index);
+    if (field == nullptr) return Result::kUnsupported;
+    const auto &it = this->fields_.find(field);
+    this->Push(it != this->fields_.end() ? it->second
+                                         : llvm::Constant::getNullValue(field->descriptor().llvm_type(this->ctx_)));
+    return Result::kContinue;
+  }
+  Result PutStatic(uint16_t pool_index) {
+    FieldDeclaration *field = this->GetOwnStaticField(pool_index);
+    if (field == nullptr) return Result::kUnsupported;
+    llvm::Constant *value = this->Pop();
+    if (value->getType() != field->descriptor().llvm_type(this->ctx_)) return Result::kUnsupported;
+    this->fields_[field] = value;
+    return Result::kContinue;
+  }
+
+  Result Step(size_t index) {
+    cjbp::CodeIterator &it = this->iterator_;
+    uint8_t opcode = it.ReadUInt8(index);
+    switch (opcode) {
+      case Opcode::kNop: return Result::kContinue;
+
+      case Opcode::kAConstNull: this->Push(this->ctx_->pointer_null()); return Result::kContinue;
+      case Opcode::kIConstM1: return this->PushInt(-1);
+      case Opcode::kIConst0: return this->PushInt(0);
+      case Opcode::kIConst1: return this->PushInt(1);
+      case Opcode::kIConst2: return this->PushInt(2);
+      case Opcode::kIConst3: return this->PushInt(3);
+      case Opcode::kIConst4: return this->PushInt(4);
+      case Opcode::kIConst5: return this->PushInt(5);
+      case Opcode::kLConst0: return this->PushLong(0);
+      case Opcode::kLConst1: return this->PushLong(1);
+      case Opcode::kFConst0: return this->PushFP(this->ctx_->float32(), 0);
+      case Opcode::kFConst1: return this->PushFP(this->ctx_->float32(), 1);
+      case Opcode::kFConst2: return this->PushFP(this->ctx_->float32(), 2);
+      case Opcode::kDConst0: return this->PushFP(this->ctx_->float64(), 0);
+      case Opcode::kDConst1: return this->PushFP(this->ctx_->float64(), 1);
+      case Opcode::kBIPush: return this->PushInt(it.ReadInt8(index + 1));
+      case Opcode::kSIPush: return this->PushInt(it.ReadInt16(index + 1));
+      case Opcode::kLdc: return this->Ldc(it.ReadUInt8(index + 1));
+      case Opcode::kLdcW:
+      case Opcode::kLdc2W: return this->Ldc(it.ReadUInt16(index + 1));
+
+      case Opcode::kILoad:
+      case Opcode::kLLoad:
+      case Opcode::kFLoad:
+      case Opcode::kDLoad: return this->Load(it.ReadUInt8(index + 1));
+      case Opcode::kILoad0:
+      case Opcode::kLLoad0:
+      case Opcode::kFLoad0:
+      case Opcode::kDLoad0: return this->Load(0);
+      case Opcode::kILoad1:
+      case Opcode::kLLoad1:
+      case Opcode::kFLoad1:
+      case Opcode::kDLoad1: return this->Load(1);
+      case Opcode::kILoad2:
+      case Opcode::kLLoad2:
+      case Opcode::kFLoad2:
+      case Opcode::kDLoad2: return this->Load(2);
+      case Opcode::kILoad3:
+      case Opcode::kLLoad3:
+      case Opcode::kFLoad3:
+      case Opcode::kDLoad3: return this->Load(3);
+      case Opcode::kIStore:
+      case Opcode::kLStore:
+      case Opcode::kFStore:
+      case Opcode::kDStore: return this->Store(it.ReadUInt8(index + 1));
+      case Opcode::kIStore0:
+      case Opcode::kLStore0:
+      case Opcode::kFStore0:
+      case Opcode::kDStore0: return this->Store(0);
+      case Opcode::kIStore1:
+      case Opcode::kLStore1:
+      case Opcode::kFStore1:
+      case Opcode::kDStore1: return this->Store(1);
+      case Opcode::kIStore2:
+      case Opcode::kLStore2:
+      case Opcode::kFStore2:
+      case Opcode::kDStore2: return this->Store(2);
+      case Opcode::kIStore3:
+      case Opcode::kLStore3:
+      case Opcode::kFStore3:
+      case Opcode::kDStore3: return this->Store(3);
+      case Opcode::kIInc: {
+        int32_t local = it.ReadUInt8(index + 1);
+        this->Load(local);
+        this->PushInt(it.ReadInt8(index + 2));
+        this->BinaryOp(llvm::Instruction::Add);
+        return this->Store(local);
+      }
+
+      case Opcode::kPop: this->Pop(); return Result::kContinue;
+      case Opcode::kDup: {
+        llvm::Constant *top = this->Pop();
+        this->Push(top);
+        this->Push(top);
+        return Result::kContinue;
+      }
+
+      case Opcode::kIAdd:
+      case Opcode::kLAdd: return this->BinaryOp(llvm::Instruction::Add);
+      case Opcode::kISub:
+      case Opcode::kLSub: return this->BinaryOp(llvm::Instruction::Sub);
+      case Opcode::kIMul:
+      case Opcode::kLMul: return this->BinaryOp(llvm::Instruction::Mul);
+      case Opcode::kIAnd:
+      case Opcode::kLAnd: return this->BinaryOp(llvm::Instruction::And);
+      case Opcode::kIOr:
+      case Opcode::kLOr: return this->BinaryOp(llvm::Instruction::Or);
+      case Opcode::kIXor:
+      case Opcode::kLXor: return this->BinaryOp(llvm::Instruction::Xor);
+      case Opcode::kFAdd:
+      case Opcode::kDAdd: return this->BinaryOp(llvm::Instruction::FAdd);
+      case Opcode::kFSub:
+      case Opcode::kDSub: return this->BinaryOp(llvm::Instruction::FSub);
+      case Opcode::kFMul:
+      case Opcode::kDMul: return this->BinaryOp(llvm::Instruction::FMul);
+      case Opcode::kFDiv:
+      case Opcode::kDDiv: return this->BinaryOp(llvm::Instruction::FDiv);
+      case Opcode::kFRem:
+      case Opcode::kDRem: return this->BinaryOp(llvm::Instruction::FRem);
+      case Opcode::kIDiv:
+      case Opcode::kLDiv: return this->Division(false);
+      case Opcode::kIRem:
+      case Opcode::kLRem: return this->Division(true);
+      case Opcode::kIShl:
+      case Opcode::kLShl: return this->Shift(llvm::Instruction::Shl);
+      case Opcode::kIShr:
+      case Opcode::kLShr: return this->Shift(llvm::Instruction::AShr);
+      case Opcode::kIUShr:
+      case Opcode::kLUShr: return this->Shift(llvm::Instruction::LShr);
+      case Opcode::kINeg:
+      case Opcode::kLNeg: this->Push(llvm::ConstantExpr::getNeg(this->Pop())); return Result::kContinue;
+      case Opcode::kFNeg:
+      case Opcode::kDNeg: this->Push(llvm::ConstantExpr::getFNeg(this->Pop())); return Result::kContinue;
+
+      case Opcode::kI2L: return this->Cast(llvm::Instruction::SExt, this->ctx_->int64());
+      case Opcode::kI2F: return this->Cast(llvm::Instruction::SIToFP, this->ctx_->float32());
+      case Opcode::kI2D: return this->Cast(llvm::Instruction::SIToFP, this->ctx_->float64());
+      case Opcode::kL2I: return this->Cast(llvm::Instruction::Trunc, this->ctx_->int32());
+      case Opcode::kL2F: return this->Cast(llvm::Instruction::SIToFP, this->ctx_->float32());
+      case Opcode::kL2D: return this->Cast(llvm::Instruction::SIToFP, this->ctx_->float64());
+      case Opcode::kF2D: return this->Cast(llvm::Instruction::FPExt, this->ctx_->float64());
+      case Opcode::kD2F: return this->Cast(llvm::Instruction::FPTrunc, this->ctx_->float32());
+      case Opcode::kF2I:
+      case Opcode::kD2I: return this->FloatToInt(this->ctx_->int32());
+      case Opcode::kF2L:
+      case Opcode::kD2L: return this->FloatToInt(this->ctx_->int64());
+      case Opcode::kI2B: return this->NarrowInt(this->ctx_->int8(), true);
+      case Opcode::kI2C: return this->NarrowInt(this->ctx_->int16(), false);
+      case Opcode::kI2S: return this->NarrowInt(this->ctx_->int16(), true);
+
+      case Opcode::kLCmp: return this->LongCompare();
+      case Opcode::kFCmpL:
+      case Opcode::kDCmpL: return this->FloatCompare(-1);
+      case Opcode::kFCmpG:
+      case Opcode::kDCmpG: return this->FloatCompare(1);
+
+      case Opcode::kIfEq: return this->ZeroComparisonBranch(index, llvm::CmpInst::ICMP_EQ);
+      case Opcode::kIfNe: return this->ZeroComparisonBranch(index, llvm::CmpInst::ICMP_NE);
+      case Opcode::kIfLt: return this->ZeroComparisonBranch(index, llvm::CmpInst::ICMP_SLT);
+      case Opcode::kIfGe: return this->ZeroComparisonBranch(index, llvm::CmpInst::ICMP_SGE);
+      case Opcode::kIfGt: return this->ZeroComparisonBranch(index, llvm::CmpInst::ICMP_SGT);
+      case Opcode::kIfLe: return this->ZeroComparisonBranch(index, llvm::CmpInst::ICMP_SLE);
+      case Opcode::kIfICmpEq: return this->ComparisonBranch(index, llvm::CmpInst::ICMP_EQ);
+      case Opcode::kIfICmpNe: return this->ComparisonBranch(index, llvm::CmpInst::ICMP_NE);
+      case Opcode::kIfICmpLt: return this->ComparisonBranch(index, llvm::CmpInst::ICMP_SLT);
+      case Opcode::kIfICmpGe: return this->ComparisonBranch(index, llvm::CmpInst::ICMP_SGE);
+      case Opcode::kIfICmpGt: return this->ComparisonBranch(index, llvm::CmpInst::ICMP_SGT);
+      case Opcode::kIfICmpLe: return this->ComparisonBranch(index, llvm::CmpInst::ICMP_SLE);
+      case Opcode::kGoto: return this->Branch(index, true);
+
+      case Opcode::kGetStatic: return this->GetStatic(it.ReadUInt16(index + 1));
+      case Opcode::kPutStatic: return this->PutStatic(it.ReadUInt16(index + 1));
+
+      case Opcode::kReturn: return Result::kReturn;
+
+      // Everything else (calls, allocations, other classes' fields, exceptions, ...) can have effects that must be
+      // observed at runtime.
+      default: return Result::kUnsupported;
+    }
+  }
+};
+}// namespace
+
+std::optional<StaticFieldImage> EvaluateStaticInitializer(ClassInfo *owner, cjbp::Method *initializer) {
+  if (initializer->code_attribute() == nullptr) return std::nullopt;
+  StaticInitializerInterpreter interpreter(owner, initializer);
+  return interpreter.Run();
+}
+
+}// namespace magnetic
@@ -0,0 +1,36 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <map>
+#include <optional>
+
+#include <cjbp/cjbp.h>
+#include <llvm/IR/Constant.h>
+
+namespace magnetic {
+
+class ClassInfo;
+class FieldDeclaration;
+
+/**
+ * Initial values of a class's static fields, computed by running its <clinit> at compile time.
+ */
+using StaticFieldImage = std::map<FieldDeclaration *, llvm::Constant *>;
+
+/**
+ * Interprets a class's static initializer at compile time.
+ *
+ * Only initializers that are free of side effects outside the class's own static fields can be pre-executed: the
+ * initializer may compute primitive values, branch and loop over them, and read and write static fields of the class
+ * being initialized. Anything else (calls, allocations, touching other classes, exceptions) makes the initializer
+ * observable at runtime, so it must run there instead.
+ *
+ * @return the initial value of every static field the initializer writes, or std::nullopt if the initializer can't be
+ *         pre-executed.
+ */
+std::optional<StaticFieldImage> EvaluateStaticInitializer(ClassInfo *owner, cjbp::Method *initializer);
+
+}// namespace magnetic
@@ -6,6 +6,10 @@
 
 #include <string>
 
+#include <llvm/ADT/Triple.h>
+#include <llvm/IR/Module.h>
+
+#include "codegen/runtime-abi.h"
 #include "context/context.h"
 #include "context/exception.h"
 #include "method.h"
@@ -14,55 +18,105 @@
 namespace magnetic {
 
 namespace {
-std::string GetVirtualMethodKey(const std::string &name, const std::string &descriptor) { return name + descriptor; }
-std::string GetVirtualMethodKey(MethodDeclaration *method) {
-  return GetVirtualMethodKey(method->name(), method->raw_descriptor());
+/**
+ * @return a function that aborts with the method's name, to fill the vtable slot of a method that isn't compiled
+ */
+llvm::Function *GetUnreachableMethodStub(Context *ctx, llvm::Module *module, MethodDeclaration *method) {
+  std::string mangled_name =
+      ctx->name_mangler()->MangleMethodName(method->class_name(), method->name(), method->raw_descriptor()) +
+      ".unreachable";
+  llvm::Function *stub = module->getFunction(mangled_name);
+  if (stub != nullptr) return stub;
+
+  // The stub ignores the arguments it is called with, so it can stand in for a method of any signature.
+  llvm::FunctionType *stub_type = llvm::FunctionType::get(ctx->void_type(), llvm::None, false);
+  stub = llvm::Function::Create(stub_type, llvm::GlobalValue::LinkOnceODRLinkage, mangled_name, module);
+  stub->setVisibility(llvm::GlobalValue::HiddenVisibility);
+  if (llvm::Triple(module->getTargetTriple()).supportsCOMDAT()) {
+    stub->setComdat(module->getOrInsertComdat(mangled_name));
+  }
+  stub->addFnAttr(llvm::Attribute::Cold);
+  stub->addFnAttr(llvm::Attribute::NoReturn);
+  stub->addFnAttr(llvm::Attribute::NoUnwind);
+
+  llvm::IRBuilder<> builder(llvm::BasicBlock::Create(*ctx->llvm_ctx(), "entry", stub));
+  std::string java_name = method->class_name() + "." + method->name() + method->raw_descriptor();
+  ctx->runtime_abi()->EmitUnreachableMethod(builder, java_name);
+  return stub;
 }
 }// namespace
 
 VTable VTable::CreateVTableForBaseClass(Context *ctx, const std::string &class_name) { return {ctx, class_name}; }
 VTable::VTable(Context *ctx, const std::string &class_name)
-    : ctx_(ctx), layout_(ctx->ptr_type()), subclass_(class_name), base_class_(class_name), vtable_(nullptr), methods_(),
-      entries_() {}
+    : ctx_(ctx), layout_(ctx->ptr_type()), subclass_(ctx->symbols().Intern(class_name)), base_class_(subclass_),
+      super_vtable_(nullptr), is_shared_(false), vtable_(nullptr), slots_(), methods_() {}
 
 VTable VTable::CreateVTableForSubClass(const VTable &base_vtable, std::string subclass) {
   return {base_vtable, std::move(subclass)};
 }
 VTable::VTable(const VTable &base_vtable, std::string subclass)
-    : ctx_(base_vtable.ctx_), layout_(base_vtable.layout_), subclass_(std::move(subclass)),
-      base_class_(base_vtable.base_class_), vtable_(nullptr), methods_(), entries_() {
-  this->entries_.reserve(base_vtable.entries_.size());
-  for (const auto &entry : base_vtable.entries_) { this->entries_.push_back(entry->Copy(this)); }
+    : ctx_(base_vtable.ctx_), layout_(base_vtable.layout_), subclass_(base_vtable.ctx_->symbols().Intern(subclass)),
+      base_class_(base_vtable.base_class_), super_vtable_(&base_vtable), is_shared_(false), vtable_(nullptr),
+      slots_(base_vtable.slots_), methods_(base_vtable.methods_) {}
+
+std::string VTable::GetMangledName() const {
+  if (this->is_shared_) return this->super_vtable_->GetMangledName();
+  return this->ctx_->name_mangler()->MangleVTableName(*this->subclass_, *this->base_class_);
 }
 
 void VTable::EmitDefinition(llvm::Module *module) {
+  if (this->super_vtable_ != nullptr && this->methods_ == this->super_vtable_->methods_) this->is_shared_ = true;
+  std::string mangled_name = this->GetMangledName();
+  this->vtable_ = module->getNamedGlobal(mangled_name);
+  if (this->vtable_ != nullptr) return;
+
   std::vector<llvm::Constant *> values{};
-  values.reserve(this->entries_.size());
-  for (const auto &entry : this->entries_) { values.push_back(entry->value(module)); }
+  values.reserve(this->methods_.size());
+  for (MethodDeclaration *method : this->methods_) {
+    // Unreachable methods aren't compiled. Their slots should never be called through, because either the class is
+    // never instantiated or the method is never called; if the analysis missed a way in, the stub says which method.
+    if (method->IsReachable()) {
+      values.push_back(method->GetFunctionInModule(module));
+    } else {
+      values.push_back(GetUnreachableMethodStub(this->ctx_, module, method));
+    }
+  }
 
+  // Any module can emit a copy of a vtable, and the linker keeps one of them.
   llvm::ArrayType *array_type = llvm::ArrayType::get(this->ctx_->ptr_type(), values.size());
   llvm::Constant *const_array = llvm::ConstantArray::get(array_type, values);
-  std::string mangled_name = this->ctx_->name_mangler()->MangleVTableName(this->subclass_, this->base_class_);
-  this->vtable_ =
-      new llvm::GlobalVariable(*module, array_type, true, llvm::GlobalValue::PrivateLinkage, const_array, mangled_name);
+  this->vtable_ = new llvm::GlobalVariable(*module, array_type, true, llvm::GlobalValue::LinkOnceODRLinkage,
+                                           const_array, mangled_name);
+  this->vtable_->setVisibility(llvm::GlobalValue::HiddenVisibility);
+  if (llvm::Triple(module->getTargetTriple()).supportsCOMDAT()) {
+    this->vtable_->setComdat(module->getOrInsertComdat(mangled_name));
+  }
+}
+
+std::optional<int32_t> VTable::FindSlot(const std::string &name, const std::string &descriptor) const {
+  const SymbolTable &symbols = this->ctx_->symbols();
+  SlotKey key{symbols.Find(name), symbols.Find(descriptor)};
+  // A name that was never interned isn't the name of any declared method.
+  if (key.first == nullptr || key.second == nullptr) return std::nullopt;
+  const auto &it = this->slots_.find(key);
+  if (it == this->slots_.end()) return std::nullopt;
+  return it->second;
 }
 
 bool VTable::HasMethod(const std::string &name, const std::string &descriptor) const {
-  std::string key = GetVirtualMethodKey(name, descriptor);
-  return (this->methods_.find(key) != this->methods_.end());
+  return this->FindSlot(name, descriptor).has_value();
 }
 void VTable::MaybeAddVirtualMethod(MethodDeclaration *method) {
   if (!method->IsVirtual()) return;
 
-  std::string key = GetVirtualMethodKey(method);
-  const auto &it = this->methods_.find(key);
-  if (it != this->methods_.end()) {
-    it->second->set_method(method);
+  SymbolTable &symbols = this->ctx_->symbols();
+  SlotKey key{symbols.Intern(method->name()), symbols.Intern(method->raw_descriptor())};
+  const auto &it = this->slots_.find(key);
+  if (it != this->slots_.end()) {
+    this->methods_[it->second] = method;
   } else {
-    int32_t index = this->GetNextEntryIndex();
-    auto entry = std::make_unique<VirtualMethodEntry>(index, method);
-    this->methods_.emplace(std::move(key), entry.get());
-    this->entries_.push_back(std::move(entry));
+    this->slots_.try_emplace(key, static_cast<int32_t>(this->methods_.size()));
+    this->methods_.push_back(method);
   }
 }
 
@@ -71,18 +125,22 @@ llvm::Value *VTable::EmitVirtualLookup(llvm::IRBuilder<> &builder, Value object_
   assert(object_ref.type == Type::kObject);
   assert(object_ref.value != nullptr);
 
-  std::string key = GetVirtualMethodKey(name, descriptor);
-  const auto &it = this->methods_.find(key);
-  if (it == this->methods_.end()) throw BadBytecode("could not find virtual method " + key);
-  VirtualMethodEntry *entry = it->second;
+  std::optional<int32_t> slot = this->FindSlot(name, descriptor);
+  if (!slot.has_value()) throw BadBytecode("could not find virtual method " + name + descriptor);
 
-  llvm::Value *vtable_gep = this->layout_.EmitGEP(builder, object_ref.value, "vtable_gep");
-  llvm::Value *vtable_ptr = builder.CreateLoad(this->ctx_->ptr_type(), vtable_gep, "vtable_ptr");
+  llvm::Value *vtable_ptr = this->EmitLoadVTablePointer(builder, object_ref);
   llvm::Value *method_gep =
-      builder.CreateConstInBoundsGEP1_32(this->ctx_->ptr_type(), vtable_ptr, entry->index(), "method_gep");
+      builder.CreateConstInBoundsGEP1_32(this->ctx_->ptr_type(), vtable_ptr, *slot, "method_gep");
   llvm::Value *method = builder.CreateLoad(this->ctx_->ptr_type(), method_gep, "method");
   return method;
 }
+llvm::Value *VTable::EmitLoadVTablePointer(llvm::IRBuilder<> &builder, Value object_ref) const {
+  assert(object_ref.type == Type::kObject);
+  assert(object_ref.value != nullptr);
+
+  llvm::Value *vtable_gep = this->layout_.EmitGEP(builder, object_ref.value, "vtable_gep");
+  return builder.CreateLoad(this->ctx_->ptr_type(), vtable_gep, "vtable_ptr");
+}
 void VTable::EmitStoreVTablePointer(llvm::IRBuilder<> &builder, Value object_ref) const {
   assert(this->vtable_ != nullptr);
   assert(object_ref.type == Type::kObject);
@@ -92,19 +150,4 @@ void VTable::EmitStoreVTablePointer(llvm::IRBuilder<> &builder, Value object_ref
   builder.CreateStore(this->vtable_, vtable_gep);
 }
 
-int32_t VTable::GetNextEntryIndex() const { return static_cast<int32_t>(this->entries_.size()); }
-
-VTable::Entry::Entry(int32_t index) : index_(index) {}
-VTable::VirtualMethodEntry::VirtualMethodEntry(int32_t index, MethodDeclaration *method)
-    : Entry(index), method_(method) {}
-llvm::Constant *VTable::VirtualMethodEntry::value(llvm::Module *module) const {
-  return this->method_->GetFunctionInModule(module);
-}
-std::unique_ptr<VTable::Entry> VTable::VirtualMethodEntry::Copy(VTable *new_vtable) const {
-  std::string key = GetVirtualMethodKey(this->method_);
-  auto new_entry = std::make_unique<VTable::VirtualMethodEntry>(this->index(), this->method_);
-  new_vtable->methods_.emplace(std::move(key), new_entry.get());
-  return new_entry;
-}
-
 }// namespace magnetic
@@ -4,10 +4,12 @@
 
 #pragma once
 
-#include <map>
-#include <memory>
+#include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/IR/GlobalVariable.h>
 #include <llvm/IR/Value.h>
 
@@ -32,58 +34,54 @@ class VTable {
 
   [[nodiscard]] StructElementLayoutSpecifier &layout() { return this->layout_; }
 
+  /**
+   * Emits the vtable in the class's module. A class whose slots all hold the same methods as its super class's (such
+   * as a leaf class that overrides nothing) shares its super class's vtable instead of getting its own.
+   */
   void EmitDefinition(llvm::Module *module);
 
   [[nodiscard]] bool HasMethod(const std::string &name, const std::string &descriptor) const;
+  /**
+   * Gives the method a slot, or puts it in the slot of the method that it overrides. Only virtual methods (see
+   * MethodDeclaration::IsVirtual) have slots; all other calls are direct.
+   */
   void MaybeAddVirtualMethod(MethodDeclaration *method);
 
   [[nodiscard]] llvm::Value *EmitVirtualLookup(llvm::IRBuilder<> &builder, Value object_ref, const std::string &name,
                                                const std::string &descriptor) const;
+  /**
+   * Emits IR that loads the object's vtable pointer, which identifies its class.
+   */
+  [[nodiscard]] llvm::Value *EmitLoadVTablePointer(llvm::IRBuilder<> &builder, Value object_ref) const;
   void EmitStoreVTablePointer(llvm::IRBuilder<> &builder, Value object_ref) const;
 
- private:
-  class Entry {
-   public:
-    explicit Entry(int32_t index);
-    Entry(const Entry &) = delete;
-    Entry &operator=(const Entry &) = delete;
-    Entry(Entry &&) = delete;
-    Entry &operator=(Entry &&) = delete;
-    virtual ~Entry() noexcept = default;
-
-    [[nodiscard]] int32_t index() const { return this->index_; }
-    [[nodiscard]] virtual llvm::Constant *value(llvm::Module *module) const = 0;
-
-    [[nodiscard]] virtual std::unique_ptr<Entry> Copy(VTable *new_vtable) const = 0;
-
-   private:
-    int32_t index_;
-  };
-  class VirtualMethodEntry : public Entry {
-   public:
-    VirtualMethodEntry(int32_t index, MethodDeclaration *method);
-    ~VirtualMethodEntry() noexcept override = default;
-
-    void set_method(MethodDeclaration *method) { this->method_ = method; }
-    [[nodiscard]] MethodDeclaration *method() const { return this->method_; }
-    [[nodiscard]] llvm::Constant *value(llvm::Module *module) const override;
-
-    [[nodiscard]] std::unique_ptr<Entry> Copy(VTable *new_vtable) const override;
-
-   private:
-    MethodDeclaration *method_;
-  };
+  /**
+   * @return nullptr until the vtable's definition has been emitted
+   */
+  [[nodiscard]] llvm::GlobalVariable *global() const { return this->vtable_; }
+  /**
+   * @return true if the class uses its super class's vtable
+   */
+  [[nodiscard]] bool is_shared() const { return this->is_shared_; }
 
+ private:
   Context *ctx_;
   StructElementLayoutSpecifier layout_;
 
-  std::string subclass_;
-  std::string base_class_;
+  // Slots are keyed by the method's interned name and descriptor, so a sub class's copy of its super class's slots
+  // copies no strings.
+  using SlotKey = std::pair<const std::string *, const std::string *>;
+
+  const std::string *subclass_;
+  const std::string *base_class_;
+  const VTable *super_vtable_;// Can be nullptr.
+  bool is_shared_;
   llvm::GlobalVariable *vtable_;
-  std::map<std::string, VirtualMethodEntry *> methods_;
-  std::vector<std::unique_ptr<Entry>> entries_;
+  llvm::DenseMap<SlotKey, int32_t> slots_;
+  std::vector<MethodDeclaration *> methods_;// Indexed by slot.
 
-  [[nodiscard]] int32_t GetNextEntryIndex() const;
+  [[nodiscard]] std::optional<int32_t> FindSlot(const std::string &name, const std::string &descriptor) const;
+  [[nodiscard]] std::string GetMangledName() const;
 };
 
 }// namespace magnetic
@@ -47,6 +47,9 @@ class SimpleNameMangler : public NameMangler {
   [[nodiscard]] std::string MangleInstantiatorName(const std::string_view class_name) const override {
     return "new@@" + this->MangleFullyQualifiedClassName(class_name);
   }
+  [[nodiscard]] std::string MangleClassLockName(const std::string_view class_name) const override {
+    return "lock@@" + this->MangleFullyQualifiedClassName(class_name);
+  }
 
  private:
   static std::string MangleReference(const std::string_view class_name, const std::string_view name,
@@ -143,6 +146,10 @@ class JNINameMangler : public NameMangler {
     // Not defined in JNI
     return "Magnetic_new_" + this->MangleFullyQualifiedClassName(class_name);
   }
+  [[nodiscard]] std::string MangleClassLockName(const std::string_view class_name) const override {
+    // Not defined in JNI
+    return "Magnetic_lock_" + this->MangleFullyQualifiedClassName(class_name);
+  }
 
  private:
   static bool IsValidCIdentifier(char c) { return std::isalnum(c) || (c == '_'); }
@@ -33,6 +33,7 @@ class NameMangler {
   [[nodiscard]] virtual std::string MangleInstanceFieldSetter(std::string_view class_name, std::string_view name,
                                                               std::string_view descriptor) const = 0;
   [[nodiscard]] virtual std::string MangleInstantiatorName(std::string_view class_name) const = 0;
+  [[nodiscard]] virtual std::string MangleClassLockName(std::string_view class_name) const = 0;
 
  protected:
   NameMangler() = default;
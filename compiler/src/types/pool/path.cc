@@ -8,26 +8,61 @@
 #include <cassert>
 #include <filesystem>
 #include <fstream>
+#include <iterator>
+#include <optional>
+#include <string_view>
 
 #include <zip/zip.h>
 
 namespace magnetic {
 
 namespace {
+constexpr std::string_view kClassFileExtension = ".class";
+
+/**
+ * @return the name of the class stored at the path (relative to the class path's root), or std::nullopt if the path
+ *         isn't a class file
+ */
+std::optional<std::string> GetClassNameFromPath(std::string path) {
+  if (path.size() <= kClassFileExtension.size()) return std::nullopt;
+  if (path.compare(path.size() - kClassFileExtension.size(), kClassFileExtension.size(), kClassFileExtension) != 0) {
+    return std::nullopt;
+  }
+  path.resize(path.size() - kClassFileExtension.size());
+  std::replace(path.begin(), path.end(), '/', '.');
+  return path;
+}
+
 class CompositeClassPath : public ClassPath {
  public:
   explicit CompositeClassPath(std::vector<std::unique_ptr<ClassPath>> paths) : paths_(std::move(paths)) {}
   ~CompositeClassPath() noexcept override = default;
 
   /**
-   * @return nullptr if the class isn't in this class path.
+   * @return the contents of the class file, or std::nullopt if the class isn't in this class path.
    */
-  std::unique_ptr<cjbp::DataInputStream> Find(const std::string &name) override {
+  std::optional<std::vector<uint8_t>> Find(const std::string &name) override {
     for (const auto &path : this->paths_) {
-      auto stream = path->Find(name);
-      if (stream != nullptr) return stream;
+      std::optional<std::vector<uint8_t>> class_file = path->Find(name);
+      if (class_file.has_value()) return class_file;
     }
-    return nullptr;
+    return std::nullopt;
+  }
+
+  std::vector<std::string> ListClassNames() override {
+    std::vector<std::string> names{};
+    for (const auto &path : this->paths_) {
+      std::vector<std::string> path_names = path->ListClassNames();
+      names.insert(names.end(), path_names.begin(), path_names.end());
+    }
+    return names;
+  }
+
+  std::unique_ptr<ClassPath> Clone() const override {
+    std::vector<std::unique_ptr<ClassPath>> paths{};
+    paths.reserve(this->paths_.size());
+    for (const auto &path : this->paths_) { paths.push_back(path->Clone()); }
+    return std::make_unique<CompositeClassPath>(std::move(paths));
   }
 
  private:
@@ -40,37 +75,50 @@ class DirectoryClassPath : public ClassPath {
   ~DirectoryClassPath() noexcept override = default;
 
   /**
-   * @return nullptr if the class isn't in this class path.
+   * @return the contents of the class file, or std::nullopt if the class isn't in this class path.
    */
-  std::unique_ptr<cjbp::DataInputStream> Find(const std::string &name) override {
+  std::optional<std::vector<uint8_t>> Find(const std::string &name) override {
     std::string rel_path = name;
     std::replace(rel_path.begin(), rel_path.end(), '.', '/');
     rel_path.append(".class");
     std::filesystem::path full_path = (this->path_ / rel_path);
 
-    auto ifs = std::make_unique<std::ifstream>(full_path, std::ios::in | std::ios::binary);
-    if (ifs->fail()) return nullptr;
-    return std::make_unique<cjbp::FileInputStream>(std::move(ifs));
+    std::ifstream ifs(full_path, std::ios::in | std::ios::binary);
+    if (ifs.fail()) return std::nullopt;
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
   }
 
+  std::vector<std::string> ListClassNames() override {
+    std::vector<std::string> names{};
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(this->path_)) {
+      if (!entry.is_regular_file()) continue;
+      std::string relative_path = entry.path().lexically_relative(this->path_).generic_string();
+      std::optional<std::string> name = GetClassNameFromPath(std::move(relative_path));
+      if (name.has_value()) names.push_back(std::move(*name));
+    }
+    return names;
+  }
+
+  std::unique_ptr<ClassPath> Clone() const override { return std::make_unique<DirectoryClassPath>(*this); }
+
  private:
   std::filesystem::path path_;
 };
 
 class JarClassPath : public ClassPath {
  public:
-  explicit JarClassPath(const std::string &path) { this->zip_ = zip_open(path.c_str(), 0, 'r'); }
+  explicit JarClassPath(const std::string &path) : path_(path) { this->zip_ = zip_open(path.c_str(), 0, 'r'); }
   ~JarClassPath() noexcept override { zip_close(this->zip_); }
 
   /**
-   * @return nullptr if the class isn't in this class path.
+   * @return the contents of the class file, or std::nullopt if the class isn't in this class path.
    */
-  std::unique_ptr<cjbp::DataInputStream> Find(const std::string &name) override {
+  std::optional<std::vector<uint8_t>> Find(const std::string &name) override {
     std::string path = name;
     std::replace(path.begin(), path.end(), '.', '/');
     path.append(".class");
 
-    std::unique_ptr<cjbp::DataInputStream> stream;
+    std::optional<std::vector<uint8_t>> class_file;
     zip_entry_open(this->zip_, path.c_str());
 
     size_t bufsize = zip_entry_size(this->zip_);
@@ -78,13 +126,29 @@ class JarClassPath : public ClassPath {
     ssize_t result = zip_entry_noallocread(this->zip_, buf.data(), bufsize);
     if (result >= 0) {
       assert(result == bufsize);
-      stream = std::make_unique<cjbp::ByteInputStream>(std::move(buf));
+      class_file = std::move(buf);
     }
     zip_entry_close(this->zip_);
-    return stream;
+    return class_file;
   }
 
+  std::vector<std::string> ListClassNames() override {
+    std::vector<std::string> names{};
+    ssize_t entry_count = zip_entries_total(this->zip_);
+    for (ssize_t i = 0; i < entry_count; ++i) {
+      if (zip_entry_openbyindex(this->zip_, i) != 0) continue;
+      std::optional<std::string> name = GetClassNameFromPath(zip_entry_name(this->zip_));
+      if (name.has_value()) names.push_back(std::move(*name));
+      zip_entry_close(this->zip_);
+    }
+    return names;
+  }
+
+  // Each copy has its own zip handle, which keeps its own position in the jar.
+  std::unique_ptr<ClassPath> Clone() const override { return std::make_unique<JarClassPath>(this->path_); }
+
  private:
+  std::string path_;
   zip_t *zip_;
 };
 }// namespace
@@ -4,12 +4,12 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
-#include <cjbp/cjbp.h>
-
 namespace magnetic {
 
 class ClassPath {
@@ -21,9 +21,20 @@ class ClassPath {
   virtual ~ClassPath() noexcept = default;
 
   /**
-   * @return nullptr if the class isn't in this class path.
+   * @return the contents of the class file, or std::nullopt if the class isn't in this class path.
+   */
+  virtual std::optional<std::vector<uint8_t>> Find(const std::string &name) = 0;
+
+  /**
+   * @return the names of every class in this class path (e.g. "java.lang.Object")
+   */
+  virtual std::vector<std::string> ListClassNames() = 0;
+
+  /**
+   * Opens the class path again, for another thread to read from. A class path can't be read from by several threads at
+   * once.
    */
-  virtual std::unique_ptr<cjbp::DataInputStream> Find(const std::string &name) = 0;
+  [[nodiscard]] virtual std::unique_ptr<ClassPath> Clone() const = 0;
 };
 
 }// namespace magnetic
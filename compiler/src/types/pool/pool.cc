@@ -4,31 +4,73 @@
 
 #include "pool.h"
 
+#include <algorithm>
 #include <memory>
-
-#include <cjbp/cjbp.h>
+#include <optional>
+#include <vector>
 
 #include "class/class.h"
 #include "context/context.h"
+#include "context/statistics.h"
+#include "prefetch.h"
 
 namespace magnetic {
 
+ClassPool::ClassPool(std::unique_ptr<ClassPath> path)
+    : ctx_(nullptr), path_(std::move(path)), classes_(), prefetcher_(nullptr) {}
 ClassPool::~ClassPool() noexcept = default;
 
 ClassInfo *ClassPool::Get(const std::string &class_name) {
+  ClassInfo *clazz = this->Load(class_name);
+  if (clazz != nullptr) clazz->EmitDefinition();
+  return clazz;
+}
+
+ClassInfo *ClassPool::Load(const std::string &class_name) {
   const auto &it = this->classes_.find(class_name);
   if (it != this->classes_.end()) return it->second.get();
 
-  std::unique_ptr<cjbp::DataInputStream> stream = this->path_->Find(class_name);
-  if (stream == nullptr) return nullptr;
-  auto class_bytecode = std::make_unique<cjbp::Class>(*stream);
+  std::optional<ParsedClass> parsed;
+  if (this->prefetcher_ != nullptr) {
+    CompileStatistics::Scope scope(this->ctx_->statistics(), CompilePhase::kClassPathLookup, class_name);
+    ClassPrefetcher::Result result = this->prefetcher_->Take(class_name);
+    if (result.status == ClassPrefetcher::Status::kNotFound) return nullptr;
+    parsed = std::move(result.parsed);
+  }
+  if (!parsed.has_value()) {
+    std::optional<std::vector<uint8_t>> class_file;
+    {
+      CompileStatistics::Scope scope(this->ctx_->statistics(), CompilePhase::kClassPathLookup, class_name);
+      class_file = this->path_->Find(class_name);
+    }
+    if (!class_file.has_value()) return nullptr;
+    CompileStatistics::Scope scope(this->ctx_->statistics(), CompilePhase::kClassParsing, class_name);
+    parsed = ParsedClass::Parse(std::move(*class_file), this->GetParseOptions());
+  }
 
-  auto unique_class = std::make_unique<ClassInfo>(this->ctx_, std::move(class_bytecode),
+  auto unique_class = std::make_unique<ClassInfo>(this->ctx_, std::move(parsed->bytecode),
                                                   this->ctx_->CreateCompilationUnitForClass(class_name));
-  this->classes_.emplace(class_name, std::move(unique_class));
-  ClassInfo *clazz = this->classes_.at(class_name).get();
-  clazz->EmitDefinition();
-  return clazz;
+  unique_class->set_debug_attributes(std::move(parsed->debug_attributes));
+  unique_class->set_method_bodies(std::move(parsed->method_bodies));
+  unique_class->set_content_hash(parsed->content_hash);
+  return this->classes_.emplace(class_name, std::move(unique_class)).first->second.get();
+}
+
+std::vector<ClassInfo *> ClassPool::GetLoadedClasses() const {
+  std::vector<ClassInfo *> classes{};
+  classes.reserve(this->classes_.size());
+  for (const auto &[class_name, clazz] : this->classes_) { classes.push_back(clazz.get()); }
+  std::sort(classes.begin(), classes.end(),
+            [](ClassInfo *lhs, ClassInfo *rhs) { return lhs->name() < rhs->name(); });
+  return classes;
+}
+
+void ClassPool::StartPrefetching(const std::vector<std::string> &first_classes, uint32_t thread_count) {
+  this->prefetcher_ = ClassPrefetcher::Start(*this->path_, first_classes, this->GetParseOptions(), thread_count);
+}
+
+ClassParseOptions ClassPool::GetParseOptions() const {
+  return {this->ctx_->emit_debug_info(), this->ctx_->lazy_method_bodies()};
 }
 
 }// namespace magnetic
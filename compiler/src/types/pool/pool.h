@@ -6,6 +6,7 @@
 
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include "path.h"
 
@@ -13,16 +14,37 @@ namespace magnetic {
 
 class Context;
 class ClassInfo;
+class ClassPrefetcher;
+struct ClassParseOptions;
 
 class ClassPool {
  public:
-  explicit ClassPool(std::unique_ptr<ClassPath> path) : ctx_(nullptr), path_(std::move(path)), classes_() {}
+  explicit ClassPool(std::unique_ptr<ClassPath> path);
   ~ClassPool() noexcept;
 
   /**
+   * Loads the class and emits its definition.
+   *
    * @return nullptr if the class doesn't exist
    */
   ClassInfo *Get(const std::string &class_name);
+  /**
+   * Loads the class without emitting it, for analyses that only need its bytecode.
+   *
+   * @return nullptr if the class doesn't exist
+   */
+  ClassInfo *Load(const std::string &class_name);
+
+  /**
+   * @return every class that has been loaded, sorted by name
+   */
+  [[nodiscard]] std::vector<ClassInfo *> GetLoadedClasses() const;
+
+  /**
+   * Starts loading the given classes, and the classes that they refer to, on background threads (see
+   * ClassPrefetcher). Must be called after the context's debug info and lazy method body options are set.
+   */
+  void StartPrefetching(const std::vector<std::string> &first_classes, uint32_t thread_count);
 
   Context *ctx() const { return this->ctx_; }
   void set_ctx(Context *ctx) { this->ctx_ = ctx; }
@@ -31,6 +53,9 @@ class ClassPool {
   Context *ctx_;
   std::unique_ptr<ClassPath> path_;
   std::unordered_map<std::string, std::unique_ptr<ClassInfo>> classes_;
+  std::unique_ptr<ClassPrefetcher> prefetcher_;// Can be nullptr.
+
+  [[nodiscard]] ClassParseOptions GetParseOptions() const;
 };
 
 }// namespace magnetic
@@ -0,0 +1,150 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "prefetch.h"
+
+#include <algorithm>
+
+#include <llvm/Support/xxhash.h>
+
+namespace magnetic {
+
+namespace {
+/**
+ * Classes are asked for both as "java/lang/Object" and as "java.lang.Object".
+ */
+std::string NormalizeClassName(std::string class_name) {
+  std::replace(class_name.begin(), class_name.end(), '/', '.');
+  return class_name;
+}
+}// namespace
+
+ParsedClass ParsedClass::Parse(std::vector<uint8_t> class_file, ClassParseOptions options) {
+  // The constant pool's count follows the magic number and the version.
+  constexpr size_t kConstPoolCountOffset = 8;
+  uint16_t const_pool_count = 0;
+  if (class_file.size() >= kConstPoolCountOffset + 2) {
+    const_pool_count = (class_file[kConstPoolCountOffset] << 8) | class_file[kConstPoolCountOffset + 1];
+  }
+
+  ParsedClass parsed{};
+  // Hashed before the method bodies are split off, which changes the bytes.
+  parsed.content_hash = llvm::xxHash64(llvm::makeArrayRef(class_file));
+  if (options.read_debug_attributes) {
+    parsed.debug_attributes = std::make_unique<ClassDebugAttributes>(ClassDebugAttributes::Read(class_file));
+  }
+  // Line numbers are in the Code attributes, so they must be read before the bodies are split off.
+  if (options.split_method_bodies) parsed.method_bodies = LazyMethodBodies::Extract(class_file);
+  cjbp::ByteInputStream stream(std::move(class_file));
+  parsed.bytecode = std::make_unique<cjbp::Class>(stream);
+
+  const cjbp::ConstPool &pool = parsed.bytecode->const_pool();
+  for (uint16_t i = 1; i < const_pool_count; ++i) {
+    if (pool.GetTag(i) != cjbp::ConstTag::kClass) continue;
+    const std::string *class_name = pool.GetClassName(i);
+    // Array classes aren't loaded from the class path.
+    if (class_name != nullptr && !class_name->empty() && (*class_name)[0] != '[') {
+      parsed.referenced_classes.push_back(*class_name);
+    }
+  }
+  return parsed;
+}
+
+std::unique_ptr<ClassPrefetcher> ClassPrefetcher::Start(const ClassPath &path,
+                                                        const std::vector<std::string> &class_names,
+                                                        ClassParseOptions options, uint32_t thread_count) {
+  auto prefetcher = std::make_unique<ClassPrefetcher>(class_names, options);
+  for (uint32_t i = 0; i < thread_count; ++i) {
+    prefetcher->threads_.emplace_back(&ClassPrefetcher::RunThread, prefetcher.get(), path.Clone());
+  }
+  return prefetcher;
+}
+ClassPrefetcher::ClassPrefetcher(const std::vector<std::string> &class_names, ClassParseOptions options)
+    : options_(options), mutex_(), loaded_(), taken_(), queue_(), next_(0), entries_(), queued_names_(),
+      untaken_count_(0), is_stopping_(false), threads_() {
+  for (const std::string &class_name : class_names) { this->Enqueue(class_name); }
+}
+ClassPrefetcher::~ClassPrefetcher() noexcept {
+  {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    this->is_stopping_ = true;
+  }
+  this->taken_.notify_all();
+  for (std::thread &thread : this->threads_) { thread.join(); }
+}
+
+ClassPrefetcher::Result ClassPrefetcher::Take(const std::string &class_name) {
+  std::unique_lock<std::mutex> lock(this->mutex_);
+  const auto &it = this->entries_.find(NormalizeClassName(class_name));
+  if (it == this->entries_.end()) return {Status::kNotPrefetched, std::nullopt};
+  // Loading the class here is faster than waiting for it to reach the front of the queue.
+  if (it->second.state == State::kQueued) {
+    this->entries_.erase(it);
+    return {Status::kNotPrefetched, std::nullopt};
+  }
+
+  Entry &entry = it->second;
+  this->loaded_.wait(lock, [&entry]() { return entry.state == State::kLoaded; });
+  std::exception_ptr error = entry.error;
+  std::optional<ParsedClass> parsed = std::move(entry.parsed);
+  this->entries_.erase(it);
+  if (parsed.has_value() || error != nullptr) {
+    --this->untaken_count_;
+    this->taken_.notify_one();
+  }
+  lock.unlock();
+
+  if (error != nullptr) std::rethrow_exception(error);
+  if (!parsed.has_value()) return {Status::kNotFound, std::nullopt};
+  return {Status::kLoaded, std::move(parsed)};
+}
+
+std::optional<std::string> ClassPrefetcher::NextQueued() {
+  std::unique_lock<std::mutex> lock(this->mutex_);
+  this->taken_.wait(lock, [this]() { return this->is_stopping_ || this->untaken_count_ < kMaxUntakenClasses; });
+  while (!this->is_stopping_ && this->next_ < this->queue_.size()) {
+    const std::string &class_name = this->queue_[this->next_++];
+    const auto &it = this->entries_.find(class_name);
+    // The compiler already took the class and loaded it itself.
+    if (it == this->entries_.end()) continue;
+    it->second.state = State::kLoading;
+    return class_name;
+  }
+  return std::nullopt;
+}
+
+void ClassPrefetcher::Enqueue(const std::string &class_name) {
+  std::string name = NormalizeClassName(class_name);
+  if (!this->queued_names_.insert(name).second) return;
+  this->entries_.emplace(name, Entry{State::kQueued, std::nullopt, nullptr});
+  this->queue_.push_back(std::move(name));
+}
+
+void ClassPrefetcher::RunThread(std::unique_ptr<ClassPath> path) {
+  while (std::optional<std::string> class_name = this->NextQueued()) {
+    std::optional<ParsedClass> parsed;
+    std::exception_ptr error;
+    try {
+      std::optional<std::vector<uint8_t>> class_file = path->Find(*class_name);
+      if (class_file.has_value()) parsed = ParsedClass::Parse(std::move(*class_file), this->options_);
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(this->mutex_);
+      if (parsed.has_value()) {
+        for (const std::string &referenced_class : parsed->referenced_classes) { this->Enqueue(referenced_class); }
+      }
+      if (parsed.has_value() || error != nullptr) ++this->untaken_count_;
+      Entry &entry = this->entries_.at(*class_name);
+      entry.state = State::kLoaded;
+      entry.parsed = std::move(parsed);
+      entry.error = error;
+    }
+    this->loaded_.notify_all();
+  }
+}
+
+}// namespace magnetic
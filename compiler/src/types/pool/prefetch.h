@@ -0,0 +1,119 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <cjbp/cjbp.h>
+
+#include "class/debug-attributes.h"
+#include "class/method-bodies.h"
+#include "path.h"
+
+namespace magnetic {
+
+struct ClassParseOptions {
+  bool read_debug_attributes;
+  bool split_method_bodies;
+};
+
+/**
+ * A class file that has been read and parsed, but not yet made into a ClassInfo.
+ */
+struct ParsedClass {
+  std::unique_ptr<cjbp::Class> bytecode;
+  std::unique_ptr<ClassDebugAttributes> debug_attributes;// Can be nullptr.
+  std::unique_ptr<LazyMethodBodies> method_bodies;// Can be nullptr.
+  uint64_t content_hash;
+  std::vector<std::string> referenced_classes;// Named in the constant pool, e.g. "java/lang/Object".
+
+  /**
+   * Parses the class file. Doesn't use the context, so it can be called from any thread.
+   */
+  [[nodiscard]] static ParsedClass Parse(std::vector<uint8_t> class_file, ClassParseOptions options);
+};
+
+/**
+ * Reads, inflates and parses classes on background threads, ahead of the compiler asking for them, so that disk and
+ * decompression latency overlap with code generation.
+ *
+ * Only classes that the compiler is likely to ask for are loaded: the classes that it was started with, then the
+ * classes named in the constant pools of the classes that have been loaded, breadth first. At most
+ * kMaxUntakenClasses classes are kept loaded and waiting to be taken; the threads wait for the compiler to catch up
+ * before loading more.
+ *
+ * Each thread reads from its own copy of the class path, since a jar's zip handle can't be shared between threads.
+ */
+class ClassPrefetcher {
+ public:
+  static constexpr size_t kMaxUntakenClasses = 256;
+
+  enum class Status {
+    kLoaded,
+    kNotFound,     // The class isn't in the class path.
+    kNotPrefetched,// No thread has loaded the class, so the caller has to load it itself.
+  };
+  struct Result {
+    Status status;
+    std::optional<ParsedClass> parsed;// Only set if the status is kLoaded.
+  };
+
+  static std::unique_ptr<ClassPrefetcher> Start(const ClassPath &path, const std::vector<std::string> &class_names,
+                                                ClassParseOptions options, uint32_t thread_count);
+
+  ClassPrefetcher(const std::vector<std::string> &class_names, ClassParseOptions options);
+  ~ClassPrefetcher() noexcept;
+
+  /**
+   * Takes a prefetched class, waiting for it if a thread is loading it. A class that no thread has started on yet is
+   * left to the caller to load, rather than waiting for the threads to get to it.
+   */
+  [[nodiscard]] Result Take(const std::string &class_name);
+
+ private:
+  enum class State { kQueued, kLoading, kLoaded };
+  struct Entry {
+    State state;
+    std::optional<ParsedClass> parsed;// std::nullopt if the class isn't in the class path.
+    std::exception_ptr error;// Thrown again by Take if the class couldn't be parsed.
+  };
+
+  ClassParseOptions options_;
+
+  std::mutex mutex_;
+  std::condition_variable loaded_;
+  std::condition_variable taken_;
+  std::vector<std::string> queue_;
+  size_t next_;
+  std::unordered_map<std::string, Entry> entries_;// Taken classes are removed.
+  std::unordered_set<std::string> queued_names_;// Every class that was ever queued, so none is queued twice.
+  size_t untaken_count_;// Classes that were found and loaded, but not taken yet.
+  bool is_stopping_;
+
+  std::vector<std::thread> threads_;
+
+  void RunThread(std::unique_ptr<ClassPath> path);
+  /**
+   * Waits until fewer than kMaxUntakenClasses classes are waiting to be taken.
+   * @return the next class that no thread has started on, or std::nullopt if there are none left
+   */
+  [[nodiscard]] std::optional<std::string> NextQueued();
+  /**
+   * Must be called with the mutex held.
+   */
+  void Enqueue(const std::string &class_name);
+};
+
+}// namespace magnetic
@@ -0,0 +1,190 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "harness.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+  int warmup_iterations = 5;
+  int measured_iterations = 10;
+  int64_t iteration_time_ms = 1000;
+  // Each iteration is split into about this many timed batches, which are the samples that percentiles are taken over.
+  int batches_per_iteration = 100;
+  std::string filter{};
+  std::string json_path{};
+};
+
+struct Result {
+  const char *name;
+  std::vector<double> batch_ns_per_op;
+  int64_t total_ops;
+  double total_seconds;
+};
+
+// Benchmark results are folded into this so that their computation stays live.
+volatile int64_t blackhole = 0;
+
+void PrintUsage(const char *program) {
+  std::fprintf(stderr,
+               "usage: %s [-w warmup iterations] [-i measured iterations] [-t iteration time in ms] "
+               "[-f name filter] [-j json output path]\n",
+               program);
+}
+
+bool ParseOptions(int argc, char **argv, Options &options) {
+  for (int i = 1; i < argc; ++i) {
+    if (i + 1 >= argc || argv[i][0] != '-' || std::strlen(argv[i]) != 2) return false;
+    const char *value = argv[++i];
+    switch (argv[i - 1][1]) {
+      case 'w': options.warmup_iterations = std::atoi(value); break;
+      case 'i': options.measured_iterations = std::atoi(value); break;
+      case 't': options.iteration_time_ms = std::atoll(value); break;
+      case 'f': options.filter = value; break;
+      case 'j': options.json_path = value; break;
+      default: return false;
+    }
+  }
+  return options.warmup_iterations >= 0 && options.measured_iterations > 0 && options.iteration_time_ms > 0;
+}
+
+void RunBatch(const MagneticBenchmark &benchmark, int64_t ops) {
+  int64_t sink = 0;
+  switch (benchmark.kind) {
+    case kReturnsVoid: {
+      auto function = reinterpret_cast<void (*)()>(benchmark.function);
+      for (int64_t i = 0; i < ops; ++i) function();
+      break;
+    }
+    case kReturnsInt: {
+      auto function = reinterpret_cast<int32_t (*)()>(benchmark.function);
+      for (int64_t i = 0; i < ops; ++i) sink ^= function();
+      break;
+    }
+    case kReturnsLong: {
+      auto function = reinterpret_cast<int64_t (*)()>(benchmark.function);
+      for (int64_t i = 0; i < ops; ++i) sink ^= function();
+      break;
+    }
+  }
+  blackhole = blackhole ^ sink;
+}
+
+double TimeBatch(const MagneticBenchmark &benchmark, int64_t ops) {
+  Clock::time_point start = Clock::now();
+  RunBatch(benchmark, ops);
+  return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+/**
+ * Doubles the batch size until a batch takes at least the target time, so that timer overhead is negligible.
+ */
+int64_t CalibrateBatchSize(const MagneticBenchmark &benchmark, double target_batch_ns) {
+  int64_t ops = 1;
+  while (TimeBatch(benchmark, ops) < target_batch_ns && ops < (int64_t{1} << 40)) ops *= 2;
+  return ops;
+}
+
+void RunIteration(const MagneticBenchmark &benchmark, const Options &options, int64_t batch_ops, Result *result) {
+  Clock::time_point end = Clock::now() + std::chrono::milliseconds(options.iteration_time_ms);
+  while (Clock::now() < end) {
+    double ns = TimeBatch(benchmark, batch_ops);
+    if (result == nullptr) continue;
+    result->batch_ns_per_op.push_back(ns / static_cast<double>(batch_ops));
+    result->total_ops += batch_ops;
+    result->total_seconds += ns / 1e9;
+  }
+}
+
+Result RunBenchmark(const MagneticBenchmark &benchmark, const Options &options) {
+  double target_batch_ns = static_cast<double>(options.iteration_time_ms) * 1e6 / options.batches_per_iteration;
+  int64_t batch_ops = CalibrateBatchSize(benchmark, target_batch_ns);
+
+  Result result{benchmark.name, {}, 0, 0};
+  for (int i = 0; i < options.warmup_iterations; ++i) RunIteration(benchmark, options, batch_ops, nullptr);
+  for (int i = 0; i < options.measured_iterations; ++i) RunIteration(benchmark, options, batch_ops, &result);
+  std::sort(result.batch_ns_per_op.begin(), result.batch_ns_per_op.end());
+  return result;
+}
+
+double Percentile(const std::vector<double> &sorted, double percentile) {
+  if (sorted.empty()) return 0;
+  auto index = static_cast<size_t>(percentile / 100 * static_cast<double>(sorted.size() - 1) + 0.5);
+  return sorted[std::min(index, sorted.size() - 1)];
+}
+
+double Mean(const Result &result) {
+  return result.total_ops == 0 ? 0 : result.total_seconds * 1e9 / static_cast<double>(result.total_ops);
+}
+
+double OpsPerSecond(const Result &result) {
+  return result.total_seconds == 0 ? 0 : static_cast<double>(result.total_ops) / result.total_seconds;
+}
+
+void PrintTable(const std::vector<Result> &results) {
+  std::printf("%-48s %12s %12s %12s %12s %16s\n", "benchmark", "mean ns/op", "p50", "p90", "p99", "ops/s");
+  for (const Result &result : results) {
+    std::printf("%-48s %12.2f %12.2f %12.2f %12.2f %16.0f\n", result.name, Mean(result),
+                Percentile(result.batch_ns_per_op, 50), Percentile(result.batch_ns_per_op, 90),
+                Percentile(result.batch_ns_per_op, 99), OpsPerSecond(result));
+  }
+}
+
+/**
+ * Writes the results as JSON, tagged with the configuration that the benchmarks were compiled with, so that runs of
+ * the same benchmarks compiled at different optimization levels can be compared.
+ */
+bool WriteJson(const std::string &path, const std::vector<Result> &results) {
+  FILE *file = std::fopen(path.c_str(), "w");
+  if (file == nullptr) return false;
+  std::fprintf(file, "{\"configuration\": \"%s\", \"benchmarks\": [", Magnetic_bench_configuration);
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result &result = results[i];
+    std::fprintf(file,
+                 "%s\n  {\"name\": \"%s\", \"mean_ns\": %.3f, \"p50_ns\": %.3f, \"p90_ns\": %.3f, \"p99_ns\": %.3f, "
+                 "\"ops_per_second\": %.1f, \"samples\": %zu}",
+                 i == 0 ? "" : ",", result.name, Mean(result), Percentile(result.batch_ns_per_op, 50),
+                 Percentile(result.batch_ns_per_op, 90), Percentile(result.batch_ns_per_op, 99), OpsPerSecond(result),
+                 result.batch_ns_per_op.size());
+  }
+  std::fprintf(file, "\n]}\n");
+  return std::fclose(file) == 0;
+}
+
+}// namespace
+
+int main(int argc, char **argv) {
+  Options options{};
+  if (!ParseOptions(argc, argv, options)) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  std::printf("configuration: %s\n", Magnetic_bench_configuration);
+  std::vector<Result> results{};
+  for (int32_t i = 0; i < Magnetic_bench_table_size; ++i) {
+    const MagneticBenchmark &benchmark = Magnetic_bench_table[i];
+    if (!options.filter.empty() && std::strstr(benchmark.name, options.filter.c_str()) == nullptr) continue;
+    std::fprintf(stderr, "running %s\n", benchmark.name);
+    results.push_back(RunBenchmark(benchmark, options));
+  }
+
+  PrintTable(results);
+  if (!options.json_path.empty() && !WriteJson(options.json_path, results)) {
+    std::fprintf(stderr, "could not write %s\n", options.json_path.c_str());
+    return 1;
+  }
+  return 0;
+}
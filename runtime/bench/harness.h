@@ -0,0 +1,26 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * What a benchmark method returns. The result is consumed by the harness so that the optimizer can't delete the work
+ * that produced it.
+ */
+enum MagneticBenchmarkKind : uint32_t { kReturnsVoid = 0, kReturnsInt = 1, kReturnsLong = 2 };
+
+/**
+ * An entry of the table that magnetic_vm -benchmark-table emits (see compiler/src/codegen/benchmark-table.h).
+ */
+struct MagneticBenchmark {
+  const char *name;
+  void *function;
+  MagneticBenchmarkKind kind;
+};
+
+extern "C" const MagneticBenchmark Magnetic_bench_table[];
+extern "C" const int32_t Magnetic_bench_table_size;
+extern "C" const char *const Magnetic_bench_configuration;
@@ -0,0 +1,187 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "allocation.h"
+
+#include <semaphore.h>
+#include <signal.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+thread_local int64_t Magnetic_rt_allocation_budget = 0;
+
+namespace {
+
+constexpr int64_t kDefaultSampleInterval = 512 * 1024;
+
+std::atomic<int64_t> sample_interval{kDefaultSampleInterval};
+
+thread_local bool has_budget = false;
+thread_local std::minstd_rand random_engine{std::random_device{}()};
+
+int64_t DrawSampleInterval() {
+  // Exponentially distributed intervals make every allocated byte equally likely to be sampled, whatever the
+  // allocation pattern (a fixed interval would keep sampling the same allocation in a periodic loop).
+  std::exponential_distribution<double> distribution(1.0 / static_cast<double>(sample_interval.load()));
+  return static_cast<int64_t>(distribution(random_engine)) + 1;
+}
+
+struct AllocationCounts {
+  uint64_t samples = 0;
+  double bytes = 0;
+  double objects = 0;
+};
+
+using AllocationSamples = std::map<std::pair<std::string, std::string>, AllocationCounts>;// By (class, site).
+struct SampleTable {
+  std::mutex mutex;
+  AllocationSamples samples;// Guarded by mutex.
+};
+
+SampleTable &GetSampleTable() {
+  // Never destroyed, since threads can still allocate, and the histogram is written by an atexit handler, after the
+  // static destructors of other files may have run.
+  static auto *table = new SampleTable();
+  return *table;
+}
+std::mutex &GetWriteMutex() {
+  // Never destroyed, for the same reason as the sample table.
+  static auto *mutex = new std::mutex();
+  return *mutex;
+}
+
+/**
+ * A function-local static, since it is set while the runtime starts up, from the static initializers of another file.
+ */
+std::string &GetHistogramPath() {
+  static std::string path;
+  return path;
+}
+sem_t dump_requested;
+
+void HandleDumpSignal(int) {
+  // Writing the histogram isn't async-signal-safe, so the dumper thread does it.
+  sem_post(&dump_requested);
+}
+
+void RunDumper() {
+  sigset_t signals;
+  sigfillset(&signals);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+  while (true) {
+    if (sem_wait(&dump_requested) != 0) continue;
+    Magnetic_rt_write_allocation_profile(GetHistogramPath().c_str());
+  }
+}
+
+void WriteHistogramAtExit() { Magnetic_rt_write_allocation_profile(GetHistogramPath().c_str()); }
+
+}// namespace
+
+void Magnetic_rt_sample_allocation(const char *class_name, int64_t size, const char *site) {
+  // Budgets start at zero, so a thread's first allocation only draws its first interval.
+  if (!has_budget) {
+    has_budget = true;
+    Magnetic_rt_allocation_budget = DrawSampleInterval();
+    return;
+  }
+  Magnetic_rt_allocation_budget = DrawSampleInterval();
+
+  // An allocation of `size` bytes is sampled with probability 1 - e^(-size / interval), so each sample stands for
+  // size / (1 - e^(-size / interval)) bytes of allocations like it.
+  auto interval = static_cast<double>(sample_interval.load(std::memory_order_relaxed));
+  double bytes = static_cast<double>(size) / -std::expm1(-static_cast<double>(size) / interval);
+
+  SampleTable &table = GetSampleTable();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  AllocationCounts &counts = table.samples[{class_name, site}];
+  ++counts.samples;
+  counts.bytes += bytes;
+  counts.objects += bytes / static_cast<double>(size);
+}
+
+void Magnetic_rt_set_allocation_sample_interval(int64_t bytes) {
+  if (bytes > 0) sample_interval.store(bytes, std::memory_order_relaxed);
+}
+
+bool Magnetic_rt_write_allocation_profile(const char *path) {
+  // The dumper thread and the atexit handler can write at the same time, and would otherwise write the same temporary
+  // file. The snapshot is taken while holding the lock, so that the last histogram written is also the newest.
+  std::lock_guard<std::mutex> write_lock(GetWriteMutex());
+  AllocationSamples snapshot;
+  {
+    SampleTable &table = GetSampleTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    snapshot = table.samples;
+  }
+
+  std::map<std::string, AllocationCounts> by_class{};
+  std::vector<std::pair<std::string, AllocationCounts>> by_site{};
+  for (const auto &[key, counts] : snapshot) {
+    AllocationCounts &class_counts = by_class[key.first];
+    class_counts.samples += counts.samples;
+    class_counts.bytes += counts.bytes;
+    class_counts.objects += counts.objects;
+    by_site.emplace_back(key.first + " <- " + key.second, counts);
+  }
+  std::vector<std::pair<std::string, AllocationCounts>> classes(by_class.begin(), by_class.end());
+  auto by_bytes = [](const auto &lhs, const auto &rhs) { return lhs.second.bytes > rhs.second.bytes; };
+  std::sort(classes.begin(), classes.end(), by_bytes);
+  std::sort(by_site.begin(), by_site.end(), by_bytes);
+
+  // Written to a temporary file first, so that readers never see a partially written histogram.
+  std::string temporary_path = std::string(path) + ".tmp";
+  FILE *file = std::fopen(temporary_path.c_str(), "w");
+  if (file == nullptr) return false;
+  int64_t interval = sample_interval.load(std::memory_order_relaxed);
+  std::fprintf(file, "# sampled every %" PRId64 " bytes on average\n", interval);
+  std::fprintf(file, "%16s %16s %10s  %s\n", "objects", "bytes", "samples", "class");
+  for (const auto &[name, counts] : classes) {
+    std::fprintf(file, "%16.0f %16.0f %10" PRIu64 "  %s\n", counts.objects, counts.bytes, counts.samples,
+                 name.c_str());
+  }
+  std::fprintf(file, "\n%16s %16s %10s  %s\n", "objects", "bytes", "samples", "class <- allocation site");
+  for (const auto &[name, counts] : by_site) {
+    std::fprintf(file, "%16.0f %16.0f %10" PRIu64 "  %s\n", counts.objects, counts.bytes, counts.samples,
+                 name.c_str());
+  }
+  if (std::fclose(file) != 0) return false;
+  return std::rename(temporary_path.c_str(), path) == 0;
+}
+
+bool StartAllocationProfilerIfRequested() {
+  const char *request = std::getenv("MAGNETIC_ALLOCATION_PROFILE");
+  if (request == nullptr) return false;
+
+  std::string &histogram_path = GetHistogramPath();
+  histogram_path = request;
+  size_t separator = histogram_path.rfind(':');
+  if (separator != std::string::npos) {
+    Magnetic_rt_set_allocation_sample_interval(std::atoll(histogram_path.c_str() + separator + 1));
+    histogram_path.resize(separator);
+  }
+
+  sem_init(&dump_requested, 0, 0);
+  std::thread(RunDumper).detach();
+  struct sigaction action {};
+  action.sa_handler = HandleDumpSignal;
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGUSR2, &action, nullptr);
+  std::atexit(WriteHistogramAtExit);
+  return true;
+}
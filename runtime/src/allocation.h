@@ -0,0 +1,40 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Bytes the thread may allocate before its next allocation is sampled. Instantiators compiled with magnetic_vm
+ * -allocation-profiling subtract the size of every object from it, and call Magnetic_rt_sample_allocation once it
+ * goes negative.
+ */
+extern "C" thread_local int64_t Magnetic_rt_allocation_budget;
+
+/**
+ * Records a sampled allocation of a `class_name` object at `site` (the allocating method and the bytecode index of its
+ * new instruction, e.g. "Main.main([Ljava/lang/String;)V@4"), then refills the thread's budget.
+ */
+extern "C" void Magnetic_rt_sample_allocation(const char *class_name, int64_t size, const char *site);
+
+/**
+ * Sets the mean number of bytes a thread allocates between samples (512 KiB by default). Smaller intervals give more
+ * precise profiles at a higher cost.
+ */
+extern "C" void Magnetic_rt_set_allocation_sample_interval(int64_t bytes);
+
+/**
+ * Writes the heap histogram: the estimated number and size of the objects allocated so far, by class and by allocation
+ * site. The estimates scale each sample by the inverse of the probability that it was sampled.
+ * @return false if the file couldn't be written
+ */
+extern "C" bool Magnetic_rt_write_allocation_profile(const char *path);
+
+/**
+ * Runtime-internal. If the MAGNETIC_ALLOCATION_PROFILE environment variable is set (to "<path>" or
+ * "<path>:<interval in bytes>"), writes the heap histogram to the path whenever the process receives SIGUSR2, and
+ * when it exits.
+ */
+bool StartAllocationProfilerIfRequested();
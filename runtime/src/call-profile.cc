@@ -0,0 +1,329 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "call-profile.h"
+
+#include <signal.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "symbols.h"
+
+// Layouts of what magnetic_vm -call-profiling emits into the magnetic_call_profile and magnetic_vtables sections.
+struct MagneticCallProfileRecord {
+  uint32_t kind;
+  uint32_t offset;// Of the record's counters in the module's counters.
+  const char *name;
+  const char *target;
+};
+struct MagneticCallProfileModule {
+  int64_t *(*counters)();// Returns the calling thread's counters.
+  uint64_t counter_count;
+  uint64_t record_count;
+  const MagneticCallProfileRecord *records;
+};
+struct MagneticVTableName {
+  const void *vtable;
+  const char *class_name;
+};
+
+// Defined by the linker around the sections. Weak, since the sections only exist if some of the program was compiled
+// with -call-profiling.
+extern "C" __attribute__((weak)) const MagneticCallProfileModule __start_magnetic_call_profile[];
+extern "C" __attribute__((weak)) const MagneticCallProfileModule __stop_magnetic_call_profile[];
+extern "C" __attribute__((weak)) const MagneticVTableName __start_magnetic_vtables[];
+extern "C" __attribute__((weak)) const MagneticVTableName __stop_magnetic_vtables[];
+
+namespace {
+
+constexpr uint32_t kMethodEntryRecord = 0;
+constexpr uint32_t kReceiversRecord = 1;
+constexpr int kOtherReceiversCounter = kMagneticReceiverRows * 2;
+
+constexpr int kDefaultWriteIntervalSeconds = 10;
+
+struct RecordCounts {
+  uint64_t count = 0;// Entries, or the receivers that didn't fit in a histogram.
+  std::map<const void *, uint64_t> receivers{};
+};
+/**
+ * Counts of every record of every module, indexed like the magnetic_call_profile section and the modules' records.
+ */
+using ProfileCounts = std::vector<std::vector<RecordCounts>>;
+
+int64_t ReadCounter(const int64_t &counter) { return __atomic_load_n(&counter, __ATOMIC_RELAXED); }
+
+struct ThreadCounters {
+  std::vector<const int64_t *> modules;// By module.
+  bool is_attached = false;
+
+  ~ThreadCounters() noexcept;
+};
+
+thread_local ThreadCounters thread_counters;
+
+/**
+ * The counters of every attached thread. A thread's counters are thread-local variables, which are freed when the
+ * thread exits, so an exiting thread first adds its counts to the retired counts.
+ */
+class CounterRegistry {
+ public:
+  CounterRegistry() : modules_(), live_threads_(), retired_counts_() {
+    if (__start_magnetic_call_profile == nullptr || __stop_magnetic_call_profile == nullptr) return;
+    for (const MagneticCallProfileModule *module = __start_magnetic_call_profile;
+         module < __stop_magnetic_call_profile; ++module) {
+      this->modules_.push_back(module);
+    }
+    this->retired_counts_ = this->CreateEmptyCounts();
+  }
+
+  [[nodiscard]] const std::vector<const MagneticCallProfileModule *> &modules() const { return this->modules_; }
+
+  void Attach(ThreadCounters *thread) {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    for (const MagneticCallProfileModule *module : this->modules_) { thread->modules.push_back(module->counters()); }
+    this->live_threads_.insert(thread);
+  }
+  void Retire(ThreadCounters *thread) {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    this->AddCounts(*thread, this->retired_counts_);
+    this->live_threads_.erase(thread);
+  }
+
+  [[nodiscard]] ProfileCounts Snapshot() {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    ProfileCounts counts = this->retired_counts_;
+    for (const ThreadCounters *thread : this->live_threads_) { this->AddCounts(*thread, counts); }
+    return counts;
+  }
+
+ private:
+  std::vector<const MagneticCallProfileModule *> modules_;
+  std::mutex mutex_;
+  std::unordered_set<const ThreadCounters *> live_threads_;// Guarded by mutex_.
+  ProfileCounts retired_counts_;                           // Guarded by mutex_.
+
+  [[nodiscard]] ProfileCounts CreateEmptyCounts() const {
+    ProfileCounts counts{};
+    counts.reserve(this->modules_.size());
+    for (const MagneticCallProfileModule *module : this->modules_) { counts.emplace_back(module->record_count); }
+    return counts;
+  }
+
+  void AddCounts(const ThreadCounters &thread, ProfileCounts &counts) const {
+    for (size_t i = 0; i < this->modules_.size(); ++i) {
+      const MagneticCallProfileModule &module = *this->modules_[i];
+      for (uint64_t j = 0; j < module.record_count; ++j) {
+        const MagneticCallProfileRecord &record = module.records[j];
+        const int64_t *counters = thread.modules[i] + record.offset;
+        RecordCounts &record_counts = counts[i][j];
+        if (record.kind == kMethodEntryRecord) {
+          record_counts.count += ReadCounter(counters[0]);
+          continue;
+        }
+        if (record.kind != kReceiversRecord) continue;
+
+        // Rows are claimed in order, so the first free row ends the histogram.
+        for (int row = 0; row < kMagneticReceiverRows; ++row) {
+          auto *vtable = reinterpret_cast<const void *>(ReadCounter(counters[row * 2]));
+          if (vtable == nullptr) break;
+          record_counts.receivers[vtable] += ReadCounter(counters[row * 2 + 1]);
+        }
+        record_counts.count += ReadCounter(counters[kOtherReceiversCounter]);
+      }
+    }
+  }
+};
+
+CounterRegistry &GetCounterRegistry() {
+  // Never destroyed, since threads can still exit (and retire their counters) while the process is exiting.
+  static auto *registry = new CounterRegistry();
+  return *registry;
+}
+
+ThreadCounters::~ThreadCounters() noexcept {
+  if (this->is_attached) GetCounterRegistry().Retire(this);
+}
+
+const char *GetClassName(const void *vtable) {
+  // Never destroyed, since the profile is also written by an atexit handler.
+  static const auto *class_names = []() {
+    auto *names = new std::unordered_map<const void *, const char *>();
+    if (__start_magnetic_vtables == nullptr || __stop_magnetic_vtables == nullptr) return names;
+    for (const MagneticVTableName *entry = __start_magnetic_vtables; entry < __stop_magnetic_vtables; ++entry) {
+      names->emplace(entry->vtable, entry->class_name);
+    }
+    return names;
+  }();
+  const auto &it = class_names->find(vtable);
+  return (it != class_names->end()) ? it->second : nullptr;
+}
+
+const char *GetPolymorphism(const RecordCounts &counts) {
+  if (counts.count != 0) return "megamorphic";
+  if (counts.receivers.size() == 1) return "monomorphic";
+  if (counts.receivers.size() == 2) return "bimorphic";
+  return "polymorphic";
+}
+
+/**
+ * A function-local static, since it is set while the runtime starts up, from the static initializers of another file.
+ */
+std::string &GetProfilePath() {
+  static std::string path;
+  return path;
+}
+int write_interval_seconds = kDefaultWriteIntervalSeconds;
+std::mutex &GetWriteMutex() {
+  // Never destroyed, since the profile is also written by an atexit handler.
+  static auto *mutex = new std::mutex();
+  return *mutex;
+}
+
+void RunWriter() {
+  sigset_t signals;
+  sigfillset(&signals);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+  while (true) {
+    std::this_thread::sleep_for(std::chrono::seconds(write_interval_seconds));
+    Magnetic_rt_write_call_profile(GetProfilePath().c_str());
+  }
+}
+
+void WriteProfileAtExit() { Magnetic_rt_write_call_profile(GetProfilePath().c_str()); }
+
+}// namespace
+
+void Magnetic_rt_record_receiver(int64_t *histogram, const void *vtable) {
+  auto receiver = reinterpret_cast<int64_t>(vtable);
+  for (int row = 0; row < kMagneticReceiverRows; ++row) {
+    int64_t *row_vtable = &histogram[row * 2];
+    if (*row_vtable == 0) {
+      // The count is stored before the vtable, so that a reader never pairs the new class with a stale count.
+      __atomic_store_n(&histogram[row * 2 + 1], 1, __ATOMIC_RELAXED);
+      __atomic_store_n(row_vtable, receiver, __ATOMIC_RELEASE);
+      return;
+    }
+    if (*row_vtable == receiver) {
+      ++histogram[row * 2 + 1];
+      return;
+    }
+  }
+  ++histogram[kOtherReceiversCounter];
+}
+
+void Magnetic_rt_visit_call_profile(MagneticCallProfileVisitor visitor, void *data) {
+  CounterRegistry &registry = GetCounterRegistry();
+  ProfileCounts counts = registry.Snapshot();
+  for (size_t i = 0; i < registry.modules().size(); ++i) {
+    const MagneticCallProfileModule &module = *registry.modules()[i];
+    for (uint64_t j = 0; j < module.record_count; ++j) {
+      const MagneticCallProfileRecord &record = module.records[j];
+      const RecordCounts &record_counts = counts[i][j];
+      if (record.kind == kMethodEntryRecord) {
+        visitor(record.name, nullptr, nullptr, record_counts.count, data);
+        continue;
+      }
+      for (const auto &[vtable, count] : record_counts.receivers) {
+        const char *class_name = GetClassName(vtable);
+        visitor(record.name, record.target, (class_name != nullptr) ? class_name : "(unknown class)", count, data);
+      }
+      if (record_counts.count != 0) visitor(record.name, record.target, nullptr, record_counts.count, data);
+    }
+  }
+}
+
+bool Magnetic_rt_write_call_profile(const char *path) {
+  // The writer thread and the atexit handler can write at the same time, and would otherwise write the same temporary
+  // file. The counters are read while holding the lock, so that the last profile written is also the newest.
+  std::lock_guard<std::mutex> write_lock(GetWriteMutex());
+  struct Site {
+    const char *name;
+    const char *target;
+    uint64_t total;
+    RecordCounts counts;
+  };
+  std::vector<std::pair<uint64_t, const char *>> methods{};
+  std::vector<Site> sites{};
+  CounterRegistry &registry = GetCounterRegistry();
+  ProfileCounts counts = registry.Snapshot();
+  for (size_t i = 0; i < registry.modules().size(); ++i) {
+    const MagneticCallProfileModule &module = *registry.modules()[i];
+    for (uint64_t j = 0; j < module.record_count; ++j) {
+      const MagneticCallProfileRecord &record = module.records[j];
+      RecordCounts &record_counts = counts[i][j];
+      if (record.kind == kMethodEntryRecord) {
+        if (record_counts.count != 0) methods.emplace_back(record_counts.count, record.name);
+        continue;
+      }
+      uint64_t total = record_counts.count;
+      for (const auto &[vtable, count] : record_counts.receivers) { total += count; }
+      if (total != 0) sites.push_back({record.name, record.target, total, std::move(record_counts)});
+    }
+  }
+  std::sort(methods.begin(), methods.end(), [](const auto &lhs, const auto &rhs) { return lhs.first > rhs.first; });
+  std::sort(sites.begin(), sites.end(), [](const Site &lhs, const Site &rhs) { return lhs.total > rhs.total; });
+
+  // Written to a temporary file first, so that readers never see a partially written profile.
+  std::string temporary_path = std::string(path) + ".tmp";
+  FILE *file = std::fopen(temporary_path.c_str(), "w");
+  if (file == nullptr) return false;
+  std::fprintf(file, "# method entries\n");
+  for (const auto &[count, name] : methods) { std::fprintf(file, "%16" PRIu64 "  %s\n", count, name); }
+  std::fprintf(file, "\n# virtual call sites\n");
+  for (const Site &site : sites) {
+    std::fprintf(file, "%16" PRIu64 "  %s -> %s (%s)\n", site.total, site.name, site.target,
+                 GetPolymorphism(site.counts));
+    std::vector<std::pair<uint64_t, const void *>> receivers{};
+    for (const auto &[vtable, count] : site.counts.receivers) { receivers.emplace_back(count, vtable); }
+    std::sort(receivers.begin(), receivers.end(), [](const auto &lhs, const auto &rhs) { return lhs > rhs; });
+    for (const auto &[count, vtable] : receivers) {
+      const char *class_name = GetClassName(vtable);
+      auto address = reinterpret_cast<uintptr_t>(vtable);
+      std::string receiver = (class_name != nullptr) ? class_name : DescribeAddress(address);
+      std::fprintf(file, "%16" PRIu64 "    %5.1f%%  %s\n", count, 100.0 * count / site.total, receiver.c_str());
+    }
+    if (site.counts.count != 0) {
+      std::fprintf(file, "%16" PRIu64 "    %5.1f%%  (other classes)\n", site.counts.count,
+                   100.0 * site.counts.count / site.total);
+    }
+  }
+  if (std::fclose(file) != 0) return false;
+  return std::rename(temporary_path.c_str(), path) == 0;
+}
+
+void AttachCallCounters() {
+  if (thread_counters.is_attached || GetCounterRegistry().modules().empty()) return;
+  thread_counters.is_attached = true;
+  GetCounterRegistry().Attach(&thread_counters);
+}
+
+bool StartCallProfilerIfRequested() {
+  const char *request = std::getenv("MAGNETIC_CALL_PROFILE");
+  if (request == nullptr) return false;
+
+  std::string &profile_path = GetProfilePath();
+  profile_path = request;
+  size_t separator = profile_path.rfind(':');
+  if (separator != std::string::npos) {
+    write_interval_seconds = std::max(1, std::atoi(profile_path.c_str() + separator + 1));
+    profile_path.resize(separator);
+  }
+
+  std::thread(RunWriter).detach();
+  std::atexit(WriteProfileAtExit);
+  return true;
+}
@@ -0,0 +1,56 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Rows of {vtable, count} in the receiver histogram of a virtual call site. Must match
+ * CallProfileEmitter::kReceiverRows in the compiler.
+ */
+constexpr int kMagneticReceiverRows = 4;
+
+/**
+ * Called by virtual call sites compiled with magnetic_vm -call-profiling when the receiver's class isn't the one in
+ * the first row of the site's histogram. Counts the receiver in its row, claiming a free row for a new class, or in
+ * the count of receivers that didn't fit once all rows are taken.
+ * @param histogram the calling thread's histogram of the site
+ */
+extern "C" void Magnetic_rt_record_receiver(int64_t *histogram, const void *vtable);
+
+/**
+ * Receives the call profile one count at a time.
+ * @param name a method, or for receiver counts, a virtual call site ("<method>@<bytecode offset>")
+ * @param target the method that the virtual call site calls, or nullptr for method entry counts
+ * @param receiver the class of the receivers counted, or nullptr for method entry counts and for the receivers that
+ *        didn't fit in the site's histogram
+ */
+typedef void (*MagneticCallProfileVisitor)(const char *name, const char *target, const char *receiver, uint64_t count,
+                                           void *data);
+
+/**
+ * Reports the method entry counts and the receiver histograms, summed over every thread. Running threads keep
+ * counting while they are read, so their counts may be slightly behind.
+ */
+extern "C" void Magnetic_rt_visit_call_profile(MagneticCallProfileVisitor visitor, void *data);
+
+/**
+ * Writes the call profile: methods by entry count, then virtual call sites by call count, each with its receiver
+ * classes and whether it is monomorphic, bimorphic, polymorphic or megamorphic.
+ * @return false if the file couldn't be written
+ */
+extern "C" bool Magnetic_rt_write_call_profile(const char *path);
+
+/**
+ * Runtime-internal. Adds the calling thread's counters to the call profile; their counts stay in the profile after the
+ * thread exits. Called when a thread attaches, so threads that never call into the runtime aren't counted.
+ */
+void AttachCallCounters();
+
+/**
+ * Runtime-internal. If the MAGNETIC_CALL_PROFILE environment variable is set (to "<path>" or "<path>:<seconds>"),
+ * rewrites the call profile at the path every 10 seconds (or the given number of seconds), and when the process exits.
+ */
+bool StartCallProfilerIfRequested();
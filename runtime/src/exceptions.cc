@@ -0,0 +1,36 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "exceptions.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "thread.h"
+
+namespace {
+
+/**
+ * Compiled code has no exception tables, so no handler can catch a runtime exception: it is reported the way the JVM
+ * reports an uncaught exception, and the process aborts.
+ */
+[[noreturn]] void ThrowUncaught(const char *exception_class, const char *message) {
+  std::fprintf(stderr, "Exception in thread \"%s\" %s: %s\n", Magnetic_rt_thread_current()->name, exception_class,
+               message);
+  std::abort();
+}
+
+}// namespace
+
+void Magnetic_rt_throw_division_by_zero() { ThrowUncaught("java.lang.ArithmeticException", "/ by zero"); }
+void Magnetic_rt_throw_illegal_thread_state() { ThrowUncaught("java.lang.IllegalThreadStateException", ""); }
+void Magnetic_rt_throw_null_pointer() { ThrowUncaught("java.lang.NullPointerException", ""); }
+void Magnetic_rt_throw_illegal_monitor_state() {
+  ThrowUncaught("java.lang.IllegalMonitorStateException", "current thread is not owner");
+}
+void Magnetic_rt_throw_out_of_memory(const char *message) { ThrowUncaught("java.lang.OutOfMemoryError", message); }
+void Magnetic_rt_unreachable_method(const char *method_name) {
+  std::fprintf(stderr, "magnetic-vm: called %s, which reachability analysis found unreachable\n", method_name);
+  std::abort();
+}
@@ -0,0 +1,39 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+// Exceptions thrown by the runtime can't be caught yet (see ThrowUncaught in exceptions.cc): they end the process after
+// printing the exception and the name of the thread that threw it.
+
+/**
+ * Throws java.lang.ArithmeticException("/ by zero") for idiv, irem, ldiv and lrem.
+ */
+extern "C" [[noreturn]] void Magnetic_rt_throw_division_by_zero();
+
+/**
+ * Throws java.lang.IllegalThreadStateException for Thread.start on a thread that was already started.
+ */
+extern "C" [[noreturn]] void Magnetic_rt_throw_illegal_thread_state();
+
+/**
+ * Throws java.lang.NullPointerException, e.g. for monitorenter and monitorexit on null.
+ */
+extern "C" [[noreturn]] void Magnetic_rt_throw_null_pointer();
+
+/**
+ * Throws java.lang.IllegalMonitorStateException for monitorexit on a monitor that the thread doesn't own.
+ */
+extern "C" [[noreturn]] void Magnetic_rt_throw_illegal_monitor_state();
+
+/**
+ * Throws java.lang.OutOfMemoryError, e.g. when Thread.start can't create a native thread.
+ */
+extern "C" [[noreturn]] void Magnetic_rt_throw_out_of_memory(const char *message);
+
+/**
+ * Aborts because compiled code called a method that magnetic_vm's reachability analysis found unreachable, and so
+ * didn't compile. This is a bug in the analysis, not in the program.
+ */
+extern "C" [[noreturn]] void Magnetic_rt_unreachable_method(const char *method_name);
@@ -0,0 +1,110 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "monitor.h"
+
+#include <atomic>
+#include <unordered_map>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "exceptions.h"
+#include "safepoint.h"
+#include "thread.h"
+
+thread_local uint32_t Magnetic_rt_thread_lock_tag = 0;
+
+namespace {
+
+// Must match the lock word layout emitted by the compiler (see Monitor in the compiler).
+constexpr uint32_t kOwnerShift = 8;
+constexpr uint32_t kOwnerMask = ~((1u << kOwnerShift) - 1);
+constexpr uint32_t kRecursionUnit = 1u << 2;
+constexpr uint32_t kRecursionMask = 0x3fu << 2;
+constexpr uint32_t kWaitersBit = 1u << 1;
+
+/**
+ * Re-entries beyond what fits in the lock word's recursion bits. Only the owner touches its monitor's count, so the
+ * table is per thread.
+ */
+thread_local std::unordered_map<uint32_t *, uint32_t> recursion_overflow;
+
+uint32_t GetThreadTag() { return Magnetic_rt_thread_current()->lock_tag; }
+
+std::atomic<uint32_t> &AsAtomic(uint32_t *lock_word) {
+  static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+  return *reinterpret_cast<std::atomic<uint32_t> *>(lock_word);
+}
+
+void FutexWait(uint32_t *lock_word, uint32_t expected) {
+  syscall(SYS_futex, lock_word, FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+void FutexWakeOne(uint32_t *lock_word) { syscall(SYS_futex, lock_word, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0); }
+
+}// namespace
+
+void Magnetic_rt_monitor_enter(uint32_t *lock_word) {
+  uint32_t tag = GetThreadTag();
+  std::atomic<uint32_t> &word = AsAtomic(lock_word);
+
+  // A thread that had to wait keeps the waiters bit set when it takes the monitor, since it can't tell whether anyone
+  // else is still waiting; the worst case is one unnecessary wake-up when it leaves.
+  uint32_t acquired = tag;
+  uint32_t current = word.load(std::memory_order_relaxed);
+  while (true) {
+    if ((current & kOwnerMask) == 0) {
+      if (word.compare_exchange_weak(current, acquired, std::memory_order_acquire, std::memory_order_relaxed)) return;
+      continue;
+    }
+
+    if ((current & kOwnerMask) == tag) {
+      // Re-entering a monitor we already own. Other threads may set the waiters bit at the same time, so the count
+      // still has to be updated atomically.
+      if ((current & kRecursionMask) == kRecursionMask) {
+        ++recursion_overflow[lock_word];
+        return;
+      }
+      if (word.compare_exchange_weak(current, current + kRecursionUnit, std::memory_order_relaxed)) return;
+      continue;
+    }
+
+    // Owned by another thread: announce that we are waiting, then sleep until the lock word changes.
+    if ((current & kWaitersBit) == 0 &&
+        !word.compare_exchange_weak(current, current | kWaitersBit, std::memory_order_relaxed)) {
+      continue;
+    }
+    Magnetic_rt_thread_enter_native();
+    FutexWait(lock_word, current | kWaitersBit);
+    Magnetic_rt_thread_leave_native();
+    acquired = tag | kWaitersBit;
+    current = word.load(std::memory_order_relaxed);
+  }
+}
+
+void Magnetic_rt_monitor_exit(uint32_t *lock_word) {
+  uint32_t tag = GetThreadTag();
+  std::atomic<uint32_t> &word = AsAtomic(lock_word);
+
+  uint32_t current = word.load(std::memory_order_relaxed);
+  if ((current & kOwnerMask) != tag) {
+    Magnetic_rt_throw_illegal_monitor_state();
+  }
+
+  if ((current & kRecursionMask) == kRecursionMask) {
+    const auto &it = recursion_overflow.find(lock_word);
+    if (it != recursion_overflow.end()) {
+      if (--it->second == 0) recursion_overflow.erase(it);
+      return;
+    }
+  }
+  if ((current & kRecursionMask) != 0) {
+    word.fetch_sub(kRecursionUnit, std::memory_order_relaxed);
+    return;
+  }
+
+  uint32_t previous = word.exchange(0, std::memory_order_release);
+  if (previous & kWaitersBit) FutexWakeOne(lock_word);
+}
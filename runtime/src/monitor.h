@@ -0,0 +1,25 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * The current thread's lock tag (its id shifted into the owner bits of a lock word), read by compiled code on the
+ * monitor fast paths. 0 until the thread first calls into the runtime (see MagneticThread).
+ */
+extern "C" thread_local uint32_t Magnetic_rt_thread_lock_tag;
+
+/**
+ * Slow path of monitorenter, taken when the inline compare-and-swap from 0 to the thread's tag fails: the monitor is
+ * already held (by this thread, or by another one), or the thread has no tag yet.
+ */
+extern "C" void Magnetic_rt_monitor_enter(uint32_t *lock_word);
+
+/**
+ * Slow path of monitorexit, taken when the lock word isn't exactly the thread's tag: the monitor was re-entered, or
+ * other threads are waiting for it.
+ */
+extern "C" void Magnetic_rt_monitor_exit(uint32_t *lock_word);
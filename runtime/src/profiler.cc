@@ -0,0 +1,275 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "profiler.h"
+
+#include <signal.h>
+#include <sys/time.h>
+#include <ucontext.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "symbols.h"
+#include "thread.h"
+
+namespace {
+
+constexpr std::chrono::milliseconds kDrainInterval(100);
+// How often the profile file is rewritten, in drains.
+constexpr int kDrainsPerWrite = 50;
+constexpr int64_t kMicrosecondsPerSecond = 1000000;
+
+struct ProgramCounters {
+  uintptr_t pc;
+  uintptr_t frame_pointer;
+};
+
+ProgramCounters GetInterruptedCounters(const ucontext_t *context) {
+#if defined(__x86_64__)
+  return {static_cast<uintptr_t>(context->uc_mcontext.gregs[REG_RIP]),
+          static_cast<uintptr_t>(context->uc_mcontext.gregs[REG_RBP])};
+#elif defined(__aarch64__)
+  return {static_cast<uintptr_t>(context->uc_mcontext.pc), static_cast<uintptr_t>(context->uc_mcontext.regs[29])};
+#else
+#error "the profiler doesn't support this architecture"
+#endif
+}
+
+/**
+ * Follows the chain of saved frame pointers: each frame starts with the caller's frame pointer, followed by the return
+ * address. Frame pointers are checked against the thread's stack before being read, so frames without one (code built
+ * with frame pointer elimination) end the walk instead of faulting.
+ */
+uint32_t WalkStack(const MagneticThread *thread, ProgramCounters counters, uintptr_t *frames, uint32_t max_depth) {
+  uint32_t depth = 0;
+  frames[depth++] = counters.pc;
+  uintptr_t frame_pointer = counters.frame_pointer;
+  while (depth < max_depth) {
+    if (frame_pointer < thread->stack_low || frame_pointer + 2 * sizeof(uintptr_t) > thread->stack_high) break;
+    if (frame_pointer % alignof(uintptr_t) != 0) break;
+    const auto *frame = reinterpret_cast<const uintptr_t *>(frame_pointer);
+    uintptr_t return_address = frame[1];
+    if (return_address == 0) break;
+    frames[depth++] = return_address;
+    // The stack grows down, so callers' frames are at higher addresses.
+    if (frame[0] <= frame_pointer) break;
+    frame_pointer = frame[0];
+  }
+  return depth;
+}
+
+void HandleProfilingSignal(int, siginfo_t *, void *context) {
+  int saved_errno = errno;
+  MagneticThread *thread = GetCurrentThreadIfAttached();
+  MagneticSampleBuffer *buffer = (thread != nullptr) ? thread->samples.load(std::memory_order_acquire) : nullptr;
+  if (buffer != nullptr) {
+    uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    if (head - buffer->tail.load(std::memory_order_acquire) >= MagneticSampleBuffer::kCapacity) {
+      buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      MagneticSampleBuffer::Sample &sample = buffer->samples[head % MagneticSampleBuffer::kCapacity];
+      sample.depth = WalkStack(thread, GetInterruptedCounters(static_cast<ucontext_t *>(context)), sample.frames,
+                               MagneticSampleBuffer::kMaxDepth);
+      buffer->head.store(head + 1, std::memory_order_release);
+    }
+  }
+  errno = saved_errno;
+}
+
+class Profiler {
+ public:
+  ~Profiler() { this->Stop(); }
+
+  bool Start(const char *path, int32_t frequency) {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    if (this->is_running_ || frequency <= 0) return false;
+    this->path_ = path;
+    this->GiveThreadsBuffers();
+
+    struct sigaction action {};
+    action.sa_sigaction = HandleProfilingSignal;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, nullptr) != 0) {
+      std::perror("magnetic-vm: could not install the profiling signal handler");
+      return false;
+    }
+
+    // ITIMER_PROF counts CPU time of the whole process, and the kernel sends the signal to a thread that is running
+    // when it expires, so busy threads are sampled in proportion to the CPU time they use. The timer can't fire more
+    // than once per microsecond.
+    int64_t period_us = kMicrosecondsPerSecond / std::min<int64_t>(frequency, kMicrosecondsPerSecond);
+    itimerval timer{};
+    timer.it_interval.tv_sec = static_cast<time_t>(period_us / kMicrosecondsPerSecond);
+    timer.it_interval.tv_usec = static_cast<suseconds_t>(period_us % kMicrosecondsPerSecond);
+    timer.it_value = timer.it_interval;
+    if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+      std::perror("magnetic-vm: could not start the profiling timer");
+      return false;
+    }
+
+    this->is_running_ = true;
+    this->writer_ = std::thread(&Profiler::RunWriter, this);
+    return true;
+  }
+
+  void Stop() {
+    {
+      std::lock_guard<std::mutex> lock(this->mutex_);
+      if (!this->is_running_) return;
+      itimerval timer{};
+      if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) std::perror("magnetic-vm: could not stop the profiling timer");
+      this->is_running_ = false;
+    }
+    this->stop_condition_.notify_all();
+    this->writer_.join();
+    this->Drain();
+    this->Write();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable stop_condition_;
+  bool is_running_ = false;// Guarded by mutex_.
+  std::string path_;
+  std::thread writer_;
+
+  // Only touched by the writer thread (or by Stop, once the writer has exited).
+  std::map<std::vector<uintptr_t>, uint64_t> stack_counts_;
+  uint64_t dropped_ = 0;
+  std::unordered_map<uintptr_t, std::string> frame_names_;
+
+  /**
+   * Threads that attached since the last drain get their buffers here, so the signal handler never allocates.
+   */
+  static void GiveThreadsBuffers() {
+    for (MagneticThread *thread : GetAllThreads()) {
+      if (thread->samples.load(std::memory_order_relaxed) != nullptr) continue;
+      thread->samples.store(new MagneticSampleBuffer(), std::memory_order_release);
+    }
+  }
+
+  void RunWriter() {
+    // The writer isn't a thread worth profiling.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGPROF);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    std::unique_lock<std::mutex> lock(this->mutex_);
+    for (int drains = 1; this->is_running_; ++drains) {
+      this->stop_condition_.wait_for(lock, kDrainInterval);
+      if (!this->is_running_) break;
+      GiveThreadsBuffers();
+      lock.unlock();
+      this->Drain();
+      if (drains % kDrainsPerWrite == 0) this->Write();
+      lock.lock();
+    }
+  }
+
+  void Drain() {
+    for (MagneticThread *thread : GetAllThreads()) {
+      MagneticSampleBuffer *buffer = thread->samples.load(std::memory_order_acquire);
+      if (buffer == nullptr) continue;
+      uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+      uint64_t head = buffer->head.load(std::memory_order_acquire);
+      for (; tail < head; ++tail) {
+        const MagneticSampleBuffer::Sample &sample = buffer->samples[tail % MagneticSampleBuffer::kCapacity];
+        // Return addresses point after the call, which may already be the next function (or the next line).
+        std::vector<uintptr_t> frames(sample.frames, sample.frames + sample.depth);
+        for (size_t i = 1; i < frames.size(); ++i) --frames[i];
+        ++this->stack_counts_[std::move(frames)];
+      }
+      buffer->tail.store(tail, std::memory_order_release);
+      this->dropped_ += buffer->dropped.exchange(0, std::memory_order_relaxed);
+    }
+  }
+
+  const std::string &GetFrameName(uintptr_t pc) {
+    auto it = this->frame_names_.find(pc);
+    if (it == this->frame_names_.end()) {
+      // Descriptors contain ';', which separates frames in folded stacks.
+      std::string name = DescribeAddress(pc);
+      name.resize(std::min(name.size(), name.find('(')));
+      it = this->frame_names_.emplace(pc, std::move(name)).first;
+    }
+    return it->second;
+  }
+
+  /**
+   * Writes to a temporary file first, so that readers never see a partially written profile.
+   */
+  void Write() {
+    // Stacks that differ only in where inside the same methods they were sampled are merged.
+    std::map<std::string, uint64_t> folded_stacks{};
+    for (const auto &[frames, count] : this->stack_counts_) {
+      std::string stack;
+      for (auto it = frames.rbegin(); it != frames.rend(); ++it) {
+        if (!stack.empty()) stack += ';';
+        stack += this->GetFrameName(*it);
+      }
+      folded_stacks[stack] += count;
+    }
+
+    std::string temporary_path = this->path_ + ".tmp";
+    FILE *file = std::fopen(temporary_path.c_str(), "w");
+    if (file == nullptr) {
+      std::perror("magnetic-vm: could not write the profile");
+      return;
+    }
+    for (const auto &[stack, count] : folded_stacks) {
+      std::fprintf(file, "%s %llu\n", stack.c_str(), static_cast<unsigned long long>(count));
+    }
+    if (this->dropped_ != 0) {
+      std::fprintf(file, "[dropped] %llu\n", static_cast<unsigned long long>(this->dropped_));
+    }
+    std::fclose(file);
+    std::rename(temporary_path.c_str(), this->path_.c_str());
+  }
+};
+
+/**
+ * The profiler can be started from other translation units' static initializers, so it is created on first use.
+ */
+Profiler &GetProfiler() {
+  static Profiler profiler;
+  return profiler;
+}
+
+}// namespace
+
+bool StartProfilerIfRequested() {
+  const char *request = std::getenv("MAGNETIC_PROFILE");
+  if (request == nullptr) return false;
+
+  std::string path = request;
+  int32_t frequency = 99;// Slightly off from 100 Hz, so that sampling doesn't line up with periodic work.
+  size_t separator = path.rfind(':');
+  if (separator != std::string::npos) {
+    frequency = std::atoi(path.c_str() + separator + 1);
+    path.resize(separator);
+  }
+  if (!Magnetic_rt_profiler_start(path.c_str(), frequency)) return false;
+  std::atexit(Magnetic_rt_profiler_stop);
+  return true;
+}
+
+extern "C" bool Magnetic_rt_profiler_start(const char *path, int32_t frequency) {
+  return GetProfiler().Start(path, frequency);
+}
+
+extern "C" void Magnetic_rt_profiler_stop() { GetProfiler().Stop(); }
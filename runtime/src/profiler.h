@@ -0,0 +1,51 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Stack samples of one thread, waiting to be aggregated. The thread's profiling signal handler is the only writer and
+ * the profiler's writer thread is the only reader, so it is a lock-free single-producer single-consumer ring.
+ */
+struct MagneticSampleBuffer {
+  static constexpr size_t kCapacity = 128;
+  static constexpr size_t kMaxDepth = 64;
+
+  struct Sample {
+    uint32_t depth;
+    uintptr_t frames[kMaxDepth];// Innermost first: the interrupted pc, then return addresses.
+  };
+
+  std::atomic<uint64_t> head{0};// Next sample to write; advanced by the signal handler.
+  std::atomic<uint64_t> tail{0};// Next sample to read; advanced by the writer thread.
+  std::atomic<uint64_t> dropped{0};// Samples lost because the ring was full.
+  Sample samples[kCapacity];
+};
+
+/**
+ * Runtime-internal. Starts the profiler if the MAGNETIC_PROFILE environment variable is set, to "<path>" or
+ * "<path>:<frequency>".
+ */
+bool StartProfilerIfRequested();
+
+/**
+ * Starts sampling the stacks of all threads, `frequency` times per second of CPU time the process uses (at most once
+ * per microsecond). Stacks are walked through frame pointers, so the program should be compiled with magnetic_vm
+ * -frame-pointers (and -g, so that frames are named after Java methods).
+ *
+ * A background thread aggregates the samples, and periodically rewrites `path` with them as folded stacks (one
+ * "outer;...;inner count" line per distinct stack), which flamegraph.pl and speedscope read.
+ * @return false if the profiler is already running, if `frequency` isn't positive, or if the profiling timer couldn't
+ *         be started (which is reported on stderr)
+ */
+extern "C" bool Magnetic_rt_profiler_start(const char *path, int32_t frequency);
+
+/**
+ * Stops sampling, and writes the final profile. Does nothing if the profiler isn't running.
+ */
+extern "C" void Magnetic_rt_profiler_stop();
@@ -0,0 +1,135 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "safepoint.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+
+#include <linux/futex.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "thread.h"
+
+namespace {
+constexpr size_t kMaxPageSize = 64 * 1024;
+}// namespace
+
+alignas(kMaxPageSize) uint8_t Magnetic_rt_safepoint_page[kMaxPageSize];
+
+namespace {
+
+/**
+ * 1 while a safepoint is in progress. Threads wait on it (as a futex) to be resumed.
+ */
+std::atomic<uint32_t> safepoint_active{0};
+std::mutex safepoint_mutex;
+
+struct sigaction previous_segv_action;
+
+void FutexWait(std::atomic<uint32_t> *word, uint32_t expected) {
+  static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+void FutexWakeAll(std::atomic<uint32_t> *word) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+}
+
+void WaitForSafepointEnd() {
+  while (safepoint_active.load(std::memory_order_acquire) != 0) FutexWait(&safepoint_active, 1);
+}
+
+void ProtectSafepointPage(int protection) {
+  if (mprotect(Magnetic_rt_safepoint_page, sysconf(_SC_PAGESIZE), protection) != 0) {
+    std::perror("magnetic-vm: could not change the protection of the safepoint page");
+    std::abort();
+  }
+}
+
+void ForwardSignal(int signal, siginfo_t *info, void *context) {
+  if (previous_segv_action.sa_flags & SA_SIGINFO) {
+    previous_segv_action.sa_sigaction(signal, info, context);
+  } else if (previous_segv_action.sa_handler == SIG_DFL || previous_segv_action.sa_handler == SIG_IGN) {
+    // Returning re-executes the faulting instruction, which then crashes with the default action.
+    sigaction(SIGSEGV, &previous_segv_action, nullptr);
+  } else {
+    previous_segv_action.sa_handler(signal);
+  }
+}
+
+void HandleSegv(int signal, siginfo_t *info, void *context) {
+  auto *address = static_cast<uint8_t *>(info->si_addr);
+  if (address < Magnetic_rt_safepoint_page || address >= Magnetic_rt_safepoint_page + kMaxPageSize) {
+    ForwardSignal(signal, info, context);
+    return;
+  }
+
+  // Park until the safepoint ends, then return to re-execute the poll, which now succeeds. Only atomics and futex
+  // calls happen here, which are safe in a signal handler. Attaching a thread allocates, so it can't be done here: the
+  // main thread is attached during static initialization and started threads attach before running Java code. A
+  // thread that isn't attached isn't waited for by the safepoint, so it only has to wait for the safepoint to end.
+  MagneticThread *thread = GetCurrentThreadIfAttached();
+  if (thread != nullptr) thread->state.store(kThreadAtSafepoint, std::memory_order_seq_cst);
+  WaitForSafepointEnd();
+  if (thread != nullptr) thread->state.store(kThreadInJava, std::memory_order_seq_cst);
+}
+
+bool InstallSegvHandler() {
+  struct sigaction action {};
+  action.sa_sigaction = HandleSegv;
+  action.sa_flags = SA_SIGINFO | SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  if (sigaction(SIGSEGV, &action, &previous_segv_action) != 0) {
+    std::perror("magnetic-vm: could not install the safepoint handler");
+    std::abort();
+  }
+  return true;
+}
+
+[[maybe_unused]] const bool is_segv_handler_installed = InstallSegvHandler();
+
+}// namespace
+
+void Magnetic_rt_safepoint_begin() {
+  Magnetic_rt_thread_enter_native();
+  safepoint_mutex.lock();
+
+  // The flag is raised before any thread's state is read. A thread leaving native code publishes its state first,
+  // then reads the flag, so either we see it running compiled code (and wait for it to reach a poll) or it sees the
+  // flag (and waits for the safepoint to end).
+  safepoint_active.store(1, std::memory_order_seq_cst);
+  ProtectSafepointPage(PROT_NONE);
+  for (MagneticThread *thread : GetAllThreads()) {
+    while (thread->state.load(std::memory_order_seq_cst) == kThreadInJava) sched_yield();
+  }
+}
+
+void Magnetic_rt_safepoint_end() {
+  ProtectSafepointPage(PROT_READ | PROT_WRITE);
+  safepoint_active.store(0, std::memory_order_seq_cst);
+  FutexWakeAll(&safepoint_active);
+
+  safepoint_mutex.unlock();
+  Magnetic_rt_thread_leave_native();
+}
+
+void Magnetic_rt_thread_enter_native() {
+  Magnetic_rt_thread_current()->state.store(kThreadInNative, std::memory_order_seq_cst);
+}
+
+void Magnetic_rt_thread_leave_native() {
+  MagneticThread *thread = Magnetic_rt_thread_current();
+  while (true) {
+    thread->state.store(kThreadInJava, std::memory_order_seq_cst);
+    if (safepoint_active.load(std::memory_order_seq_cst) == 0) return;
+    thread->state.store(kThreadInNative, std::memory_order_seq_cst);
+    WaitForSafepointEnd();
+  }
+}
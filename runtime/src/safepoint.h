@@ -0,0 +1,36 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * The page compiled code polls at method entries and loop back edges, with a single load. It is readable except while
+ * a safepoint is in progress; then the load faults, and the fault handler parks the thread until the safepoint ends.
+ *
+ * Sized and aligned for the largest page size supported, but only the first page is ever protected.
+ */
+extern "C" uint8_t Magnetic_rt_safepoint_page[];
+
+/**
+ * Stops every other thread at a safepoint (or in native code), and returns once they all are. Only one safepoint can
+ * be in progress at a time; other threads calling this wait for the current one to end.
+ */
+extern "C" void Magnetic_rt_safepoint_begin();
+
+/**
+ * Resumes the threads stopped by Magnetic_rt_safepoint_begin.
+ */
+extern "C" void Magnetic_rt_safepoint_end();
+
+/**
+ * Marks the calling thread as not running compiled code (e.g. before it blocks), so that safepoints don't wait for it.
+ */
+extern "C" void Magnetic_rt_thread_enter_native();
+
+/**
+ * Marks the calling thread as running compiled code again. Waits for the safepoint in progress, if there is one.
+ */
+extern "C" void Magnetic_rt_thread_leave_native();
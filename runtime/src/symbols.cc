@@ -0,0 +1,204 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "symbols.h"
+
+#include <dlfcn.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <link.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// Layout of the method table entries that magnetic_vm emits into the magnetic_methods section.
+struct MagneticMethodTableEntry {
+  const void *function;
+  const char *name;
+};
+
+// Defined by the linker around the magnetic_methods section. Weak, since the section only exists if some of the
+// program was compiled with -g.
+extern "C" __attribute__((weak)) const MagneticMethodTableEntry __start_magnetic_methods[];
+extern "C" __attribute__((weak)) const MagneticMethodTableEntry __stop_magnetic_methods[];
+
+namespace {
+
+struct LoadedObject {
+  std::string path;
+  uintptr_t bias;// Added to the addresses in the file to get the addresses they are loaded at.
+  uintptr_t segment_end;// End of the loaded segment that contains the address that was searched for.
+};
+
+/**
+ * @return the loaded object (the executable or a shared library) that contains the address, or std::nullopt if none
+ *         does
+ */
+std::optional<LoadedObject> FindLoadedObject(uintptr_t address) {
+  struct Search {
+    uintptr_t address;
+    std::optional<LoadedObject> object;
+  } search{address, std::nullopt};
+  dl_iterate_phdr(
+      [](dl_phdr_info *info, size_t, void *data) {
+        auto *search = static_cast<Search *>(data);
+        for (ElfW(Half) i = 0; i < info->dlpi_phnum; ++i) {
+          const ElfW(Phdr) &header = info->dlpi_phdr[i];
+          if (header.p_type != PT_LOAD) continue;
+          uintptr_t start = info->dlpi_addr + header.p_vaddr;
+          if (search->address < start || search->address >= start + header.p_memsz) continue;
+          // The executable is listed without a name.
+          bool is_executable = (info->dlpi_name == nullptr) || (info->dlpi_name[0] == '\0');
+          search->object = LoadedObject{is_executable ? "/proc/self/exe" : info->dlpi_name, info->dlpi_addr,
+                                        start + header.p_memsz};
+          return 1;
+        }
+        return 0;
+      },
+      &search);
+  return search.object;
+}
+
+/**
+ * Reads the sizes of the functions in an ELF file's symbol tables, by the address they are loaded at. Finds nothing if
+ * the file was stripped.
+ */
+std::unordered_map<uintptr_t, uintptr_t> ReadFunctionSizes(const LoadedObject &object) {
+  std::unordered_map<uintptr_t, uintptr_t> sizes{};
+  int fd = open(object.path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return sizes;
+  struct stat status {};
+  void *mapping = MAP_FAILED;
+  if (fstat(fd, &status) == 0 && static_cast<size_t>(status.st_size) >= sizeof(ElfW(Ehdr))) {
+    mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (mapping == MAP_FAILED) return sizes;
+
+  const auto *file = static_cast<const uint8_t *>(mapping);
+  size_t file_size = status.st_size;
+  const auto *header = reinterpret_cast<const ElfW(Ehdr) *>(file);
+  bool is_valid = (std::memcmp(header->e_ident, ELFMAG, SELFMAG) == 0) &&
+                  (header->e_shentsize == sizeof(ElfW(Shdr))) &&
+                  (header->e_shoff + header->e_shnum * sizeof(ElfW(Shdr)) <= file_size);
+  for (ElfW(Half) i = 0; is_valid && i < header->e_shnum; ++i) {
+    const auto &section = reinterpret_cast<const ElfW(Shdr) *>(file + header->e_shoff)[i];
+    if (section.sh_type != SHT_SYMTAB && section.sh_type != SHT_DYNSYM) continue;
+    if (section.sh_offset + section.sh_size > file_size) continue;
+    const auto *symbols = reinterpret_cast<const ElfW(Sym) *>(file + section.sh_offset);
+    for (size_t j = 0; j < section.sh_size / sizeof(ElfW(Sym)); ++j) {
+      const ElfW(Sym) &symbol = symbols[j];
+      if (ELF64_ST_TYPE(symbol.st_info) != STT_FUNC || symbol.st_shndx == SHN_UNDEF || symbol.st_size == 0) continue;
+      sizes.emplace(object.bias + symbol.st_value, symbol.st_size);
+    }
+  }
+  munmap(mapping, file_size);
+  return sizes;
+}
+
+/**
+ * The method table only has start addresses, so the end of each method comes from the size of its symbol in the ELF
+ * symbol table. If the binary was stripped, each method is assumed to extend to the next method (or to the end of its
+ * segment) instead, which attributes code that the table doesn't list (virtual dispatch thunks, instantiators, the
+ * runtime) laid out after a method to it.
+ */
+std::vector<MagneticMethodSymbol> BuildSymbols() {
+  std::vector<MagneticMethodSymbol> symbols{};
+  if (__start_magnetic_methods == nullptr || __stop_magnetic_methods == nullptr) return symbols;
+
+  for (const MagneticMethodTableEntry *entry = __start_magnetic_methods; entry < __stop_magnetic_methods; ++entry) {
+    symbols.push_back({reinterpret_cast<uintptr_t>(entry->function), 0, entry->name});
+  }
+  std::sort(symbols.begin(), symbols.end(),
+            [](const MagneticMethodSymbol &lhs, const MagneticMethodSymbol &rhs) { return lhs.start < rhs.start; });
+  std::unordered_map<std::string, std::unordered_map<uintptr_t, uintptr_t>> function_sizes{};
+  for (size_t i = 0; i < symbols.size(); ++i) {
+    std::optional<LoadedObject> object = FindLoadedObject(symbols[i].start);
+    if (!object.has_value()) {
+      symbols[i].end = symbols[i].start;
+      continue;
+    }
+
+    auto it = function_sizes.find(object->path);
+    if (it == function_sizes.end()) it = function_sizes.emplace(object->path, ReadFunctionSizes(*object)).first;
+    const auto &size = it->second.find(symbols[i].start);
+    if (size != it->second.end()) {
+      symbols[i].end = symbols[i].start + size->second;
+      continue;
+    }
+    uintptr_t next_start = (i + 1 < symbols.size()) ? symbols[i + 1].start : object->segment_end;
+    symbols[i].end = std::min(next_start, object->segment_end);
+  }
+  return symbols;
+}
+
+const std::vector<MagneticMethodSymbol> &GetSymbols() {
+  // Never destroyed, since profilers symbolize addresses from atexit handlers, which can run after function-local
+  // statics have been destroyed.
+  static const auto *symbols = new std::vector<MagneticMethodSymbol>(BuildSymbols());
+  return *symbols;
+}
+
+}// namespace
+
+const MagneticMethodSymbol *FindMethodSymbol(uintptr_t address) {
+  const std::vector<MagneticMethodSymbol> &symbols = GetSymbols();
+  auto it = std::upper_bound(symbols.begin(), symbols.end(), address,
+                             [](uintptr_t address, const MagneticMethodSymbol &symbol) {
+                               return address < symbol.start;
+                             });
+  if (it == symbols.begin()) return nullptr;
+  const MagneticMethodSymbol &symbol = *std::prev(it);
+  return (address < symbol.end) ? &symbol : nullptr;
+}
+
+std::string DescribeAddress(uintptr_t address) {
+  const MagneticMethodSymbol *method = FindMethodSymbol(address);
+  if (method != nullptr) return method->name;
+
+  Dl_info info;
+  if (dladdr(reinterpret_cast<void *>(address), &info) != 0) {
+    if (info.dli_sname != nullptr) return info.dli_sname;
+    if (info.dli_fname != nullptr) {
+      const char *file_name = std::strrchr(info.dli_fname, '/');
+      return std::string("[") + ((file_name != nullptr) ? file_name + 1 : info.dli_fname) + "]";
+    }
+  }
+  char name[32];
+  std::snprintf(name, sizeof(name), "0x%" PRIxPTR, address);
+  return name;
+}
+
+bool WritePerfMapIfRequested() {
+  if (std::getenv("MAGNETIC_PERF_MAP") == nullptr) return false;
+  return Magnetic_rt_write_perf_map();
+}
+
+extern "C" const char *Magnetic_rt_symbolize(const void *address) {
+  const MagneticMethodSymbol *symbol = FindMethodSymbol(reinterpret_cast<uintptr_t>(address));
+  return (symbol != nullptr) ? symbol->name : nullptr;
+}
+
+extern "C" bool Magnetic_rt_write_perf_map() {
+  const std::vector<MagneticMethodSymbol> &symbols = GetSymbols();
+  if (symbols.empty()) return false;
+
+  char path[64];
+  std::snprintf(path, sizeof(path), "/tmp/perf-%d.map", static_cast<int>(getpid()));
+  FILE *file = std::fopen(path, "w");
+  if (file == nullptr) return false;
+  for (const MagneticMethodSymbol &symbol : symbols) {
+    std::fprintf(file, "%" PRIxPTR " %" PRIxPTR " %s\n", symbol.start, symbol.end - symbol.start, symbol.name);
+  }
+  return std::fclose(file) == 0;
+}
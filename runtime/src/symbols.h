@@ -0,0 +1,46 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/**
+ * A compiled Java method, from the method table that magnetic_vm -g emits.
+ */
+struct MagneticMethodSymbol {
+  uintptr_t start;
+  uintptr_t end;
+  const char *name;// e.g. "io.github.lunbun.Main.main([Ljava/lang/String;)V"
+};
+
+/**
+ * Runtime-internal.
+ * @return the method containing the address, or nullptr if the address isn't in a method from the method table
+ */
+const MagneticMethodSymbol *FindMethodSymbol(uintptr_t address);
+
+/**
+ * Runtime-internal. Names an address for profiles: by the Java method it is in (see FindMethodSymbol), otherwise by its
+ * dynamic symbol (the mangled name, for compiled code), the object file it is in, or failing all that, its address.
+ */
+std::string DescribeAddress(uintptr_t address);
+
+/**
+ * Runtime-internal. Writes the perf map if the MAGNETIC_PERF_MAP environment variable is set.
+ */
+bool WritePerfMapIfRequested();
+
+/**
+ * @return the Java name of the method containing the address, or nullptr if it isn't in a compiled Java method (or the
+ *         program was compiled without -g)
+ */
+extern "C" const char *Magnetic_rt_symbolize(const void *address);
+
+/**
+ * Writes /tmp/perf-<pid>.map, which maps the address range of every compiled Java method to its Java name.
+ * @return false if the program was compiled without -g, or the file couldn't be written
+ */
+extern "C" bool Magnetic_rt_write_perf_map();
@@ -0,0 +1,211 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#include "thread.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <unordered_map>
+
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "allocation.h"
+#include "call-profile.h"
+#include "exceptions.h"
+#include "monitor.h"
+#include "profiler.h"
+#include "safepoint.h"
+#include "symbols.h"
+
+// Virtual dispatch thunk of java.lang.Thread.run(), which calls the run() of the thread object's class. It is weak so
+// that programs which never start a thread (and so never compile Thread.run) still link; starting a thread without it
+// aborts.
+extern "C" __attribute__((weak)) void Magnetic_v_java_lang_Thread_run__(void *java_thread);
+
+namespace {
+
+// The owner field of a lock word is 24 bits wide.
+constexpr uint32_t kLockTagShift = 8;
+constexpr uint32_t kMaxThreadId = (1u << (32 - kLockTagShift)) - 1;
+
+std::atomic<uint32_t> next_thread_id{1};
+// Java numbers the default names of threads from 0, not counting the main thread.
+std::atomic<uint32_t> next_thread_number{0};
+
+thread_local MagneticThread *current_thread = nullptr;
+
+/**
+ * Threads started from Java, by their java.lang.Thread object. Entries are only removed if the thread couldn't be
+ * started, since a thread can be joined any number of times after it finished.
+ */
+class ThreadTable {
+ public:
+  /**
+   * @return the inserted thread, or nullptr if a thread was already started from the object
+   */
+  MagneticThread *Insert(void *java_thread, std::unique_ptr<MagneticThread> thread) {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    const auto &[it, inserted] = this->threads_.emplace(java_thread, std::move(thread));
+    return inserted ? it->second.get() : nullptr;
+  }
+  MagneticThread *Find(void *java_thread) {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    const auto &it = this->threads_.find(java_thread);
+    if (it == this->threads_.end()) return nullptr;
+    return it->second.get();
+  }
+  std::unique_ptr<MagneticThread> Remove(void *java_thread) {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    const auto &it = this->threads_.find(java_thread);
+    if (it == this->threads_.end()) return nullptr;
+    std::unique_ptr<MagneticThread> thread = std::move(it->second);
+    this->threads_.erase(it);
+    return thread;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<void *, std::unique_ptr<MagneticThread>> threads_;
+};
+
+ThreadTable threads;
+
+std::mutex all_threads_mutex;
+std::vector<MagneticThread *> all_threads;// Guarded by all_threads_mutex.
+
+std::unique_ptr<MagneticThread> CreateThread(void *java_thread, bool is_main_thread) {
+  uint32_t id = next_thread_id.fetch_add(1, std::memory_order_relaxed);
+  if (id > kMaxThreadId) {
+    std::fprintf(stderr, "magnetic-vm: too many threads\n");
+    std::abort();
+  }
+
+  auto thread = std::make_unique<MagneticThread>();
+  thread->id = id;
+  thread->lock_tag = id << kLockTagShift;
+  thread->tlab.top = nullptr;
+  thread->tlab.end = nullptr;
+  thread->pending_exception = nullptr;
+  // Until the thread attaches, it can't run compiled code, so safepoints don't have to wait for it.
+  thread->state.store(kThreadInNative, std::memory_order_relaxed);
+  thread->java_thread = java_thread;
+  if (is_main_thread) {
+    std::snprintf(thread->name, sizeof(thread->name), "main");
+  } else {
+    // Java numbers a thread when it is constructed, but the runtime only sees threads as they start, so threads are
+    // numbered in the order that they start. The numbers differ from Java's when threads start out of construction
+    // order, or when constructed threads are never started.
+    std::snprintf(thread->name, sizeof(thread->name), "Thread-%u",
+                  next_thread_number.fetch_add(1, std::memory_order_relaxed));
+  }
+  thread->stack_low = 0;
+  thread->stack_high = 0;
+  thread->samples.store(nullptr, std::memory_order_relaxed);
+  thread->is_finished = false;
+
+  std::lock_guard<std::mutex> lock(all_threads_mutex);
+  all_threads.push_back(thread.get());
+  return thread;
+}
+
+void Attach(MagneticThread *thread) {
+  pthread_attr_t attributes;
+  if (pthread_getattr_np(pthread_self(), &attributes) == 0) {
+    void *stack_low;
+    size_t stack_size;
+    if (pthread_attr_getstack(&attributes, &stack_low, &stack_size) == 0) {
+      thread->stack_low = reinterpret_cast<uintptr_t>(stack_low);
+      thread->stack_high = thread->stack_low + stack_size;
+    }
+    pthread_attr_destroy(&attributes);
+  }
+
+  current_thread = thread;
+  Magnetic_rt_thread_lock_tag = thread->lock_tag;
+  AttachCallCounters();
+  Magnetic_rt_thread_leave_native();
+}
+
+void *RunThread(void *arg) {
+  // Kept alive by the thread table.
+  auto *thread = static_cast<MagneticThread *>(arg);
+  Attach(thread);
+
+  Magnetic_v_java_lang_Thread_run__(thread->java_thread);
+  Magnetic_rt_thread_enter_native();
+
+  {
+    std::lock_guard<std::mutex> lock(thread->mutex);
+    thread->is_finished = true;
+  }
+  thread->finished_condition.notify_all();
+  return nullptr;
+}
+
+}// namespace
+
+std::vector<MagneticThread *> GetAllThreads() {
+  std::lock_guard<std::mutex> lock(all_threads_mutex);
+  return all_threads;
+}
+
+MagneticThread *GetCurrentThreadIfAttached() { return current_thread; }
+
+MagneticThread *Magnetic_rt_thread_current() {
+  if (current_thread == nullptr) {
+    // Threads that weren't started by the runtime (the main thread, or threads created by native code) are never freed,
+    // since they may still be referenced by monitors they hold.
+    // On Linux, the main thread's thread id is the process id.
+    bool is_main_thread = (syscall(SYS_gettid) == getpid());
+    Attach(CreateThread(nullptr, is_main_thread).release());
+  }
+  return current_thread;
+}
+
+void Magnetic_rt_thread_start(void *java_thread) {
+  if (Magnetic_v_java_lang_Thread_run__ == nullptr) {
+    std::fprintf(stderr, "magnetic-vm: started a thread, but java.lang.Thread.run() was not compiled\n");
+    std::abort();
+  }
+  MagneticThread *thread = threads.Insert(java_thread, CreateThread(java_thread, false));
+  if (thread == nullptr) Magnetic_rt_throw_illegal_thread_state();
+
+  pthread_attr_t attributes;
+  pthread_attr_init(&attributes);
+  pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED);
+  pthread_t handle;
+  int error = pthread_create(&handle, &attributes, RunThread, thread);
+  pthread_attr_destroy(&attributes);
+  if (error != 0) {
+    // Joining the thread must not wait for it to finish. The thread stays in all_threads like a finished thread would,
+    // since profilers may still be reading it, so it is never freed.
+    threads.Remove(java_thread).release();
+    Magnetic_rt_throw_out_of_memory("unable to create native thread");
+  }
+}
+
+void Magnetic_rt_thread_join(void *java_thread) {
+  MagneticThread *thread = threads.Find(java_thread);
+  if (thread == nullptr) return;
+
+  Magnetic_rt_thread_enter_native();
+  {
+    std::unique_lock<std::mutex> lock(thread->mutex);
+    thread->finished_condition.wait(lock, [thread]() { return thread->is_finished; });
+  }
+  Magnetic_rt_thread_leave_native();
+}
+
+namespace {
+// Attach the main thread before main() runs, so that safepoints know about it from the start.
+MagneticThread *const main_thread = Magnetic_rt_thread_current();
+// Profilers read the perf map after the program has exited, so it may as well be written up front.
+[[maybe_unused]] const bool perf_map_written = WritePerfMapIfRequested();
+[[maybe_unused]] const bool profiler_started = StartProfilerIfRequested();
+[[maybe_unused]] const bool allocation_profiler_started = StartAllocationProfilerIfRequested();
+[[maybe_unused]] const bool call_profiler_started = StartCallProfilerIfRequested();
+}// namespace
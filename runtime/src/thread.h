@@ -0,0 +1,114 @@
+//
+// Created by lunbun on 10/19/2026.
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+enum MagneticThreadState : uint32_t {
+  /**
+   * Running compiled code; the thread stops at its next safepoint poll while a safepoint is in progress.
+   */
+  kThreadInJava,
+  /**
+   * Blocked or running runtime code that doesn't touch the Java heap, so a safepoint doesn't have to wait for it.
+   */
+  kThreadInNative,
+  /**
+   * Stopped at a safepoint poll.
+   */
+  kThreadAtSafepoint,
+};
+
+struct MagneticSampleBuffer;
+
+/**
+ * Runtime state of a thread running compiled code. Every thread gets one when it first calls into the runtime (threads
+ * started through Thread.start get theirs before running any Java code), and it lives as long as the process.
+ */
+struct MagneticThread {
+  /**
+   * Small, dense id, starting at 1. Also the owner field of the lock words of the monitors the thread holds.
+   */
+  uint32_t id;
+  uint32_t lock_tag;
+
+  /**
+   * Thread-local allocation buffer, which objects will be bump-allocated from. Empty until allocation goes through the
+   * runtime.
+   */
+  struct {
+    uint8_t *top;
+    uint8_t *end;
+  } tlab;
+
+  /**
+   * The exception being thrown by the thread, or nullptr.
+   */
+  void *pending_exception;
+  /**
+   * A MagneticThreadState, read by the thread starting a safepoint.
+   */
+  std::atomic<uint32_t> state;
+
+  /**
+   * The java.lang.Thread object, or nullptr for threads that weren't started from Java (e.g. the main thread).
+   */
+  void *java_thread;
+  /**
+   * Name that uncaught exceptions are reported with: "main" for the process's main thread, and Java's default
+   * "Thread-<n>" for every other thread. The runtime can't read the name field of the java.lang.Thread object, so names
+   * given with Thread.setName (or a Thread constructor) aren't reflected here.
+   */
+  char name[32];
+
+  /**
+   * Bounds of the thread's native stack, which the profiler checks frame pointers against. Set when the thread
+   * attaches.
+   */
+  uintptr_t stack_low;
+  uintptr_t stack_high;
+  /**
+   * Where the profiler's signal handler records the thread's stack samples, or nullptr if the profiler hasn't given the
+   * thread a buffer yet.
+   */
+  std::atomic<MagneticSampleBuffer *> samples;
+
+  std::mutex mutex;
+  std::condition_variable finished_condition;
+  bool is_finished;// Guarded by mutex.
+};
+
+/**
+ * Runtime-internal.
+ * @return every thread that has called into the runtime, including threads that have finished
+ */
+std::vector<MagneticThread *> GetAllThreads();
+
+/**
+ * Runtime-internal. Unlike Magnetic_rt_thread_current, this never attaches the thread, so it is safe to call from a
+ * signal handler.
+ * @return the calling thread's runtime state, or nullptr if the thread hasn't called into the runtime
+ */
+MagneticThread *GetCurrentThreadIfAttached();
+
+/**
+ * @return the calling thread's runtime state, creating it if the thread hasn't called into the runtime before
+ */
+extern "C" MagneticThread *Magnetic_rt_thread_current();
+
+/**
+ * Implements Thread.start: runs the thread object's run() on a new native thread.
+ */
+extern "C" void Magnetic_rt_thread_start(void *java_thread);
+
+/**
+ * Implements Thread.join: waits for the thread started from the thread object to finish. Returns immediately if it was
+ * never started.
+ */
+extern "C" void Magnetic_rt_thread_join(void *java_thread);